@@ -2,10 +2,12 @@
 #include <insti/insti.h>
 #include <insti/registry/snapshot_registry.h>
 #include <insti/core/orchestrator.h>
+#include <insti/core/benchmark.h>
 #include <pnq/console.h>
 #include <pnq/regis3.h>
 #include <argparse/argparse.hpp>
 #include <spdlog/spdlog.h>
+#include <fstream>
 #pragma warning(push)
 #pragma warning(disable: 4244 4267)  // conversion warnings in third-party header
 #include <indicators/progress_bar.hpp>
@@ -33,8 +35,14 @@ class ProgressBarCallback : public insti::IActionCallback
     std::string m_last_phase;
     bool m_completed = false;
 
-public:
-    void on_progress(std::string_view phase, std::string_view detail, int percent) override
+    static std::string truncate(std::string_view detail)
+    {
+        if (detail.length() > 30)
+            return std::string(detail.substr(0, 27)) + "...";
+        return std::string(detail);
+    }
+
+    void update(std::string_view phase, const std::string& postfix, int percent)
     {
         if (m_completed) return;
 
@@ -43,12 +51,7 @@ public:
             m_last_phase = std::string(phase);
             m_bar.set_option(indicators::option::PrefixText{m_last_phase + " "});
         }
-
-        // Truncate detail if too long
-        std::string detail_str(detail);
-        if (detail_str.length() > 30)
-            detail_str = detail_str.substr(0, 27) + "...";
-        m_bar.set_option(indicators::option::PostfixText{detail_str});
+        m_bar.set_option(indicators::option::PostfixText{postfix});
 
         if (percent >= 0)
         {
@@ -58,6 +61,29 @@ public:
         }
     }
 
+public:
+    void on_progress(std::string_view phase, std::string_view detail, int percent) override
+    {
+        update(phase, truncate(detail), percent);
+    }
+
+    void on_progress_info(const insti::ProgressInfo& info) override
+    {
+        // Throughput and ETA go in front of the (truncated) item
+        std::string postfix;
+        if (info.bytes_per_second > 0.0 || info.items_per_second > 0.0)
+        {
+            postfix = info.bytes_per_second > 0.0
+                ? std::format("{:.1f} MB/s", info.bytes_per_second / (1024.0 * 1024.0))
+                : std::format("{:.0f} files/s", info.items_per_second);
+            if (info.eta)
+                postfix += std::format(", {}:{:02} left", info.eta->count() / 60, info.eta->count() % 60);
+            postfix += " ";
+        }
+        postfix += truncate(info.detail);
+        update(info.phase, postfix, info.percent);
+    }
+
     void on_warning(std::string_view message) override
     {
         // Print warning on new line, then continue
@@ -89,6 +115,26 @@ public:
     }
 };
 
+// Records spans while alive and writes them as Chrome trace JSON on destruction (--trace)
+class TraceSession
+{
+    std::string m_path;
+
+public:
+    explicit TraceSession(std::string path)
+        : m_path{std::move(path)}
+    {
+        if (!m_path.empty())
+            insti::Tracer::instance().start();
+    }
+
+    ~TraceSession()
+    {
+        if (!m_path.empty() && insti::Tracer::instance().stop(m_path))
+            con::format_line("Trace written to {} (open in ui.perfetto.dev or chrome://tracing)", m_path);
+    }
+};
+
 // Unified reference resolution for both projects (A, B, C) and instances (1, 2, 3)
 enum class RefType { Project, Instance };
 
@@ -119,7 +165,8 @@ ResolvedRef resolve_reference(const std::string& ref)
     insti::config::theSettings.load();
     std::string roots_str = insti::config::theSettings.registry.roots.get();
     insti::SnapshotRegistry registry{pnq::string::split(roots_str, ";")};
-    registry.initialize();
+    // Positions must not depend on which shares answer in time
+    registry.initialize(insti::SnapshotRegistry::WAIT_FOR_ALL);
 
     // Check if ref is a letter index (A, B, C, ...) -> project
     if (ref.size() == 1 && std::isalpha(ref[0]))
@@ -315,7 +362,8 @@ int cmd_shutdown(const std::string& source_ref, bool force)
     return 0; // Shutdown always succeeds (best effort)
 }
 
-int cmd_backup(const std::string& blueprint_ref, const std::string& output_arg, bool force, const std::string& description)
+int cmd_backup(const std::string& blueprint_ref, const std::string& output_arg, bool force, const std::string& description,
+               const std::string& parent_ref, bool incremental)
 {
     auto resolved = resolve_reference(blueprint_ref);
     if (!resolved.ok())
@@ -363,7 +411,7 @@ int cmd_backup(const std::string& blueprint_ref, const std::string& output_arg,
     insti::config::theSettings.load();
     std::string roots_str = insti::config::theSettings.registry.roots.get();
     insti::SnapshotRegistry registry{pnq::string::split(roots_str, ";")};
-    registry.initialize();
+    registry.initialize(insti::SnapshotRegistry::WAIT_FOR_ALL);
 
     std::string output_path = output_arg;
 
@@ -385,13 +433,40 @@ int cmd_backup(const std::string& blueprint_ref, const std::string& output_arg,
         print_verbose("Auto-generated path: " + output_path);
     }
 
+    // Incremental only on request: a file whose size and mtime match the parent is copied
+    // from it unread, so content changed without touching the mtime would be missed
+    std::string parent_path;
+    if (!parent_ref.empty())
+    {
+        auto parent = resolve_reference(parent_ref);
+        if (!parent.ok() || parent.type != RefType::Instance)
+        {
+            print_error(parent.ok() ? "Parent must be a snapshot (.zip or 1/2/3): " + parent_ref : parent.error);
+            project->release(REFCOUNT_DEBUG_ARGS);
+            return 1;
+        }
+        parent_path = parent.path;
+    }
+    else if (incremental)
+    {
+        if (original_snapshot_path.empty())
+        {
+            print_error("--incremental needs a snapshot (1/2/3) to re-back up, or use --parent");
+            project->release(REFCOUNT_DEBUG_ARGS);
+            return 1;
+        }
+        parent_path = original_snapshot_path;
+    }
+
     con::format_line("Backing up: {} v{}", project->project_name(), project->project_version());
+    if (!parent_path.empty())
+        print_verbose("Incremental against: " + parent_path);
 
     // Use orchestrator with progress bar
     ProgressBarCallback callback;
     insti::Orchestrator orc{&registry};
 
-    bool success = orc.backup(project, output_path, &callback, force, description);
+    bool success = orc.backup(project, output_path, &callback, force, description, parent_path);
     callback.complete();
 
     if (success)
@@ -416,7 +491,7 @@ int cmd_backup(const std::string& blueprint_ref, const std::string& output_arg,
 }
 
 int cmd_restore(const std::string& snapshot_ref, const std::string& dest_override,
-                const std::vector<std::string>& var_overrides, bool force)
+                const std::vector<std::string>& var_overrides, bool force, bool delta)
 {
     if (!dest_override.empty())
     {
@@ -466,11 +541,12 @@ int cmd_restore(const std::string& snapshot_ref, const std::string& dest_overrid
     insti::config::theSettings.load();
     std::string roots_str = insti::config::theSettings.registry.roots.get();
     insti::SnapshotRegistry registry{pnq::string::split(roots_str, ";")};
-    registry.initialize();
+    registry.initialize(insti::SnapshotRegistry::WAIT_FOR_ALL);
 
     // Use orchestrator with progress bar
     ProgressBarCallback callback;
     insti::Orchestrator orc{&registry};
+    orc.set_delta_restore(delta);
 
     bool success = orc.restore(instance, resolved.path, &callback, false, force);
     callback.complete();
@@ -517,7 +593,7 @@ int cmd_clean(const std::string& source_ref, bool force)
     insti::config::theSettings.load();
     std::string roots_str = insti::config::theSettings.registry.roots.get();
     insti::SnapshotRegistry registry{pnq::string::split(roots_str, ";")};
-    registry.initialize();
+    registry.initialize(insti::SnapshotRegistry::WAIT_FOR_ALL);
 
     // Use orchestrator with progress bar
     ProgressBarCallback callback;
@@ -578,6 +654,8 @@ int cmd_list_registry(const std::string& filter_project, bool xml_output)
 
     insti::SnapshotRegistry registry{ roots };
     registry.initialize();
+    for (const auto& root : registry.pending_roots())
+        std::cerr << "warning: registry root '" << root << "' did not respond in time, list may be incomplete" << std::endl;
 
     // Get both projects and instances
     auto projects = registry.discover_projects(filter_project);
@@ -758,7 +836,36 @@ int cmd_list(const std::string& snapshot_path, const std::string& filter_project
     return cmd_list_registry(filter_project, xml_output);
 }
 
-int cmd_verify(const std::string& source_ref, bool list_files)
+int cmd_describe(const std::string& snapshot_ref, const std::string& description)
+{
+    auto resolved = resolve_reference(snapshot_ref);
+    if (!resolved.ok())
+    {
+        print_error(resolved.error);
+        return 1;
+    }
+    if (resolved.type != RefType::Instance)
+    {
+        print_error("Only snapshots have a description to edit. Use a snapshot (1, 2, 3) or .zip file.");
+        return 1;
+    }
+
+    insti::config::theSettings.load();
+    std::string roots_str = insti::config::theSettings.registry.roots.get();
+    insti::SnapshotRegistry registry{pnq::string::split(roots_str, ";")};
+    insti::Orchestrator orc{&registry};
+
+    if (!orc.update_description(resolved.path, description))
+    {
+        print_error("Failed to update snapshot: " + resolved.path);
+        return 1;
+    }
+
+    con::format_line("Description updated: {}", resolved.path);
+    return 0;
+}
+
+int cmd_verify(const std::string& source_ref, bool list_files, bool fast)
 {
     auto resolved = resolve_reference(source_ref);
     if (!resolved.ok())
@@ -804,12 +911,12 @@ int cmd_verify(const std::string& source_ref, bool list_files)
     insti::config::theSettings.load();
     std::string roots_str = insti::config::theSettings.registry.roots.get();
     insti::SnapshotRegistry registry{pnq::string::split(roots_str, ";")};
-    registry.initialize();
+    registry.initialize(insti::SnapshotRegistry::WAIT_FOR_ALL);
 
     // Use orchestrator for verify
     // Pass reader for instance verification (file-level comparison), nullptr for project verification
     insti::Orchestrator orc{&registry};
-    auto results = orc.verify(bp, nullptr, is_instance ? &reader : nullptr);
+    auto results = orc.verify(bp, nullptr, is_instance ? &reader : nullptr, fast);
 
     int match_count = 0;
     int mismatch_count = 0;
@@ -909,6 +1016,59 @@ int cmd_verify(const std::string& source_ref, bool list_files)
     }
 }
 
+int cmd_benchmark(const std::string& work_dir, const std::string& output, int iterations, double scale,
+                  const std::string& filter, bool keep)
+{
+    insti::BenchmarkSuite::Options options;
+    options.work_dir = work_dir.empty()
+        ? std::filesystem::temp_directory_path() / "insti-benchmark"
+        : std::filesystem::path{work_dir};
+    options.iterations = static_cast<uint32_t>(std::max(1, iterations));
+    options.scale = scale;
+    options.filter = filter;
+    options.keep_data = keep;
+
+    if (std::filesystem::exists(options.work_dir) && !std::filesystem::is_empty(options.work_dir))
+    {
+        print_error("Work directory is not empty: " + options.work_dir.string());
+        return 1;
+    }
+
+    con::format_line("Benchmarking in {} ({} iterations, scale {})", options.work_dir.string(), options.iterations, scale);
+    con::write_line("");
+
+    insti::BenchmarkSuite suite{options};
+    ProgressBarCallback callback;
+    const bool ok = suite.run(&callback);
+    callback.complete();
+    con::write_line("");
+
+    for (const auto& result : suite.results())
+    {
+        con::format_line("  {:<30} {:<20} median {:>10.1f} ms  min {:>10.1f} ms",
+                         result.name, result.dataset, result.median_ms(), result.min_ms());
+    }
+
+    if (!output.empty())
+    {
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        if (!out || !(out << suite.to_json()))
+        {
+            print_error("Failed to write results: " + output);
+            return 1;
+        }
+        con::write_line("");
+        con::format_line("Results written to {}", output);
+    }
+
+    if (!ok)
+    {
+        print_error("Benchmark failed (see log)");
+        return 1;
+    }
+    return 0;
+}
+
 int main(int argc, char* argv[])
 {
     // Load settings and initialize logging
@@ -923,6 +1083,9 @@ int main(int argc, char* argv[])
         .help("Enable verbose output")
         .default_value(false)
         .implicit_value(true);
+    program.add_argument("--trace")
+        .help("Record timings of hooks, actions and file I/O to a Chrome trace JSON file")
+        .default_value(std::string{});
 
     // Subcommands
     argparse::ArgumentParser backup_cmd("backup");
@@ -940,6 +1103,13 @@ int main(int argc, char* argv[])
     backup_cmd.add_argument("-d", "--description")
         .help("Description for this snapshot (overrides blueprint)")
         .default_value(std::string{});
+    backup_cmd.add_argument("-p", "--parent")
+        .help("Incremental: copy files unchanged since this snapshot (.zip or 1/2/3) instead of re-compressing them")
+        .default_value(std::string{});
+    backup_cmd.add_argument("-i", "--incremental")
+        .help("When re-backing up a snapshot (1/2/3), copy files whose size and mtime are unchanged from it instead of re-reading them")
+        .default_value(false)
+        .implicit_value(true);
 
     argparse::ArgumentParser restore_cmd("restore");
     restore_cmd.add_description("Restore from a snapshot (restore -> startup)");
@@ -956,6 +1126,10 @@ int main(int argc, char* argv[])
         .help("Run force-only hooks")
         .default_value(false)
         .implicit_value(true);
+    restore_cmd.add_argument("--delta")
+        .help("Update in place: extract only files whose size, mtime or CRC differ from the snapshot, delete extras")
+        .default_value(false)
+        .implicit_value(true);
 
     argparse::ArgumentParser list_cmd("list");
     list_cmd.add_description("List registry snapshots or archive contents");
@@ -971,6 +1145,13 @@ int main(int argc, char* argv[])
         .default_value(false)
         .implicit_value(true);
 
+    argparse::ArgumentParser describe_cmd("describe");
+    describe_cmd.add_description("Change the description of a snapshot (copies entries without recompressing)");
+    describe_cmd.add_argument("snapshot")
+        .help("Path to .zip, or 1/2/3 for instance");
+    describe_cmd.add_argument("description")
+        .help("New description (empty string removes it)");
+
     argparse::ArgumentParser uninstall_cmd("uninstall");
     uninstall_cmd.add_description("Remove installed resources (shutdown -> uninstall)");
     uninstall_cmd.add_argument("source")
@@ -988,6 +1169,10 @@ int main(int argc, char* argv[])
         .help("List individual files that differ, are missing, or extra")
         .default_value(false)
         .implicit_value(true);
+    verify_cmd.add_argument("--fast")
+        .help("Treat files with unchanged size and modification time as matching (skip hashing)")
+        .default_value(false)
+        .implicit_value(true);
 
     argparse::ArgumentParser startup_cmd("startup");
     startup_cmd.add_description("Run startup hooks (start the application)");
@@ -1007,6 +1192,30 @@ int main(int argc, char* argv[])
         .default_value(false)
         .implicit_value(true);
 
+    argparse::ArgumentParser benchmark_cmd("benchmark");
+    benchmark_cmd.add_description("Time backup/restore/clean/verify and snapshot access on generated data");
+    benchmark_cmd.add_argument("-o", "--output")
+        .help("Write results as JSON to this file")
+        .default_value(std::string{});
+    benchmark_cmd.add_argument("--work")
+        .help("Directory for generated data (must be empty; default: %TEMP%\\insti-benchmark)")
+        .default_value(std::string{});
+    benchmark_cmd.add_argument("-n", "--iterations")
+        .help("Timed runs per benchmark")
+        .default_value(3)
+        .scan<'i', int>();
+    benchmark_cmd.add_argument("--scale")
+        .help("Multiply generated file counts and sizes (1.0 generates about 1 GB)")
+        .default_value(1.0)
+        .scan<'g', double>();
+    benchmark_cmd.add_argument("--filter")
+        .help("Only run benchmarks whose name contains this text (e.g. copy_directory.restore)")
+        .default_value(std::string{});
+    benchmark_cmd.add_argument("--keep")
+        .help("Keep generated data")
+        .default_value(false)
+        .implicit_value(true);
+
     program.add_subparser(backup_cmd);
     program.add_subparser(restore_cmd);
     program.add_subparser(uninstall_cmd);
@@ -1014,6 +1223,8 @@ int main(int argc, char* argv[])
     program.add_subparser(startup_cmd);
     program.add_subparser(shutdown_cmd);
     program.add_subparser(list_cmd);
+    program.add_subparser(describe_cmd);
+    program.add_subparser(benchmark_cmd);
 
     try
     {
@@ -1035,17 +1246,22 @@ int main(int argc, char* argv[])
     con::format_line("insti v{}", insti::version());
     con::write_line("");
 
+    TraceSession trace{program.get<std::string>("--trace")};
+
     if (program.is_subcommand_used("backup"))
         return cmd_backup(backup_cmd.get<std::string>("blueprint"),
                          backup_cmd.get<std::string>("output"),
                          backup_cmd.get<bool>("--force"),
-                         backup_cmd.get<std::string>("--description"));
+                         backup_cmd.get<std::string>("--description"),
+                         backup_cmd.get<std::string>("--parent"),
+                         backup_cmd.get<bool>("--incremental"));
 
     if (program.is_subcommand_used("restore"))
         return cmd_restore(restore_cmd.get<std::string>("snapshot"),
                           restore_cmd.get<std::string>("--dest"),
                           restore_cmd.get<std::vector<std::string>>("--var"),
-                          restore_cmd.get<bool>("--force"));
+                          restore_cmd.get<bool>("--force"),
+                          restore_cmd.get<bool>("--delta"));
 
     if (program.is_subcommand_used("uninstall"))
         return cmd_clean(uninstall_cmd.get<std::string>("source"),
@@ -1053,7 +1269,8 @@ int main(int argc, char* argv[])
 
     if (program.is_subcommand_used("verify"))
         return cmd_verify(verify_cmd.get<std::string>("source"),
-                         verify_cmd.get<bool>("--list"));
+                         verify_cmd.get<bool>("--list"),
+                         verify_cmd.get<bool>("--fast"));
 
     if (program.is_subcommand_used("startup"))
         return cmd_startup(startup_cmd.get<std::string>("source"),
@@ -1063,11 +1280,23 @@ int main(int argc, char* argv[])
         return cmd_shutdown(shutdown_cmd.get<std::string>("source"),
                            shutdown_cmd.get<bool>("--force"));
 
+    if (program.is_subcommand_used("describe"))
+        return cmd_describe(describe_cmd.get<std::string>("snapshot"),
+                           describe_cmd.get<std::string>("description"));
+
     if (program.is_subcommand_used("list"))
         return cmd_list(list_cmd.get<std::string>("snapshot"),
                        list_cmd.get<std::string>("--project"),
                        list_cmd.get<bool>("--xml"));
 
+    if (program.is_subcommand_used("benchmark"))
+        return cmd_benchmark(benchmark_cmd.get<std::string>("--work"),
+                            benchmark_cmd.get<std::string>("--output"),
+                            benchmark_cmd.get<int>("--iterations"),
+                            benchmark_cmd.get<double>("--scale"),
+                            benchmark_cmd.get<std::string>("--filter"),
+                            benchmark_cmd.get<bool>("--keep"));
+
     // No subcommand - default to list
     return cmd_list("", "", false);
 }
@@ -49,6 +49,8 @@ namespace instinctiv
 		std::string progress_phase;                 // Current phase
 		std::string progress_detail;                // Current item being processed
 		int progress_percent = -1;                  // Progress percentage (-1 = indeterminate)
+		double progress_bytes_per_second = 0.0;     // Throughput (0 = unknown)
+		int progress_eta_seconds = -1;              // Estimated time left (-1 = unknown)
 		std::vector<LogEntry> progress_log;         // Log messages with levels for coloring
 		insti::Project* active_blueprint = nullptr;  // Blueprint being used for operation (owned)
 
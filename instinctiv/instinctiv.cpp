@@ -543,6 +543,26 @@ namespace instinctiv
 
 			ImGui::Separator();
 
+			// Tracing: spans of everything run while checked go to a Chrome trace file next to the log
+			if (ImGui::MenuItem("Record Trace", nullptr, insti::Tracer::enabled()))
+			{
+				if (!insti::Tracer::enabled())
+				{
+					insti::Tracer::instance().start();
+					m_state.status_message = "Recording trace...";
+				}
+				else
+				{
+					const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+					const auto path = config::Settings::default_log_path().parent_path() / std::format("trace-{:%Y%m%d-%H%M%S}.json", now);
+					m_state.status_message = insti::Tracer::instance().stop(path.string())
+						? "Trace written to " + path.string()
+						: "Failed to write trace (see log)";
+				}
+			}
+
+			ImGui::Separator();
+
 			if (ImGui::MenuItem("Settings..."))
 			{
 				// Copy current roots to editable list
@@ -957,6 +977,8 @@ namespace instinctiv
 		m_state.progress_phase = "Starting";
 		m_state.progress_detail = "";
 		m_state.progress_percent = -1;
+		m_state.progress_bytes_per_second = 0.0;
+		m_state.progress_eta_seconds = -1;
 		m_state.progress_log.clear();
 		m_state.progress_log.push_back({LogEntry::Level::Info, "Starting restore: " + instance->project_name()});
 		m_state.progress_log.push_back({LogEntry::Level::Info, "From: " + instance->m_snapshot_path});
@@ -986,6 +1008,8 @@ namespace instinctiv
 		m_state.progress_phase = "Starting";
 		m_state.progress_detail = "";
 		m_state.progress_percent = -1;
+		m_state.progress_bytes_per_second = 0.0;
+		m_state.progress_eta_seconds = -1;
 		m_state.progress_log.clear();
 		m_state.progress_log.push_back({LogEntry::Level::Info, "Running hook: " + hook_name});
 		m_state.show_progress_dialog = true;
@@ -1012,6 +1036,8 @@ namespace instinctiv
 		m_state.progress_phase = "Starting";
 		m_state.progress_detail = "";
 		m_state.progress_percent = -1;
+		m_state.progress_bytes_per_second = 0.0;
+		m_state.progress_eta_seconds = -1;
 		m_state.progress_log.clear();
 		m_state.progress_log.push_back({LogEntry::Level::Info, "Running startup hooks for: " + blueprint->project_name()});
 		m_state.show_progress_dialog = true;
@@ -1038,6 +1064,8 @@ namespace instinctiv
 		m_state.progress_phase = "Starting";
 		m_state.progress_detail = "";
 		m_state.progress_percent = -1;
+		m_state.progress_bytes_per_second = 0.0;
+		m_state.progress_eta_seconds = -1;
 		m_state.progress_log.clear();
 		m_state.progress_log.push_back({LogEntry::Level::Info, "Running shutdown hooks for: " + blueprint->project_name()});
 		m_state.show_progress_dialog = true;
@@ -1809,8 +1837,14 @@ namespace instinctiv
 						instances.size(), instances.size() == 1 ? "" : "s",
 						projects.size(), projects.size() == 1 ? "" : "s");
 
+					const auto pending = m_state.m_snapshot_registry->pending_roots();
+					if (!pending.empty())
+						m_state.status_message += std::format(" ({} root{} still loading)",
+							pending.size(), pending.size() == 1 ? "" : "s");
+
 					// Check for empty registry on first refresh - show settings dialog
-					if (!m_state.first_refresh_done)
+					// (unless slow roots may still deliver blueprints)
+					if (!m_state.first_refresh_done && pending.empty())
 					{
 						m_state.first_refresh_done = true;
 						if (instances.empty() && projects.empty())
@@ -1829,6 +1863,8 @@ namespace instinctiv
 					m_state.progress_phase = m.phase;
 					m_state.progress_detail = m.detail;
 					m_state.progress_percent = m.percent;
+					m_state.progress_bytes_per_second = m.bytes_per_second;
+					m_state.progress_eta_seconds = m.eta_seconds;
 				}
 				else if constexpr (std::is_same_v<T, LogEntry>)
 				{
@@ -1951,6 +1987,16 @@ namespace instinctiv
 				// Other message types handled in future milestones
 				}, *msg);
 		}
+
+		// Pick up registry roots that were still loading when the refresh completed
+		if (m_state.m_snapshot_registry && m_state.m_snapshot_registry->publish_pending())
+		{
+			const auto& instances = m_state.m_snapshot_registry->m_instances;
+			const auto& projects = m_state.m_snapshot_registry->m_projects;
+			m_state.status_message = std::format("Found {} instance{}, {} project{}",
+				instances.size(), instances.size() == 1 ? "" : "s",
+				projects.size(), projects.size() == 1 ? "" : "s");
+		}
 	}
 
 	// Initialize logging
@@ -2031,6 +2077,8 @@ namespace instinctiv
 		m_state.progress_phase = "Starting";
 		m_state.progress_detail = "";
 		m_state.progress_percent = -1;
+		m_state.progress_bytes_per_second = 0.0;
+		m_state.progress_eta_seconds = -1;
 		m_state.progress_log.clear();
 		m_state.progress_log.push_back({LogEntry::Level::Info, "Verifying: " + project->project_name()});
 		m_state.progress_log.push_back({LogEntry::Level::Info, "(Project verification - checking resource existence)"});
@@ -2125,6 +2173,8 @@ namespace instinctiv
 		m_state.progress_phase = "Starting";
 		m_state.progress_detail = "";
 		m_state.progress_percent = -1;
+		m_state.progress_bytes_per_second = 0.0;
+		m_state.progress_eta_seconds = -1;
 		m_state.progress_log.clear();
 		m_state.progress_log.push_back({LogEntry::Level::Info, "Verifying: " + instance->project_name()});
 		m_state.progress_log.push_back({LogEntry::Level::Info, "(Instance verification - comparing file contents)"});
@@ -2162,6 +2212,13 @@ namespace instinctiv
 		if (m_state.progress_percent >= 0)
 		{
 			ImGui::ProgressBar(m_state.progress_percent / 100.0f, ImVec2(-1, 0));
+			if (m_state.progress_bytes_per_second > 0.0)
+			{
+				std::string rate = FormatFileSize(static_cast<uint64_t>(m_state.progress_bytes_per_second)) + "/s";
+				if (m_state.progress_eta_seconds >= 0)
+					rate += std::format(", {}:{:02} left", m_state.progress_eta_seconds / 60, m_state.progress_eta_seconds % 60);
+				ImGui::TextDisabled("%s", rate.c_str());
+			}
 		}
 		else
 		{
@@ -2474,6 +2531,8 @@ namespace instinctiv
 				m_state.progress_phase = "Starting...";
 				m_state.progress_detail.clear();
 				m_state.progress_percent = -1;
+				m_state.progress_bytes_per_second = 0.0;
+				m_state.progress_eta_seconds = -1;
 				m_state.progress_log.clear();
 				m_state.progress_log.push_back({LogEntry::Level::Info, "Starting backup: " + m_backupProject->project_name()});
 				m_state.progress_log.push_back({LogEntry::Level::Info, "Output: " + output_path.string()});
@@ -3002,6 +3061,8 @@ namespace instinctiv
 				m_state.progress_phase = "Starting";
 				m_state.progress_detail = "";
 				m_state.progress_percent = -1;
+				m_state.progress_bytes_per_second = 0.0;
+				m_state.progress_eta_seconds = -1;
 				m_state.progress_log.clear();
 				m_state.progress_log.push_back({LogEntry::Level::Info, "Uninstalling: " + m_uninstallTarget->project_name()});
 				m_state.show_progress_dialog = true;
@@ -21,6 +21,14 @@ void WorkerCallback::on_progress(std::string_view phase, std::string_view detail
         m_worker->post_to_ui(LogEntry{LogEntry::Level::Info, std::string{detail}});
 }
 
+void WorkerCallback::on_progress_info(const insti::ProgressInfo& info)
+{
+    const int eta = info.eta ? static_cast<int>(info.eta->count()) : -1;
+    m_worker->post_to_ui(Progress{std::string{info.phase}, std::string{info.detail}, info.percent, info.bytes_per_second, eta});
+    if (!info.detail.empty())
+        m_worker->post_to_ui(LogEntry{LogEntry::Level::Info, std::string{info.detail}});
+}
+
 void WorkerCallback::on_warning(std::string_view message)
 {
     m_worker->post_to_ui(LogEntry{LogEntry::Level::Warning, std::string{message}});
@@ -297,7 +305,8 @@ void WorkerThread::do_verify(const StartVerify& cmd)
         }
     }
 
-    auto results = orc.verify(cmd.m_blueprint.get(), &callback, reader_ptr);
+    // Routine GUI verify: skip hashing files whose size and mtime match the manifest
+    auto results = orc.verify(cmd.m_blueprint.get(), &callback, reader_ptr, true);
 
     if (reader_ptr)
         reader.close();
@@ -225,6 +225,8 @@ namespace instinctiv
 		std::string phase;
 		std::string detail;
 		int percent; // -1 for indeterminate
+		double bytes_per_second = 0.0; // 0 if unknown
+		int eta_seconds = -1;          // -1 if unknown
 	};
 
 	struct LogEntry
@@ -286,6 +288,7 @@ namespace instinctiv
 		explicit WorkerCallback(WorkerThread* worker);
 
 		void on_progress(std::string_view phase, std::string_view detail, int percent) override;
+		void on_progress_info(const insti::ProgressInfo& info) override;
 		void on_warning(std::string_view message) override;
 		Decision on_error(std::string_view message, std::string_view context) override;
 		Decision on_file_conflict(std::string_view path, std::string_view action) override;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <insti/core/action_callback.h>
+#include <insti/core/progress_tracker.h>
 #include <pnq/ref_counted.h>
 #include <string>
 #include <utility>
@@ -61,6 +62,12 @@ namespace insti
         /// @return true on success
         virtual bool restore(ActionContext *ctx) const = 0;
 
+        /// True if restore() can update an existing resource in place when
+        /// ctx->delta_restore() is set. The Orchestrator then skips clean() for this
+        /// action before restoring, and restore() removes what the snapshot lacks itself.
+        /// Default: false (clean, then restore).
+        virtual bool supports_delta_restore() const { return false; }
+
         /// Clean/remove the resource from the system.
         /// Default implementation calls do_clean() and handles errors.
         /// Override for complex multi-step clean operations.
@@ -73,6 +80,20 @@ namespace insti
         /// @return Verification result with status and detail
         virtual VerifyResult verify(ActionContext *ctx) const = 0;
 
+        /// Work the next backup (ctx has a writer) or restore (ctx has a reader) will do,
+        /// so the Orchestrator can plan progress across all actions before running them.
+        /// Work that is only cheap to measure while doing it (listing a tree to back up)
+        /// is left out here and added by the action through ProgressTracker::expect().
+        /// Default: nothing measurable (registry values, services, ...).
+        virtual ProgressEstimate estimate(ActionContext *ctx) const { return {}; }
+
+        /// Resources this action reads or writes, as lowercase '/'-separated paths
+        /// (see file_resource() and registry_resource()). The Orchestrator runs actions
+        /// concurrently unless their resources overlap, i.e. one is the other or lies
+        /// below it (see ActionScheduler).
+        /// @return Empty if unknown (default): the action runs on its own
+        virtual std::vector<std::string> resources(ActionContext *ctx) const { return {}; }
+
         /// Describe what this action would remove/affect during clean.
         /// Used for confirmation dialogs before uninstall.
         /// @return Human-readable description (e.g., "Folder: C:\Program Files\MyApp")
@@ -97,6 +118,13 @@ namespace insti
         /// @return true if exists or user chose to continue, false to abort
         static bool check_archive_exists(const std::string &archive_path, ActionContext *ctx);
 
+        /// Resource path for a file or directory ("file/c:/programdata/app").
+        static std::string file_resource(std::string_view path);
+
+        /// Resource path for a registry key or one of its values
+        /// ("registry/hkey_local_machine/software/app"); root abbreviations are expanded.
+        static std::string registry_resource(std::string_view key, std::string_view value = {});
+
         /// Override to implement clean logic. Called by default clean() implementation.
         /// @return true on success, false on failure
         virtual bool do_clean(ActionContext *ctx) const = 0;
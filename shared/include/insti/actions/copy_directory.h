@@ -1,6 +1,8 @@
 #pragma once
 
 #include <insti/actions/action.h>
+#include <insti/core/directory_scanner.h>
+#include <insti/core/glob.h>
 #include <string>
 #include <vector>
 #include <pnq/pnq.h>
@@ -11,8 +13,11 @@ namespace insti
     /// Captures and restores a directory tree.
     ///
     /// On backup, recursively copies all files from the source path into the snapshot.
-    /// On restore, extracts the files to the resolved destination path.
-    /// On clean, removes the entire directory.
+    /// On restore, extracts the files to the resolved destination path. In delta mode
+    /// (ActionContext::delta_restore()) an existing directory is updated in place instead:
+    /// only changed and missing files are extracted and only extras deleted.
+    /// On clean, removes the entire directory: it is renamed aside and deleted in the
+    /// background (see BackgroundDeleter), or file by file if it cannot be renamed.
     ///
     /// Supports optional include/exclude glob filters (e.g., "*.dll", "*.log").
     class CopyDirectoryAction : public IAction
@@ -22,11 +27,14 @@ namespace insti
     public:
         static constexpr std::string_view TYPE_NAME = "files";
 
+        /// Restores with at least this many files are extracted on a worker pool.
+        static constexpr size_t PARALLEL_RESTORE_MIN_FILES = 64;
+
         /// @param path Filesystem path (may contain variables like ${PROGRAMFILES})
         /// @param archive_path Relative path prefix within the snapshot archive
         /// @param description Optional user-facing description (defaults to "Files: {path}")
         /// @param recursive Whether to recurse into subdirectories (default: true)
-        /// @param include_filters Glob patterns to include (empty = include all)
+        /// @param include_filters Glob patterns to include (empty = include all); see GlobPattern
         /// @param exclude_filters Glob patterns to exclude (applied after include)
         CopyDirectoryAction(std::string path, std::string archive_path, std::string description = {},
                             bool recursive = true,
@@ -36,6 +44,7 @@ namespace insti
             , m_path{std::move(path)}, m_archive_path{std::move(archive_path)}
             , m_recursive{recursive}, m_include_filters{std::move(include_filters)}
             , m_exclude_filters{std::move(exclude_filters)}
+            , m_include_set{m_include_filters}, m_exclude_set{m_exclude_filters}
         {
         }
 
@@ -49,22 +58,30 @@ namespace insti
         std::vector<std::pair<std::string, std::string>> to_params() const override;
         bool backup(ActionContext *ctx) const override;
         bool restore(ActionContext *ctx) const override;
+        bool supports_delta_restore() const override { return true; }
         bool do_clean(ActionContext *ctx) const override;
         VerifyResult verify(ActionContext *ctx) const override;
         std::string describe_clean() const override;
+        std::vector<std::string> resources(ActionContext *ctx) const override;
+        ProgressEstimate estimate(ActionContext *ctx) const override;
 
-        /// Check if a filename matches the include/exclude filters.
-        /// @param filename Filename to check (not full path)
+        /// Check if a file matches the include/exclude filters.
+        /// @param rel_path Path relative to the directory root ('/'-separated); patterns
+        ///                 without a separator only look at the filename
         /// @return true if file should be included, false if filtered out
-        bool matches_filters(std::string_view filename) const;
+        bool matches_filters(std::string_view rel_path) const;
 
         /// Collected directory entries for backup.
         struct CollectedEntries
         {
             std::vector<std::filesystem::path> dirs;
-            std::vector<std::filesystem::path> files;
+            std::vector<ScannedEntry> files;  ///< With size/mtime from the directory listing
         };
 
+        /// Scanner configured with this action's recursion and filters; backup and verify
+        /// both use it, so they always consider the same files.
+        DirectoryScanner make_scanner() const;
+
         /// Collect directories and files from source, applying filters.
         /// @return collected entries, or nullopt on abort
         std::optional<CollectedEntries> collect_entries(
@@ -79,7 +96,7 @@ namespace insti
         /// Backup files to archive with progress reporting.
         /// @return true to continue, false on abort
         bool backup_files(
-            const std::filesystem::path &base, const std::vector<std::filesystem::path> &files,
+            const std::filesystem::path &base, const std::vector<ScannedEntry> &files,
             std::string_view archive_prefix, ActionContext *ctx) const;
 
         /// Delete files with retry/SkipAll support and progress reporting.
@@ -88,10 +105,16 @@ namespace insti
             const std::vector<std::filesystem::path> &files, ActionContext *ctx) const;
 
         /// Delete directories bottom-up (deepest first) with retry/SkipAll support.
+        /// @param remove_base Also delete base itself once its subdirectories are gone
         /// @return true to continue, false on abort
         bool clean_directories(
             const std::filesystem::path &base,
-            const std::vector<std::filesystem::path> &dirs, ActionContext *ctx) const;
+            const std::vector<std::filesystem::path> &dirs, ActionContext *ctx,
+            bool remove_base = true) const;
+
+        /// Queue trash directories next to base that an earlier clean left behind
+        /// (skipped locked files, crash) on the context's BackgroundDeleter.
+        void sweep_trash(const std::filesystem::path &base, ActionContext *ctx) const;
 
         /// Collected archive entries for restore.
         struct ArchiveEntries
@@ -103,6 +126,26 @@ namespace insti
         /// Collect directories and files from archive under prefix.
         ArchiveEntries collect_archive_entries(std::string_view archive_prefix, ActionContext *ctx) const;
 
+        /// Differences between the live directory and the snapshot, for delta restore.
+        struct DeltaPlan
+        {
+            std::vector<std::filesystem::path> stale_files;  ///< Extras and outdated files, deleted first
+            std::vector<std::filesystem::path> stale_dirs;   ///< Directories the snapshot lacks
+            std::vector<std::string> missing_dirs;           ///< Archive directories to create
+            std::vector<std::string> changed_files;          ///< Archive files to extract (archive order)
+            uint64_t unchanged_files = 0;
+            uint64_t unchanged_bytes = 0;
+        };
+
+        /// Compare the live directory with the archive entries. A file is unchanged only if
+        /// its size, its mtime (within the 2s zip granularity) and its CRC32 all match; entries
+        /// without a CRC32 are always extracted.
+        /// @return plan, or nullopt if the tree cannot be compared (not a directory,
+        ///         unreadable subtrees)
+        std::optional<DeltaPlan> plan_delta(
+            const std::filesystem::path &dest_base, const ArchiveEntries &entries,
+            ActionContext *ctx) const;
+
         /// Create directories for restore (top-down).
         /// @return true to continue, false on abort
         bool restore_directories(
@@ -115,11 +158,27 @@ namespace insti
             std::string_view archive_prefix, const std::filesystem::path &dest_base,
             const std::vector<std::string> &rel_files, ActionContext *ctx) const;
 
+        /// Extract files on a worker pool, one reader handle per worker.
+        /// Files that fail are retried serially with the usual retry/SkipAll handling.
+        /// @param prefix Normalized archive prefix (no trailing slash)
+        /// @return true to continue, false on abort
+        bool restore_files_parallel(
+            const std::string &prefix, const std::filesystem::path &dest_base,
+            const std::vector<std::string> &rel_files, ActionContext *ctx) const;
+
+        /// Extract a single file with retry/SkipAll support.
+        /// @return true to continue, false on abort
+        bool restore_file(
+            const std::string &archive_path, const std::filesystem::path &dest_path,
+            ActionContext *ctx) const;
+
         const std::string m_path;
         const std::string m_archive_path;
         const bool m_recursive;
         const std::vector<std::string> m_include_filters;
         const std::vector<std::string> m_exclude_filters;
+        const GlobSet m_include_set;  ///< m_include_filters, compiled
+        const GlobSet m_exclude_set;  ///< m_exclude_filters, compiled
     };
 
 } // namespace insti
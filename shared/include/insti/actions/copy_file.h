@@ -36,6 +36,8 @@ namespace insti
         bool do_clean(ActionContext *ctx) const override;
         VerifyResult verify(ActionContext *ctx) const override;
         std::string describe_clean() const override;
+        std::vector<std::string> resources(ActionContext *ctx) const override;
+        ProgressEstimate estimate(ActionContext *ctx) const override;
 
         const std::string m_path;
         const std::string m_archive_path;
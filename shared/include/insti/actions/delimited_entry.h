@@ -59,6 +59,7 @@ namespace insti
         bool do_clean(ActionContext *ctx) const override;
         VerifyResult verify(ActionContext *ctx) const override;
         std::string describe_clean() const override;
+        std::vector<std::string> resources(ActionContext *ctx) const override;
 
         std::string read_value() const;
         bool write_value(const std::string &value) const;
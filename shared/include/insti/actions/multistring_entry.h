@@ -46,6 +46,7 @@ namespace insti
         bool do_clean(ActionContext *ctx) const override;
         VerifyResult verify(ActionContext *ctx) const override;
         std::string describe_clean() const override;
+        std::vector<std::string> resources(ActionContext *ctx) const override;
 
         std::vector<std::string> read_multi_string() const;
         bool write_multi_string(const std::vector<std::string> &entries) const;
@@ -5,11 +5,29 @@
 // =============================================================================
 
 #include <pnq/ref_counted.h>
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string_view>
 
 namespace insti
 {
 
+    /// Operation-level progress, as reported by ProgressTracker.
+    struct ProgressInfo
+    {
+        std::string_view phase;
+        std::string_view detail;
+        int percent = -1;                 ///< 0-100 (weighted by bytes), or -1 if the total is unknown
+        uint64_t bytes_done = 0;
+        uint64_t bytes_total = 0;         ///< 0 if unknown
+        uint64_t items_done = 0;
+        uint64_t items_total = 0;         ///< 0 if unknown
+        double bytes_per_second = 0.0;    ///< Smoothed throughput (0 until measured)
+        double items_per_second = 0.0;    ///< Same in items, for work without bytes (deleting)
+        std::optional<std::chrono::seconds> eta;  ///< Remaining time, once throughput is known
+    };
+
     /// Callback interface for action progress, warnings, and error handling.
     /// Implementations can be CLI (auto-abort) or GUI (show dialogs).
     /// Refcounted - use PNQ_ADDREF/PNQ_RELEASE for ownership.
@@ -32,6 +50,13 @@ namespace insti
         /// @param percent Progress percentage (0-100), or -1 for indeterminate
         virtual void on_progress(std::string_view phase, std::string_view detail, int percent) = 0;
 
+        /// Operation-level progress with throughput and ETA (rate-limited by the caller).
+        /// Default implementation forwards to on_progress().
+        virtual void on_progress_info(const ProgressInfo& info)
+        {
+            on_progress(info.phase, info.detail, info.percent);
+        }
+
         /// Warning notification (execution continues).
         virtual void on_warning(std::string_view message) = 0;
 
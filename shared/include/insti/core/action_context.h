@@ -4,7 +4,11 @@
 // insti/core/action_context.h - Context for action execution
 // =============================================================================
 
+#include <insti/core/file_io.h>
+#include <insti/core/progress_tracker.h>
 #include <pnq/ref_counted.h>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -12,9 +16,11 @@
 namespace insti
 {
 
+    class BackgroundDeleter;
     class Blueprint;
     class SnapshotReader;
     class SnapshotWriter;
+    class ThreadPool;
     class IActionCallback;
 
     /// Context passed to actions during backup/restore/clean operations.
@@ -35,7 +41,9 @@ namespace insti
         /// @param blueprint Blueprint (retained, must not be nullptr)
         /// @param writer Snapshot writer for output (retained)
         /// @param callback Callback for progress/errors (retained, may be nullptr)
-        static ActionContext *for_backup(const Blueprint *blueprint, SnapshotWriter *writer, IActionCallback *callback);
+        /// @param parent Previous snapshot for incremental backup (retained, may be nullptr)
+        static ActionContext *for_backup(const Blueprint *blueprint, SnapshotWriter *writer, IActionCallback *callback,
+                                         SnapshotReader *parent = nullptr);
 
         /// Create context for restore operation.
         /// @param blueprint Blueprint (retained, must not be nullptr)
@@ -48,6 +56,16 @@ namespace insti
         /// @param callback Callback for progress/errors (retained, may be nullptr)
         static ActionContext *for_clean(const Blueprint *blueprint, IActionCallback *callback);
 
+        /// Create a context for one action running concurrently with others (ActionScheduler).
+        /// Copies the owner's settings, overrides and parent snapshot and shares its progress
+        /// and SkipAll flag.
+        /// @param owner Context of the operation (must outlive the new context)
+        /// @param reader Reader for this thread, e.g. a clone of the owner's (retained, may be nullptr)
+        /// @param writer Thread-safe writer (retained, may be nullptr)
+        /// @param callback Callback safe to use from this thread (retained, may be nullptr)
+        static ActionContext *for_worker(ActionContext *owner, SnapshotReader *reader, SnapshotWriter *writer,
+                                         IActionCallback *callback);
+
         /// @}
 
         /// @name Accessors
@@ -58,6 +76,23 @@ namespace insti
         SnapshotWriter *writer() const { return m_writer; }
         IActionCallback *callback() const { return m_callback; }
 
+        /// Parent snapshot for incremental backup (nullptr for a full backup).
+        /// Files unchanged since the parent are copied from it instead of re-read.
+        SnapshotReader *parent() const { return m_parent; }
+
+        /// Deletes trees that clean moved out of the way, in the background (may be nullptr:
+        /// actions then wait for the deletion themselves). Owned by the Orchestrator, which
+        /// waits for it before the operation completes.
+        BackgroundDeleter *background_deleter() const { return m_background_deleter; }
+
+        /// Set the background deleter (not retained; must outlive the context).
+        void set_background_deleter(BackgroundDeleter *deleter) { m_background_deleter = deleter; }
+
+        /// Byte-weighted progress shared by all actions of the operation.
+        /// The Orchestrator plans the totals up front; without a plan, actions add
+        /// their own work through expect().
+        ProgressTracker &progress() { return *m_progress; }
+
         /// @}
 
         /// @name Simulation Mode
@@ -72,14 +107,73 @@ namespace insti
 
         /// @}
 
+        /// @name Verification Mode
+        /// @{
+
+        /// Check if fast verify is active.
+        /// In fast mode, files whose size and modification time match the snapshot manifest
+        /// are considered unchanged without hashing their content.
+        bool verify_fast() const { return m_verify_fast; }
+
+        /// Enable/disable fast verify.
+        void set_verify_fast(bool value) { m_verify_fast = value; }
+
+        /// @}
+
+        /// @name Restore Mode
+        /// @{
+
+        /// Check if delta restore is active.
+        /// Actions that support it (IAction::supports_delta_restore()) were not cleaned
+        /// beforehand and bring the existing resource to the snapshot state themselves,
+        /// touching only what differs.
+        bool delta_restore() const { return m_delta_restore; }
+
+        /// Enable/disable delta restore.
+        void set_delta_restore(bool value) { m_delta_restore = value; }
+
+        /// @}
+
+        /// @name File I/O
+        /// @{
+
+        /// Files kept in flight by batched file I/O (see FileIo).
+        /// 1 reads and writes one file at a time on the calling thread.
+        unsigned io_queue_depth() const { return m_io_queue_depth; }
+
+        /// Set the file I/O queue depth.
+        void set_io_queue_depth(unsigned depth) { m_io_queue_depth = depth; }
+
+        /// Workers for batched file I/O, shared by all actions of the operation (may be
+        /// nullptr: each FileIo then starts its own). Owned by the Orchestrator.
+        ThreadPool *io_pool() const { return m_io_pool; }
+
+        /// Set the shared I/O pool (not retained; must outlive the context).
+        void set_io_pool(ThreadPool *pool) { m_io_pool = pool; }
+
+        /// Workers extracting files during restore, shared by all actions of the operation
+        /// (may be nullptr: actions then start their own). Owned by the Orchestrator.
+        ThreadPool *extract_pool() const { return m_extract_pool; }
+
+        /// Set the shared extraction pool (not retained; must outlive the context).
+        void set_extract_pool(ThreadPool *pool) { m_extract_pool = pool; }
+
+        /// @}
+
         /// @name Error Handling State
         /// @{
 
         /// Check if SkipAll mode is active (skip errors without prompting).
-        bool skip_all_errors() const { return m_skip_all_errors; }
+        /// Worker contexts share the flag with their owner, so a SkipAll chosen in one
+        /// concurrent action applies to the others at their next error.
+        bool skip_all_errors() const { return m_skip_all_errors->load(); }
 
         /// Enable SkipAll mode (typically called when user chooses SkipAll).
-        void set_skip_all_errors(bool value) { m_skip_all_errors = value; }
+        void set_skip_all_errors(bool value) { m_skip_all_errors->store(value); }
+
+        /// The shared SkipAll flag itself, for helpers that check and set it as they go
+        /// (e.g. BackgroundDeleter::wait()).
+        std::atomic<bool> &skip_all_flag() const { return *m_skip_all_errors; }
 
         /// @}
 
@@ -106,7 +200,8 @@ namespace insti
         ~ActionContext();
 
     private:
-        ActionContext(const Blueprint* blueprint, SnapshotReader* reader, SnapshotWriter* writer, IActionCallback* callback);
+        ActionContext(const Blueprint* blueprint, SnapshotReader* reader, SnapshotWriter* writer, IActionCallback* callback,
+                      ProgressTracker* progress);
 
         /// Rebuild merged variables from blueprint + overrides.
         void rebuild_merged_variables() const;
@@ -115,8 +210,17 @@ namespace insti
         SnapshotReader *m_reader = nullptr;
         SnapshotWriter *m_writer = nullptr;
         IActionCallback *m_callback = nullptr;
+        SnapshotReader *m_parent = nullptr;
+        BackgroundDeleter *m_background_deleter = nullptr;
         bool m_simulate = false;
-        bool m_skip_all_errors = false;
+        bool m_verify_fast = false;
+        bool m_delta_restore = false;
+        std::shared_ptr<std::atomic<bool>> m_skip_all_errors = std::make_shared<std::atomic<bool>>(false);  ///< Shared with worker contexts
+        unsigned m_io_queue_depth = FileIo::DEFAULT_QUEUE_DEPTH;
+        ThreadPool *m_io_pool = nullptr;
+        ThreadPool *m_extract_pool = nullptr;
+        std::unique_ptr<ProgressTracker> m_own_progress;  ///< nullptr for worker contexts
+        ProgressTracker *m_progress = nullptr;           ///< Own or the owner's tracker
 
         std::unordered_map<std::string, std::string> m_overrides;
         mutable std::unordered_map<std::string, std::string> m_merged_variables;
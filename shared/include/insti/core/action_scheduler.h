@@ -0,0 +1,66 @@
+#pragma once
+
+// =============================================================================
+// insti/core/action_scheduler.h - Runs independent actions concurrently
+// =============================================================================
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace insti
+{
+
+    class ActionContext;
+    class IAction;
+
+    /// Runs one step (backup, restore, clean) of a list of actions, concurrently where
+    /// they don't depend on each other.
+    ///
+    /// Dependencies are inferred from IAction::resources(): an action waits for every
+    /// earlier action whose resources overlap its own, and actions with unknown resources
+    /// wait for (and are waited for by) all others. The result is the same as running the
+    /// list in order, minus the waiting between unrelated actions.
+    ///
+    /// Each concurrently running action gets its own ActionContext (see
+    /// ActionContext::for_worker) with a clone of the reader and a synchronized writer.
+    /// IActionCallback calls from workers are forwarded to the thread calling run() and
+    /// executed there, so callbacks keep seeing a single thread.
+    class ActionScheduler final
+    {
+    public:
+        /// Concurrently running actions by default. Actions parallelize internally
+        /// (compression, extraction), so a few at a time are enough to overlap the waits.
+        static constexpr unsigned DEFAULT_MAX_PARALLEL = 4;
+
+        /// Step to run per action; false aborts the operation.
+        using Step = std::function<bool(const IAction *, ActionContext *)>;
+
+        /// @param actions Actions in execution order (reverse blueprint order for clean)
+        /// @param ctx Context of the operation; resources() is evaluated against it
+        ActionScheduler(std::vector<const IAction *> actions, ActionContext *ctx);
+
+        /// Upper limit of concurrently running actions (1 runs everything in order on the caller's thread).
+        void set_max_parallel(unsigned count) { m_max_parallel = count == 0 ? 1 : count; }
+
+        /// Run step for every action, each one after the actions it depends on.
+        /// After a failure no further actions are started; running ones finish first.
+        /// The owner context's skip-all state picks up SkipAll decisions of workers.
+        /// @return false if any step returned false
+        bool run(const Step &step);
+
+        /// True if two resource paths overlap: equal, or one lies below the other.
+        static bool overlap(std::string_view a, std::string_view b);
+
+    private:
+        bool run_serial(const Step &step);
+
+        std::vector<const IAction *> m_actions;
+        ActionContext *m_ctx;
+        std::vector<std::vector<size_t>> m_dependents;  ///< Actions waiting for each action
+        std::vector<size_t> m_dependency_count;         ///< Number of actions each one waits for
+        unsigned m_max_parallel = DEFAULT_MAX_PARALLEL;
+    };
+
+} // namespace insti
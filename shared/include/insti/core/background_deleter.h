@@ -0,0 +1,99 @@
+#pragma once
+
+// =============================================================================
+// insti/core/background_deleter.h - Rename-then-delete removal of directory trees
+// =============================================================================
+
+#include <pnq/pnq.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace insti
+{
+
+    class IActionCallback;
+    class ProgressTracker;
+
+    /// Removes directory trees without making the operation wait for them.
+    ///
+    /// move_to_trash() renames a directory to a hidden sibling on the same volume. That
+    /// is a single metadata operation regardless of the tree size, and the original path
+    /// is free at once (e.g. for a restore to extract into). The trash is then deleted on
+    /// a background thread, files in parallel on a ThreadPool.
+    ///
+    /// The owner of the operation calls wait() before finishing; it reports progress
+    /// through the callback on the calling thread. Workers never touch the callback:
+    /// files they cannot delete are handed back to wait(), which retries them with the
+    /// usual Retry/Skip handling.
+    ///
+    /// A directory with open files usually cannot be renamed. Callers then delete in
+    /// place, file by file, with the same Retry/Skip handling for locked files.
+    ///
+    /// Trash directories are hidden. One left behind by skipped files or a crash is
+    /// found by find_trash() and deleted by the next clean or restore of its directory.
+    class BackgroundDeleter final
+    {
+        PNQ_DECLARE_NON_COPYABLE(BackgroundDeleter)
+
+    public:
+        /// Infix of trash directory names: ".<name>.insti-trash-<id>".
+        static constexpr std::string_view TRASH_INFIX = ".insti-trash-";
+
+        BackgroundDeleter() = default;
+
+        /// Waits for pending deletions (without reporting progress).
+        ~BackgroundDeleter();
+
+        /// Rename a directory to a unique trash sibling.
+        /// @return trash path, or nullopt if the rename failed (path is left as it was)
+        static std::optional<std::filesystem::path> move_to_trash(const std::filesystem::path& path);
+
+        /// Trash siblings of path left behind by deletions that did not finish
+        /// (process exit, files that were still in use).
+        static std::vector<std::filesystem::path> find_trash(const std::filesystem::path& path);
+
+        /// Queue a directory tree for deletion on a background thread.
+        /// Thread-safe: concurrent actions may queue at the same time.
+        void delete_async(std::filesystem::path trash);
+
+        /// Wait until all queued trees are deleted.
+        /// Files the workers could not delete are retried here, asking cb (Retry, Skip,
+        /// SkipAll, Abort) for each one that still fails. Skipped files stay in the trash
+        /// and are picked up by find_trash() next time.
+        /// @param progress Advanced by the entries deleted, one item each
+        /// @param cb Receives errors (may be nullptr: failures are logged)
+        /// @param skip_all Skip failures without asking; set when the user chooses SkipAll.
+        ///                Read at each failure, so concurrent actions sharing it see each other's choice.
+        /// @return false if the user aborted
+        bool wait(ProgressTracker& progress, IActionCallback* cb, std::atomic<bool>& skip_all);
+
+    private:
+        /// Entries of a tree that could not be deleted in the background.
+        struct Leftovers
+        {
+            std::vector<std::filesystem::path> files;
+            std::vector<std::filesystem::path> dirs;  ///< Deepest first, the trash root last
+        };
+
+        /// Delete one tree: files in parallel, then directories deepest first.
+        Leftovers delete_tree(const std::filesystem::path& path);
+
+        /// Retry leftovers on the owner thread, with Retry/Skip per file.
+        /// @return false if the user aborted
+        static bool delete_leftovers(const std::filesystem::path& trash, const Leftovers& leftovers,
+                                     IActionCallback* cb, std::atomic<bool>& skip_all);
+
+        std::mutex m_mutex;  ///< Guards m_pending
+        std::vector<std::pair<std::filesystem::path, std::future<Leftovers>>> m_pending;
+        std::atomic<uint64_t> m_total{0};  ///< Entries found in queued trees so far
+        std::atomic<uint64_t> m_done{0};   ///< Entries deleted or given up on
+    };
+
+} // namespace insti
@@ -0,0 +1,114 @@
+#pragma once
+
+// =============================================================================
+// insti/core/benchmark.h - Synthetic data generators and performance harnesses
+// =============================================================================
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace insti
+{
+
+    class IActionCallback;
+
+    /// Shape of a generated directory tree.
+    enum class TreeShape
+    {
+        SmallFiles,      ///< Many small, compressible files in flat directories
+        LargeFiles,      ///< A few large, compressible files
+        DeepNesting,     ///< Long directory chains with one small file per level
+        Incompressible,  ///< Medium-sized files of random bytes
+    };
+
+    /// Name used in directory names and results, e.g. "small_files".
+    std::string_view tree_shape_name(TreeShape shape);
+
+    /// What a generator wrote.
+    struct GeneratedData
+    {
+        uint64_t bytes = 0;
+        uint64_t files = 0;
+        uint64_t directories = 0;
+    };
+
+    /// Timings of one benchmark.
+    struct BenchmarkResult
+    {
+        std::string name;              ///< Operation, e.g. "copy_directory.backup"
+        std::string dataset;           ///< Input, e.g. "small_files"
+        std::vector<double> samples;   ///< Wall time per iteration in milliseconds
+        uint64_t bytes = 0;            ///< Bytes processed per iteration
+        uint64_t items = 0;            ///< Files, entries or lookups per iteration
+
+        double min_ms() const;
+        double median_ms() const;
+        double mean_ms() const;
+        double max_ms() const;
+    };
+
+    /// Benchmark suite for comparing insti versions.
+    ///
+    /// Generates synthetic trees and snapshots below a work directory, then times
+    /// CopyDirectoryAction backup/restore/clean/verify (through the Orchestrator, as
+    /// users run them), SnapshotReader open and lookup, Blueprint::unresolve and
+    /// SnapshotRegistry::initialize. Generated data is deterministic, so results of
+    /// two builds on the same machine are comparable; to_json() writes them in a
+    /// stable, machine-readable form.
+    class BenchmarkSuite final
+    {
+    public:
+        struct Options
+        {
+            std::filesystem::path work_dir;          ///< Created if missing; trees and snapshots go below it
+            uint32_t iterations = 3;                 ///< Timed runs per benchmark
+            double scale = 1.0;                      ///< Multiplies file counts and sizes
+            std::vector<TreeShape> shapes{TreeShape::SmallFiles, TreeShape::LargeFiles,
+                                          TreeShape::DeepNesting, TreeShape::Incompressible};
+            std::string filter;                      ///< Only run benchmarks whose name contains this
+            bool keep_data = false;                  ///< Leave generated data in work_dir afterwards
+        };
+
+        explicit BenchmarkSuite(Options options);
+
+        /// @name Generators
+        /// @{
+
+        /// Write a synthetic tree. Content depends only on shape and scale.
+        /// @param root Directory to create (must not exist yet)
+        /// @return false if a file could not be written (logged)
+        static bool generate_tree(const std::filesystem::path& root, TreeShape shape, double scale, GeneratedData& generated);
+
+        /// Write a synthetic snapshot archive: an instance blueprint with one files
+        /// resource plus entry_count compressible entries of entry_size bytes.
+        /// @return false if the archive could not be written (logged)
+        static bool generate_snapshot(const std::filesystem::path& path, std::string_view project_name,
+                                      size_t entry_count, size_t entry_size, GeneratedData& generated);
+
+        /// @}
+
+        /// Generate data and run all benchmarks matching the filter.
+        /// @param cb Receives one progress report per benchmark (may be nullptr)
+        /// @return false if data could not be generated or an operation failed
+        bool run(IActionCallback* cb);
+
+        const std::vector<BenchmarkResult>& results() const { return m_results; }
+
+        /// Results and run parameters as a JSON document.
+        std::string to_json() const;
+
+    private:
+        bool selected(std::string_view name) const;
+        bool run_copy_directory(TreeShape shape);
+        bool run_snapshot_reader();
+        bool run_unresolve();
+        bool run_registry();
+
+        Options m_options;
+        std::vector<BenchmarkResult> m_results;
+    };
+
+} // namespace insti
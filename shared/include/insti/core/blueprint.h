@@ -12,6 +12,7 @@
 #include <pnq/pnq.h>
 #include <pnq/ref_counted.h>
 #include <insti/actions/action.h>
+#include <insti/core/multi_pattern.h>
 #include <insti/hooks/hook.h>
 
 namespace insti
@@ -134,7 +135,8 @@ namespace insti
 
         /// Reverse variable resolution - replace values with placeholders.
         /// Used during backup to make content portable (e.g., replace "MYPC" with "${COMPUTERNAME}").
-        /// Matches longest values first. Case-insensitive for path-like variables.
+        /// Single pass over the input: where values overlap, the leftmost and then the
+        /// longest wins. Case-insensitive (ASCII).
         /// @param input String containing literal values
         /// @return String with values replaced by ${VAR} placeholders
         std::string unresolve(std::string_view input) const;
@@ -169,6 +171,9 @@ namespace insti
         /// @return true on success, false if cycle detected
         bool resolve_user_variables();
 
+        /// Rebuild m_unresolver from m_resolved_variables (after every change to them).
+        void compile_unresolver();
+
         /// Get variable value by name.
         /// @param name Variable name to look up
         /// @return Reference to value, or empty string if not found
@@ -181,6 +186,7 @@ namespace insti
         std::unordered_map<std::string, std::string> m_user_variables;     ///< Raw user-defined variables
         std::unordered_map<std::string, std::string> m_builtin_variables;  ///< Built-in variables from system
         std::unordered_map<std::string, std::string> m_resolved_variables; ///< Combined resolved variables
+        MultiPatternReplacer m_unresolver;                                 ///< Values -> ${VAR}, for unresolve()
     };
 
 } // namespace insti
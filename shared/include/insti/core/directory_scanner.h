@@ -0,0 +1,87 @@
+#pragma once
+
+// =============================================================================
+// insti/core/directory_scanner.h - Parallel directory tree enumeration
+// =============================================================================
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace insti
+{
+
+    /// Directory or file found by DirectoryScanner.
+    ///
+    /// Type, size and modification time come from the directory listing itself,
+    /// so consumers need no further stat calls.
+    struct ScannedEntry
+    {
+        std::filesystem::path path;  ///< Full path (root joined with relative path)
+        uint64_t size = 0;           ///< File size in bytes (0 for directories)
+        int64_t mtime = 0;           ///< Last write time as time_t (0 if unknown)
+        bool is_directory = false;
+    };
+
+    /// Directory that could not be enumerated.
+    struct ScanError
+    {
+        std::filesystem::path path;
+        std::string message;
+    };
+
+    /// Result of DirectoryScanner::scan(), sorted by path for deterministic output.
+    struct ScanResult
+    {
+        std::vector<ScannedEntry> dirs;
+        std::vector<ScannedEntry> files;
+        std::vector<ScanError> errors;  ///< Subtrees skipped because they could not be listed
+        bool root_failed = false;       ///< The root itself could not be listed
+    };
+
+    /// Walks a directory tree with one listing per directory, subdirectories in parallel.
+    ///
+    /// Each directory is one unit of work on a ThreadPool; listing a directory queues its
+    /// subdirectories, so idle workers pick up whichever subtree is next. The file filter
+    /// runs on worker threads during the walk and must be thread-safe.
+    ///
+    /// Directory reparse points (junctions, symlinks) are reported but not descended into,
+    /// matching std::filesystem::recursive_directory_iterator defaults.
+    ///
+    /// Errors are collected rather than reported, so the caller can route them through
+    /// IActionCallback on its own thread.
+    class DirectoryScanner final
+    {
+    public:
+        /// Decides whether a file is returned; receives the path relative to the scanned
+        /// root with '/' separators (the filename for files directly in the root).
+        using FileFilter = std::function<bool(std::string_view rel_path)>;
+
+        /// Descend into subdirectories (default: true). If false, only direct children are listed.
+        void set_recursive(bool recursive) { m_recursive = recursive; }
+
+        /// Filter for files (default: none). Directories are always returned.
+        void set_file_filter(FileFilter filter) { m_file_filter = std::move(filter); }
+
+        /// Worker threads (0 = one per hardware thread, 1 = walk on the calling thread).
+        void set_thread_count(unsigned count) { m_thread_count = count; }
+
+        /// Flag that stops the walk once set: directories not yet listed are skipped, so
+        /// the result is incomplete. The caller checks the flag itself.
+        void set_cancel_flag(const std::atomic<bool>* cancel) { m_cancel = cancel; }
+
+        /// Enumerate the tree below root (root itself is not included).
+        ScanResult scan(const std::filesystem::path& root) const;
+
+    private:
+        bool m_recursive = true;
+        FileFilter m_file_filter;
+        unsigned m_thread_count = 0;
+        const std::atomic<bool>* m_cancel = nullptr;
+    };
+
+} // namespace insti
@@ -0,0 +1,155 @@
+#pragma once
+
+// =============================================================================
+// insti/core/file_io.h - Whole-file I/O backends for small-file-heavy trees
+// =============================================================================
+
+#include <pnq/pnq.h>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace insti
+{
+
+    class ThreadPool;
+
+    /// Reads and writes whole files on behalf of backup and restore.
+    ///
+    /// Trees of many small files are bound by per-file latency (open, on-access
+    /// scanning, close) rather than by bandwidth. A backend decides how many files are
+    /// in flight at once:
+    /// - BlockingFileIo performs each request in submit(), on the calling thread
+    ///   (portable fallback, queue depth 1).
+    /// - QueuedFileIo keeps up to queue_depth() requests in flight on a worker pool.
+    ///
+    /// Usage follows a submission/completion queue: submit() requests while !full(),
+    /// then take completions with complete(), which returns them in submission order.
+    /// Only the owner thread calls submit() and complete(); requests never touch
+    /// IActionCallback, so failures can be handled (Retry/Skip) by the caller.
+    class FileIo
+    {
+        PNQ_DECLARE_NON_COPYABLE(FileIo)
+
+    public:
+        /// Default number of requests in flight.
+        static constexpr unsigned DEFAULT_QUEUE_DEPTH = 32;
+
+        /// Files up to this size are read or written in one piece through a backend;
+        /// larger ones are streamed by the caller instead of buffered.
+        static constexpr uint64_t MAX_BUFFERED_SIZE = 1024 * 1024;
+
+        struct Request
+        {
+            enum class Kind : uint8_t { Read, Write };
+
+            Kind kind = Kind::Read;
+            std::filesystem::path path;
+            std::vector<uint8_t> data;   ///< Write: content
+            int64_t mtime = 0;           ///< Write: modification time as time_t (0 = leave as is)
+            size_t tag = 0;              ///< Caller's index, returned with the completion
+        };
+
+        struct Completion
+        {
+            size_t tag = 0;
+            bool ok = false;
+            std::vector<uint8_t> data;   ///< Read: content
+            int64_t mtime = 0;           ///< Read: modification time as time_t (0 if unknown)
+            std::string error;           ///< Set if !ok
+        };
+
+        virtual ~FileIo() = default;
+
+        /// Queue a request. Call only while !full().
+        virtual void submit(Request request) = 0;
+
+        /// Wait for the oldest outstanding request. Call only while pending() > 0.
+        virtual Completion complete() = 0;
+
+        /// Requests submitted but not yet completed.
+        virtual size_t pending() const = 0;
+
+        /// Maximum number of requests in flight.
+        unsigned queue_depth() const { return m_queue_depth; }
+
+        bool full() const { return pending() >= m_queue_depth; }
+
+        /// Backend for a queue depth: BlockingFileIo for 0 or 1, QueuedFileIo otherwise.
+        /// @param pool Workers shared with other backends of the same operation (not
+        ///             retained, may be nullptr: the backend then starts its own)
+        static std::unique_ptr<FileIo> create(unsigned queue_depth, ThreadPool* pool = nullptr);
+
+        /// @name Single-file primitives used by all backends
+        /// One handle per file: size, content and times come from the same open.
+        /// @{
+
+        /// Read a whole file.
+        static Completion read_file(const std::filesystem::path& path);
+
+        /// Create or replace a file with data, preallocated to its final size.
+        /// @param mtime Modification time as time_t to set (0 = leave as is)
+        /// @return empty on success, error message otherwise
+        static std::string write_file(const std::filesystem::path& path, std::span<const uint8_t> data, int64_t mtime);
+
+        /// @}
+
+    protected:
+        explicit FileIo(unsigned queue_depth)
+            : m_queue_depth{queue_depth}
+        {
+        }
+
+        /// Perform one request on the current thread.
+        static Completion execute(Request& request);
+
+    private:
+        const unsigned m_queue_depth;
+    };
+
+    /// Performs every request on the calling thread as it is submitted.
+    class BlockingFileIo final : public FileIo
+    {
+    public:
+        BlockingFileIo()
+            : FileIo{1}
+        {
+        }
+
+        void submit(Request request) override;
+        Completion complete() override;
+        size_t pending() const override { return m_done.size(); }
+
+    private:
+        std::deque<Completion> m_done;
+    };
+
+    /// Keeps up to queue_depth requests in flight on a worker pool.
+    ///
+    /// Actions running concurrently share one pool (ActionContext::io_pool()), so the
+    /// number of I/O threads does not grow with the number of actions.
+    class QueuedFileIo final : public FileIo
+    {
+    public:
+        /// @param queue_depth Requests in flight
+        /// @param pool Shared workers (not retained, must outlive this backend), or nullptr
+        ///             to start queue_depth workers of its own
+        explicit QueuedFileIo(unsigned queue_depth, ThreadPool* pool = nullptr);
+        ~QueuedFileIo() override;
+
+        void submit(Request request) override;
+        Completion complete() override;
+        size_t pending() const override { return m_in_flight.size(); }
+
+    private:
+        std::unique_ptr<ThreadPool> m_own_pool;
+        ThreadPool* m_pool;  ///< Shared or own pool
+        std::deque<std::future<Completion>> m_in_flight;
+    };
+
+} // namespace insti
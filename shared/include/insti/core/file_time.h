@@ -0,0 +1,39 @@
+#pragma once
+
+// =============================================================================
+// insti/core/file_time.h - Conversions between file timestamps and time_t
+// =============================================================================
+
+#include <cstdint>
+#include <filesystem>
+
+struct _FILETIME;  // FILETIME from <Windows.h>
+
+namespace insti
+{
+
+    /// Converts file modification times to and from the time_t seconds stored in
+    /// snapshots, manifests and indexes.
+    class FileTime final
+    {
+    public:
+        /// Offset between the FILETIME epoch (1601) and the Unix epoch, in 100ns ticks.
+        static constexpr int64_t UNIX_EPOCH_TICKS = 116444736000000000LL;
+
+        /// 100ns ticks per second.
+        static constexpr int64_t TICKS_PER_SECOND = 10000000;
+
+        /// FILETIME as time_t (0 for times before 1970).
+        static int64_t to_time_t(const _FILETIME& time);
+
+        /// std::filesystem timestamp as time_t.
+        static int64_t to_time_t(std::filesystem::file_time_type time);
+
+        /// time_t as FILETIME, e.g. for SetFileTime().
+        static _FILETIME to_filetime(int64_t time);
+
+        /// Last write time of a file as time_t (0 if unavailable).
+        static int64_t last_write_time(const std::filesystem::path& path);
+    };
+
+} // namespace insti
@@ -0,0 +1,82 @@
+#pragma once
+
+// =============================================================================
+// insti/core/glob.h - Compiled case-insensitive glob patterns
+// =============================================================================
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace insti
+{
+
+    /// Single compiled glob pattern.
+    ///
+    /// Syntax (case-insensitive, '/' and '\' are equivalent):
+    ///   ?    any one character except a separator
+    ///   *    any run of characters except a separator
+    ///   **   as a whole path segment: zero or more directories
+    ///
+    /// A pattern without a separator matches the filename at any depth
+    /// ("*.log"). A pattern with a separator matches the whole path relative to
+    /// the scanned root ("bin/*.dll", "**/cache/**", "/setup.ini").
+    class GlobPattern final
+    {
+    public:
+        explicit GlobPattern(std::string_view pattern);
+
+        /// Match a root-relative path ('/'-separated). Filename-only patterns look at the last segment.
+        bool matches(std::string_view rel_path) const;
+
+        /// True if the pattern contains a separator and is matched against the whole path.
+        bool is_path_pattern() const { return m_path_pattern; }
+
+        /// True if the pattern contains no wildcards at all.
+        bool is_literal() const;
+
+        /// Lowercased pattern segments (a single segment for filename patterns).
+        const std::vector<std::string>& segments() const { return m_segments; }
+
+        /// Match one lowercased segment against a lowercased pattern segment (* and ? only).
+        static bool match_segment(std::string_view pattern, std::string_view text);
+
+    private:
+        friend class GlobSet;
+
+        /// matches() for a path that is already lowercased with '/' separators.
+        bool matches_normalized(std::string_view path) const;
+
+        std::vector<std::string> m_segments;  ///< Lowercased, "**" kept as its own segment
+        bool m_path_pattern = false;
+    };
+
+    /// Set of glob patterns compiled for repeated matching against many paths.
+    ///
+    /// Literal filenames and plain extension patterns ("*.dll") are answered by hash
+    /// lookups, so typical include/exclude lists cost one or two lookups per file
+    /// regardless of their length. Only patterns that need it fall back to wildcard
+    /// matching.
+    class GlobSet final
+    {
+    public:
+        GlobSet() = default;
+        explicit GlobSet(const std::vector<std::string>& patterns);
+
+        void add(std::string_view pattern);
+
+        bool empty() const { return m_count == 0; }
+        size_t size() const { return m_count; }
+
+        /// True if any pattern matches the root-relative path ('/'-separated).
+        bool matches(std::string_view rel_path) const;
+
+    private:
+        std::unordered_set<std::string> m_names;       ///< Lowercased literal filenames
+        std::unordered_set<std::string> m_extensions;  ///< Lowercased extensions of "*.ext" patterns, without dot
+        std::vector<GlobPattern> m_patterns;           ///< Everything else
+        size_t m_count = 0;
+    };
+
+} // namespace insti
@@ -0,0 +1,99 @@
+#pragma once
+
+// =============================================================================
+// insti/core/multi_pattern.h - Compiled case-insensitive multi-pattern replacement
+// =============================================================================
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace insti
+{
+
+    /// Replaces many literal patterns in one pass (Aho-Corasick automaton).
+    ///
+    /// Matching is case-insensitive for ASCII letters; other bytes (including UTF-8
+    /// sequences) must match exactly. Where matches overlap, the leftmost one wins,
+    /// and of those starting at the same position the longest, so
+    /// "C:\Program Files (x86)" is replaced as a whole rather than "C:\Program Files".
+    ///
+    /// The automaton is a full transition table over the bytes that occur in the
+    /// patterns, so replace() costs one table lookup per input byte regardless of
+    /// the number of patterns. Immutable after construction; safe to share between
+    /// threads.
+    class MultiPatternReplacer final
+    {
+    public:
+        /// Empty replacer: replace() returns its input unchanged.
+        MultiPatternReplacer();
+
+        /// @param patterns (pattern, replacement) pairs; empty patterns are ignored.
+        ///                 If a pattern occurs twice (ignoring case), the first one wins.
+        explicit MultiPatternReplacer(const std::vector<std::pair<std::string, std::string>>& patterns);
+
+        bool empty() const { return m_replacements.empty(); }
+
+        /// Replace all non-overlapping matches, leftmost-longest.
+        std::string replace(std::string_view input) const;
+
+        /// Incremental replace() for input that arrives in chunks (e.g. large files).
+        ///
+        /// Output is identical to replace() over the concatenated input: bytes that may
+        /// still be part of a match continuing in the next chunk are held back (less
+        /// than the longest pattern), everything before them is emitted right away.
+        class Stream final
+        {
+        public:
+            explicit Stream(const MultiPatternReplacer& replacer) : m_replacer{replacer} {}
+
+            /// Process the next chunk, appending finished output to out.
+            void write(std::string_view chunk, std::string& out);
+
+            /// End of input: flush the held-back bytes.
+            void finish(std::string& out);
+
+            /// Number of replacements made so far.
+            size_t replacements() const { return m_replacements; }
+
+        private:
+            const MultiPatternReplacer& m_replacer;
+            std::string m_carry;       ///< Held-back tail of the previous chunk
+            size_t m_replacements = 0;
+        };
+
+    private:
+        using StateId = uint32_t;
+
+        static constexpr StateId ROOT = 0;
+        static constexpr uint32_t NO_MATCH = UINT32_MAX;
+
+        struct State
+        {
+            uint32_t depth = 0;          ///< Length of the pattern prefix this state stands for
+            uint32_t match = NO_MATCH;   ///< Longest pattern ending here (own or via suffix links)
+            uint32_t match_length = 0;   ///< Length of that pattern
+        };
+
+        StateId next(StateId state, unsigned char c) const
+        {
+            return m_delta[state * m_class_count + m_class[c]];
+        }
+
+        /// Append the replaced input to out.
+        /// @param final false if more input follows: a tail that may still match is not emitted
+        /// @param replacements Incremented per replacement
+        /// @return Number of input bytes consumed (all of them if final)
+        size_t replace_into(std::string_view input, bool final, std::string& out, size_t& replacements) const;
+
+        std::array<uint8_t, 256> m_class{};    ///< Byte -> alphabet class (0 = not in any pattern)
+        uint32_t m_class_count = 1;
+        std::vector<State> m_states;
+        std::vector<StateId> m_delta;          ///< states x classes transition table
+        std::vector<std::string> m_replacements;
+    };
+
+} // namespace insti
@@ -23,11 +23,28 @@ namespace insti
 	class Orchestrator final
 	{
 		SnapshotRegistry* m_snapshot_registry;
+		unsigned m_max_parallel_actions;
+		bool m_delta_restore;
+		unsigned m_io_queue_depth;
 	public:
 		Orchestrator(SnapshotRegistry* snapshot_registry);
 		~Orchestrator();
 		PNQ_DECLARE_NON_COPYABLE(Orchestrator);
 
+		/// Maximum number of actions run at the same time during backup/restore/clean
+		/// (see ActionScheduler). 1 runs all actions in blueprint order.
+		void set_max_parallel_actions(unsigned count) { m_max_parallel_actions = count; }
+
+		/// Restore only what differs from the snapshot (default: off). Actions that support
+		/// it (see IAction::supports_delta_restore()) are not cleaned first; they compare the
+		/// live resource with the snapshot, rewrite changed and missing parts and delete
+		/// extras. false cleans every action and restores everything.
+		void set_delta_restore(bool enabled) { m_delta_restore = enabled; }
+
+		/// Files kept in flight while reading during backup (see FileIo).
+		/// 1 reads one file at a time on the calling thread.
+		void set_io_queue_depth(unsigned depth) { m_io_queue_depth = depth; }
+
 		/// Backup blueprint to snapshot.
 		/// Runs: shutdown -> backup -> startup
 		/// @param bp Blueprint (must not be nullptr)
@@ -35,11 +52,22 @@ namespace insti
 		/// @param cb Callback for progress/errors (may be nullptr for silent operation)
 		/// @param force If true, also run force-only shutdown hooks (aggressive termination)
 		/// @param description Optional description for this snapshot (overrides project description)
+		/// @param parent_path Optional previous snapshot; files whose size and mtime match it are
+		///        copied from it without recompression (incremental backup)
+		/// @return true on success
+		bool backup(const Project* bp, std::string_view output_path, IActionCallback* cb, bool force = false, const std::string& description = {},
+			std::string_view parent_path = {});
+
+		/// Change the description stored in a snapshot's blueprint.xml.
+		/// All other entries are copied as stored (no recompression) into a new
+		/// archive, which then replaces the original.
+		/// @param snapshot_path Path to snapshot file
+		/// @param description New instance description (empty removes it)
 		/// @return true on success
-		bool backup(const Project* bp, std::string_view output_path, IActionCallback* cb, bool force = false, const std::string& description = {});
+		bool update_description(std::string_view snapshot_path, const std::string& description);
 
 		/// Restore from snapshot with pre-loaded blueprint (allows variable overrides via context).
-		/// Runs: restore -> startup
+		/// Runs: clean -> restore -> startup (see set_delta_restore())
 		/// @param bp Blueprint (must not be nullptr)
 		/// @param archive_path Path to snapshot file
 		/// @param cb Callback for progress/errors (may be nullptr for silent operation)
@@ -62,8 +90,10 @@ namespace insti
 		/// @param cb Callback for progress (may be nullptr)
 		/// @param reader Snapshot reader for instance verification (optional)
 		///               When provided, enables file-level comparison against archive
+		/// @param fast If true, trust matching size and modification time from the
+		///             snapshot manifest instead of hashing file content
 		/// @return Verification results for each action
-		std::vector<VerifyResult> verify(const Blueprint* bp, IActionCallback* cb, SnapshotReader* reader = nullptr);
+		std::vector<VerifyResult> verify(const Blueprint* bp, IActionCallback* cb, SnapshotReader* reader = nullptr, bool fast = false);
 
 		/// Run startup hooks only.
 		/// @param bp Blueprint (must not be nullptr)
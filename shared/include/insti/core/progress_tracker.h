@@ -0,0 +1,92 @@
+#pragma once
+
+// =============================================================================
+// insti/core/progress_tracker.h - Byte-weighted operation progress with ETA
+// =============================================================================
+
+#include <insti/core/action_callback.h>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace insti
+{
+
+    /// Amount of work an action will do, see IAction::estimate().
+    struct ProgressEstimate
+    {
+        uint64_t bytes = 0;  ///< File content to be copied
+        uint64_t items = 0;  ///< Files to be copied
+    };
+
+    /// Operation-level progress for one backup/restore/clean.
+    ///
+    /// Progress is weighted by bytes, so one large file and thousands of small ones
+    /// both move the bar in proportion to the time they take; work without bytes
+    /// (deleting) is weighted by items. Throughput is smoothed over the reporting
+    /// interval and drives the ETA. Reports are rate-limited:
+    /// posting every file to a GUI queue costs measurable time on large trees.
+    ///
+    /// Thread-safe, so actions running concurrently (ActionScheduler) can share one
+    /// tracker. The callback is invoked outside the lock, from whichever thread
+    /// advances; the scheduler points it at a callback that forwards to the owner.
+    class ProgressTracker final
+    {
+    public:
+        /// Minimum time between two reports (at most 10 per second).
+        static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{100};
+
+        /// @param callback Receives on_progress_info() (may be nullptr)
+        /// @param phase Phase name reported with every update (e.g. "Backup")
+        ProgressTracker(IActionCallback* callback, std::string phase);
+
+        ProgressTracker(const ProgressTracker&) = delete;
+        ProgressTracker& operator=(const ProgressTracker&) = delete;
+
+        /// Callback receiving the reports (may be nullptr); returns the previous one.
+        IActionCallback* set_callback(IActionCallback* callback);
+
+        /// Minimum time between two reports (0 reports every call).
+        void set_interval(std::chrono::milliseconds interval) { m_interval = interval; }
+
+        /// Set the totals for the whole operation (computed up front across all actions).
+        void plan(const ProgressEstimate& total);
+
+        /// Add work an action only learns about while running, beyond its estimate():
+        /// a backup lists its source tree once, in backup(), not again up front.
+        void expect(const ProgressEstimate& work);
+
+        /// Record finished work. Reports if the interval has passed.
+        void advance(uint64_t bytes, uint64_t items, std::string_view detail);
+
+        /// Report the current state now, regardless of the interval.
+        void flush(std::string_view detail);
+
+        uint64_t bytes_done() const;
+        uint64_t items_done() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        /// Update the throughput and build the report (m_mutex held).
+        ProgressInfo sample(std::string_view detail, Clock::time_point now);
+
+        mutable std::mutex m_mutex;
+        IActionCallback* m_callback;
+        std::string m_phase;
+        std::chrono::milliseconds m_interval = DEFAULT_INTERVAL;
+
+        ProgressEstimate m_total;
+        ProgressEstimate m_done;
+
+        Clock::time_point m_last_report{};  ///< Time of the last report (epoch = never)
+        Clock::time_point m_last_sample{};  ///< Start of the current throughput sample
+        uint64_t m_sample_bytes = 0;        ///< bytes_done() at m_last_sample
+        uint64_t m_sample_items = 0;        ///< items_done() at m_last_sample
+        double m_rate = 0.0;                ///< Smoothed bytes per second
+        double m_item_rate = 0.0;           ///< Smoothed items per second
+    };
+
+} // namespace insti
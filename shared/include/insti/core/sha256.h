@@ -0,0 +1,50 @@
+#pragma once
+
+// =============================================================================
+// insti/core/sha256.h - Incremental SHA-256 (Windows CNG)
+// =============================================================================
+
+#include <pnq/pnq.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace insti
+{
+
+    /// Incremental SHA-256 hasher.
+    ///
+    /// Used for content addressing (BlobStore) and per-file snapshot manifests.
+    /// The CNG algorithm provider is opened once per process; each instance only
+    /// creates a hash object on it.
+    class Sha256 final
+    {
+        PNQ_DECLARE_NON_COPYABLE(Sha256)
+
+    public:
+        Sha256();
+        ~Sha256();
+
+        /// Add data to the hash.
+        /// @return false if hashing failed (all further calls fail too)
+        bool update(const void *data, size_t size);
+
+        /// Finish and return the digest.
+        /// @return Lowercase hex digest, or empty on failure
+        std::string finish();
+
+        /// Hash a buffer in one call.
+        /// @return Lowercase hex digest, or empty on failure
+        static std::string of_buffer(const void *data, size_t size);
+
+        /// Hash a file on disk, streaming it in blocks.
+        /// @param[out] size Number of bytes hashed (optional)
+        /// @return Lowercase hex digest, or empty on failure
+        static std::string of_file(const std::filesystem::path &path, uint64_t *size = nullptr);
+
+    private:
+        void *m_hash = nullptr;   ///< BCRYPT_HASH_HANDLE
+        bool m_ok = false;        ///< False once any call failed
+    };
+
+} // namespace insti
@@ -0,0 +1,70 @@
+#pragma once
+
+// =============================================================================
+// insti/core/thread_pool.h - Fixed-size worker pool for CPU/IO-bound fan-out
+// =============================================================================
+
+#include <pnq/pnq.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace insti
+{
+
+    /// Fixed-size pool of worker threads executing submitted tasks in FIFO order.
+    ///
+    /// Used by the snapshot engine to parallelize per-file work (compression,
+    /// extraction, deletion). Tasks must not call back into IActionCallback -
+    /// callbacks are only ever invoked from the thread that owns the operation.
+    class ThreadPool final
+    {
+        PNQ_DECLARE_NON_COPYABLE(ThreadPool)
+
+    public:
+        /// @param thread_count Number of workers (0 = one per hardware thread)
+        explicit ThreadPool(unsigned thread_count = 0);
+
+        /// Waits for queued tasks to finish, then joins all workers.
+        ~ThreadPool();
+
+        /// Queue a task for execution.
+        /// @return Future receiving the task result (or its exception)
+        template <typename F>
+        auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>>;
+            std::packaged_task<R()> task{std::forward<F>(fn)};
+            auto future = task.get_future();
+            enqueue([task = std::move(task)]() mutable { task(); });
+            return future;
+        }
+
+        /// Block until the queue is empty and no task is running.
+        void wait_idle();
+
+        /// Number of worker threads.
+        unsigned thread_count() const { return static_cast<unsigned>(m_threads.size()); }
+
+        /// Worker count used when 0 is requested (hardware concurrency, at least 1).
+        static unsigned default_thread_count();
+
+    private:
+        void enqueue(std::move_only_function<void()> task);
+        void worker_loop();
+
+        std::vector<std::thread> m_threads;
+        std::deque<std::move_only_function<void()>> m_queue;
+        std::mutex m_mutex;
+        std::condition_variable m_work_available;
+        std::condition_variable m_idle;
+        size_t m_active = 0;   ///< Tasks currently executing
+        bool m_stopping = false;
+    };
+
+} // namespace insti
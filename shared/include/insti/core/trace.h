@@ -0,0 +1,131 @@
+#pragma once
+
+// =============================================================================
+// insti/core/trace.h - Span tracing with Chrome/Perfetto trace export
+// =============================================================================
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace insti
+{
+
+    /// Collects timed spans of an operation and writes them as Chrome trace JSON
+    /// (chrome://tracing, ui.perfetto.dev).
+    ///
+    /// Disabled by default. While disabled a TraceSpan costs one relaxed atomic load
+    /// and copies nothing. While enabled each thread appends to its own buffer, so
+    /// tracing per-file work on thread pools does not serialize the workers.
+    ///
+    /// Spans nest by time on their thread: a span started and finished inside
+    /// another one is shown below it.
+    class Tracer final
+    {
+    public:
+        /// The process-wide tracer.
+        static Tracer& instance();
+
+        /// True while spans are recorded.
+        static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+        /// Discard earlier spans and start recording.
+        void start();
+
+        /// Stop recording and write the spans to path.
+        /// @return false if the file could not be written (logged)
+        bool stop(std::string_view path);
+
+        /// Record a finished span (used by TraceSpan).
+        void record(const char* category, const char* name, std::string detail,
+                    std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+    private:
+        Tracer() = default;
+
+        struct Event
+        {
+            const char* category;
+            const char* name;
+            std::string detail;
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::time_point end;
+        };
+
+        /// Events of one thread. The lock is only contended while stop() reads.
+        struct ThreadBuffer
+        {
+            uint32_t tid;
+            std::mutex mutex;
+            std::vector<Event> events;
+        };
+
+        ThreadBuffer& thread_buffer();
+
+        static inline std::atomic<bool> s_enabled{false};
+
+        std::mutex m_mutex;                                   ///< Guards m_buffers
+        std::vector<std::unique_ptr<ThreadBuffer>> m_buffers; ///< Never freed: threads cache theirs
+        std::chrono::steady_clock::time_point m_epoch;        ///< Set by start(), timestamps are relative to it
+    };
+
+    /// Scoped span: records the time from construction to destruction if tracing
+    /// was enabled at construction.
+    ///
+    /// @code
+    /// TraceSpan span{"action", "backup", action->description()};
+    /// @endcode
+    class TraceSpan final
+    {
+    public:
+        /// @param category Group shown by the viewer, e.g. "phase", "hook", "action", "file"
+        /// @param name Span name (category and name are kept by pointer: use literals)
+        /// @param detail Copied only when tracing is enabled (file path, action description)
+        TraceSpan(const char* category, const char* name, std::string_view detail = {})
+        {
+            if (Tracer::enabled())
+            {
+                m_category = category;
+                m_name = name;
+                m_detail.assign(detail);
+                m_start = std::chrono::steady_clock::now();
+            }
+        }
+
+        /// Same, for a path: converted to a string only when tracing is enabled.
+        template <std::same_as<std::filesystem::path> Path>
+        TraceSpan(const char* category, const char* name, const Path& path)
+            : TraceSpan{category, name}
+        {
+            if (m_category)
+                m_detail = path.string();
+        }
+
+        ~TraceSpan()
+        {
+            if (m_category)
+                Tracer::instance().record(m_category, m_name, std::move(m_detail), m_start, std::chrono::steady_clock::now());
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+    private:
+        const char* m_category = nullptr;  ///< nullptr: not recording
+        const char* m_name = nullptr;
+        std::string m_detail;
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+} // namespace insti
@@ -5,6 +5,7 @@
 // =============================================================================
 
 #include "hook.h"
+#include <insti/core/multi_pattern.h>
 #include <insti/core/phase.h>
 #include <string>
 #include <pnq/pnq.h>
@@ -18,7 +19,11 @@ namespace insti
 /// - Backup: Replace known values with ${VARNAME} placeholders
 /// - Restore: Replace ${VARNAME} placeholders with resolved values
 ///
-/// File pattern supports glob syntax and variable substitution.
+/// File pattern supports glob syntax (see GlobPattern, including ** and wildcards
+/// in directory names) and variable substitution.
+///
+/// Files are streamed in fixed-size chunks and replaced atomically, so large files
+/// don't need to fit in memory; matched files are processed in parallel.
 class SubstituteHook : public IHook
 {
     PNQ_DECLARE_NON_COPYABLE(SubstituteHook)
@@ -44,11 +49,9 @@ public:
 private:
     bool execute(const std::unordered_map<std::string, std::string>& variables) const override;
 
-    bool substitute_to_placeholders(const std::string& file_path,
-                                    const std::unordered_map<std::string, std::string>& variables) const;
-
-    bool substitute_from_placeholders(const std::string& file_path,
-                                      const std::unordered_map<std::string, std::string>& variables) const;
+    /// Rewrite one file through the replacer (streamed, swapped in atomically).
+    /// Thread-safe: execute() runs it for several files concurrently.
+    bool substitute(const std::string& file_path, const MultiPatternReplacer& replacer) const;
 
     std::vector<std::string> expand_glob(const std::string& resolved_pattern) const;
 
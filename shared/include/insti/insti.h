@@ -39,7 +39,19 @@
 //     blueprint.h        - Blueprint class
 //     orchestrator.h     - Backup/restore/clean orchestration
 //     action_context.h   - Runtime context for actions
+//     action_scheduler.h - Concurrent execution of independent actions
 //     action_callback.h  - Progress callback interface
+//     progress_tracker.h - Byte-weighted operation progress with ETA
+//     trace.h            - Span tracing with Chrome trace export
+//     thread_pool.h      - Worker pool for parallel per-file work
+//     file_io.h          - Whole-file I/O backends (blocking, queued)
+//     file_time.h        - File timestamps to and from time_t
+//     directory_scanner.h - Parallel directory tree enumeration
+//     background_deleter.h - Rename-then-delete removal of directory trees
+//     glob.h             - Compiled glob patterns for include/exclude filters
+//     multi_pattern.h    - Single-pass multi-pattern replacement (unresolve)
+//     sha256.h           - SHA-256 content hashing
+//     benchmark.h        - Synthetic data generators and timing harnesses
 //   actions/
 //     action.h           - IAction abstract base class
 //     copy_file.h        - Single file backup/restore
@@ -58,13 +70,21 @@
 //     substitute.h       - Variable substitution in files
 //     sql.h              - SQLite query execution
 //   snapshot/
+//     blob_store.h       - Content-addressed blob store
+//     compression_policy.h - Deflate or store decision per entry
 //     entry.h            - Archive entry metadata
+//     manifest.h         - Per-file content hash manifest
+//     path_index.h       - Interned directory tree of archive paths
 //     reader.h           - SnapshotReader ABC
+//     store_reader.h     - Deduplicating store implementation of reader
+//     store_writer.h     - Deduplicating store implementation of writer
+//     synchronized_writer.h - Thread-safe wrapper around a writer
 //     writer.h           - SnapshotWriter ABC
 //     zip_reader.h       - Zip implementation of reader
 //     zip_writer.h       - Zip implementation of writer
 //   registry/
 //     registry.h         - SnapshotRegistry discovery
+//     root_index.h       - Per-root snapshot index sidecar
 //     settings.h         - Registry configuration
 //     entry.h            - SnapshotEntry metadata
 //
@@ -88,6 +108,7 @@ namespace insti
 #include <insti/core/action_callback.h>
 #include <insti/core/action_context.h>
 #include <insti/core/orchestrator.h>
+#include <insti/core/trace.h>
 
 // Actions
 #include <insti/actions/action.h>
@@ -109,9 +130,16 @@ namespace insti
 #include <insti/hooks/sql.h>
 
 // Snapshot
+#include <insti/snapshot/compression_policy.h>
 #include <insti/snapshot/entry.h>
+#include <insti/snapshot/manifest.h>
+#include <insti/snapshot/path_index.h>
 #include <insti/snapshot/reader.h>
 #include <insti/snapshot/writer.h>
+#include <insti/snapshot/blob_store.h>
+#include <insti/snapshot/store_reader.h>
+#include <insti/snapshot/store_writer.h>
+#include <insti/snapshot/synchronized_writer.h>
 #include <insti/snapshot/zip_reader.h>
 #include <insti/snapshot/zip_writer.h>
 
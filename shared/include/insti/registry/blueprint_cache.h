@@ -8,6 +8,8 @@
 #include <string_view>
 #include <optional>
 #include <cstdint>
+#include <unordered_map>
+#include <vector>
 #include <insti/core/instance.h>
 #include <pnq/sqlite/database.h>
 
@@ -16,6 +18,10 @@ namespace insti
 
 	/// SQLite-backed cache for blueprint XML.
 	/// Caches serialized blueprint XML keyed by file path, with mtime/size for invalidation.
+	///
+	/// The database runs in WAL mode with a busy timeout, so the CLI and GUI can use it at
+	/// the same time. For registry scans, preload() reads all relevant rows in a few queries and
+	/// begin_batch()/commit_batch() collect writes into a single transaction.
 	class BlueprintCache
 	{
 	public:
@@ -59,6 +65,22 @@ namespace insti
 		/// @return Number of entries updated
 		int mark_all_instances_not_installed(std::string_view project_name);
 
+		/// Rows read by one preload() query.
+		static constexpr size_t PRELOAD_PAGE_SIZE = 1000;
+
+		/// Load all entries below path_prefix into memory, PRELOAD_PAGE_SIZE rows per query.
+		/// Until close(), get() answers from memory and put() keeps the copy current.
+		/// @param path_prefix Only load paths starting with this (empty = whole table)
+		/// @return Number of entries loaded
+		size_t preload(std::string_view path_prefix = {});
+
+		/// Start collecting put() calls instead of writing each one.
+		void begin_batch();
+
+		/// Write all collected put() calls in one transaction.
+		/// @return true on success (also if nothing was collected)
+		bool commit_batch();
+
 		/// Remove a cache entry.
 		/// @param path File path (will be lowercased)
 		void remove(std::string_view path);
@@ -66,14 +88,41 @@ namespace insti
 		/// Clear all cache entries.
 		void clear();
 
-		/// Get the default cache path (%LOCALAPPDATA%\insti\cache.db).
+		/// Get the default cache path (%LOCALAPPDATA%\insti\cache.db, unless redirected).
 		static std::string default_path();
 
+		/// Redirect default_path(), and so every open_default(), to another database.
+		/// Used by the benchmark so that it does not fill the user's cache.
+		/// @param path Database path, or empty for the default location
+		static void set_default_path(std::string path);
+
 	private:
+		/// Row of the blueprints table.
+		struct Entry
+		{
+			int64_t mtime = 0;
+			int64_t size = 0;
+			std::string xml;
+			std::string install_status;
+		};
+
+		/// Row queued by put() while batching.
+		struct PendingWrite
+		{
+			std::string path;
+			Entry entry;
+		};
+
 		void ensure_schema();
+		std::optional<Entry> lookup(const std::string& normalized);
 		static std::string normalize_path(std::string_view path);
 
 		pnq::sqlite::Database m_db;
+		bool m_preloaded = false;
+		std::string m_preload_prefix;  ///< Normalized prefix passed to preload()
+		std::unordered_map<std::string, Entry> m_entries;  ///< Rows loaded by preload(), keyed by normalized path
+		bool m_batching = false;
+		std::vector<PendingWrite> m_pending_writes;
 	};
 
 } // namespace insti
@@ -0,0 +1,74 @@
+#pragma once
+
+// =============================================================================
+// insti/registry/root_index.h - Per-root index of snapshot blueprints
+// =============================================================================
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace insti
+{
+
+	/// Index file at the top of a registry root, listing the serialized instance
+	/// blueprint of every snapshot below it.
+	///
+	/// Without it, a registry scan on a machine with an empty BlueprintCache has to open
+	/// every archive to read its blueprint.xml, which on a network share means one zip
+	/// open per snapshot. With it, the scan reads one file per root and opens only the
+	/// archives whose size or mtime no longer match their entry.
+	///
+	/// The index is a hint, never the source of truth: entries are validated against the
+	/// directory listing, and scans repair entries that are missing or stale. Updates are
+	/// read-merge-write cycles under an exclusive lock file, and the new index replaces the
+	/// old one by rename, so readers see either version in full and concurrent writers
+	/// (backups on several machines) do not lose each other's entries.
+	class RootIndex final
+	{
+	public:
+		/// Index file name, directly below the root.
+		static constexpr std::string_view FILE_NAME = ".insti-index";
+
+		/// How long update() waits for another writer to release the lock.
+		static constexpr std::chrono::milliseconds LOCK_TIMEOUT{ 5000 };
+
+		struct Entry
+		{
+			std::string path;     ///< Relative to the root, '/' separated
+			int64_t mtime = 0;    ///< Archive last write time as time_t
+			int64_t size = 0;     ///< Archive size in bytes
+			std::string project;  ///< Project name (informational)
+			std::string xml;      ///< Instance::to_xml() of the archive's blueprint
+		};
+
+		/// Entries keyed by key(path).
+		using Entries = std::unordered_map<std::string, Entry>;
+
+		/// Lookup key for a relative path (paths are case-insensitive on Windows).
+		static std::string key(std::string_view rel_path);
+
+		/// Path of file relative to root in index form, or nullopt if it is not below root.
+		static std::optional<std::string> relative_path(const std::filesystem::path& root, const std::filesystem::path& file);
+
+		/// Read the index of a root.
+		/// @return entries, empty if the root has no (readable) index
+		static Entries load(const std::filesystem::path& root);
+
+		/// Add or replace entries and drop entries of deleted archives.
+		/// Best effort: a root without write access simply keeps no index.
+		/// @param upserts Entries to add or replace
+		/// @param removals Relative paths to drop, if the archive no longer exists
+		/// @param cancel Once set, waits for the lock or the replace give up (may be nullptr)
+		/// @return true if the index was written
+		static bool update(const std::filesystem::path& root, const std::vector<Entry>& upserts,
+			const std::vector<std::string>& removals = {}, const std::atomic<bool>* cancel = nullptr);
+	};
+
+} // namespace insti
@@ -3,6 +3,10 @@
 #include <insti/registry/blueprint_cache.h>
 #include <insti/core/project.h>
 #include <insti/core/instance.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -22,8 +26,33 @@ namespace insti
 		{
 		}
 
-		bool initialize();
+		/// Cancels root loaders that are still running and hands them to a background
+		/// reaper, which joins them and releases what they loaded; never waits for a root.
+		~SnapshotRegistry() override;
 
+		/// How long initialize() waits for a single root before moving on.
+		static constexpr std::chrono::milliseconds DEFAULT_ROOT_BUDGET{ 3000 };
+
+		/// Budget for initialize() that waits for every root. Anything that resolves
+		/// snapshots by position (1/2/3, A/B/C) must use it, or the numbering would
+		/// depend on which shares answered in time.
+		static constexpr std::chrono::milliseconds WAIT_FOR_ALL = std::chrono::milliseconds::max();
+
+		/// Discover project and instance blueprints below all roots.
+		/// Roots are scanned concurrently and their blueprints loaded on a thread pool.
+		/// Archives missing from the local cache are taken from the root's RootIndex where
+		/// possible; archives have to be opened only if neither knows them.
+		/// A root that does not finish within root_budget (a slow or unreachable share)
+		/// keeps loading in the background; see publish_pending().
+		bool initialize(std::chrono::milliseconds root_budget = DEFAULT_ROOT_BUDGET);
+
+		/// Merge blueprints from roots that missed their budget and have finished since.
+		/// Must be called from the thread that owns the registry (e.g. once per UI frame).
+		/// @return true if m_instances/m_projects changed
+		bool publish_pending();
+
+		/// Roots still loading in the background.
+		std::vector<std::string> pending_roots() const;
 
 		/// Generate a filename from entry data using the configured pattern.
 		std::string generate_filename(std::string_view project,
@@ -80,7 +109,36 @@ namespace insti
 		}
 
 
+		/// Blueprints found below one root (one reference held per entry).
+		struct RootContents
+		{
+			std::vector<Project*> projects;
+			std::vector<Instance*> instances;
+		};
+
+		/// Root that missed its budget in initialize().
+		struct PendingRoot
+		{
+			std::string root;
+			std::future<RootContents> contents;
+		};
+
+		/// Scan a root and load its blueprints (runs on a background thread, touches no members).
+		/// @param cancel Once set, loading stops and nothing is returned
+		static RootContents load_root(const std::string& root, const std::atomic<bool>& cancel);
+
+		/// Move loaded blueprints into m_projects/m_instances.
+		void merge(RootContents& contents);
+
+		/// Sort m_projects/m_instances by name.
+		void sort_blueprints();
+
 		const std::vector<std::string> m_roots;
+		std::vector<PendingRoot> m_pending;  ///< Roots still loading after initialize() returned
+		std::vector<std::thread> m_loaders;  ///< One per root and initialize() call, reaped on destruction
+
+		/// Set on destruction to stop m_loaders; shared with them, as they may outlive the registry.
+		const std::shared_ptr<std::atomic<bool>> m_cancel = std::make_shared<std::atomic<bool>>(false);
 
 		mutable BlueprintCache m_cache;  ///< Cache for parsed blueprints (mutable for const methods)
 		mutable std::string m_cached_installed_path;  ///< Cached path of installed blueprint.xml (empty if none/unknown)
@@ -93,8 +151,10 @@ namespace insti
 		void invalidate_installation_cache() const;
 
 
-		bool initialize_project_blueprint(const fs::directory_entry& dir_entry) const;
 		bool initialize_instance_blueprint(const fs::directory_entry& dir_entry, InstallStatus default_status) const;
+
+		/// Add or refresh the entry of a new snapshot in the index of the root that holds it.
+		void update_root_index(const fs::directory_entry& dir_entry);
 	};
 
 } // namespace insti
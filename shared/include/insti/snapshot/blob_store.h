@@ -0,0 +1,97 @@
+#pragma once
+
+#include "manifest.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace insti
+{
+
+/// Content-addressed blob store on disk.
+///
+/// Each distinct file content is stored exactly once, zlib-compressed, under
+/// `<root>/<first two hex digits>/<sha256>`. Blobs are immutable: writers
+/// compress to a temporary file and rename it into place, so concurrent
+/// backups into the same store never see partial blobs.
+class BlobStore final
+{
+public:
+    /// Length of a blob hash in hex characters (SHA-256).
+    static constexpr size_t HASH_LENGTH = 64;
+
+    /// Store directory kept next to the manifests that reference it.
+    static constexpr std::string_view DIRECTORY_NAME = ".blobs";
+
+    /// Extension of store snapshot manifests.
+    static constexpr std::string_view MANIFEST_EXTENSION = ".manifest";
+
+    /// @param root Store directory (created on first write)
+    explicit BlobStore(std::filesystem::path root, int compression_level = 1)
+        : m_root{std::move(root)}, m_compression_level{compression_level}
+    {
+    }
+
+    const std::filesystem::path& root() const { return m_root; }
+
+    /// Store used by a manifest: DIRECTORY_NAME in the manifest's directory.
+    static std::filesystem::path root_for_manifest(const std::filesystem::path& manifest)
+    {
+        return manifest.parent_path() / DIRECTORY_NAME;
+    }
+
+    /// Write a manifest file (temp file + rename).
+    static bool save_manifest(const std::filesystem::path& path, const SnapshotManifest& manifest);
+
+    /// Read a manifest file.
+    static bool load_manifest(const std::filesystem::path& path, SnapshotManifest& manifest);
+
+    /// Path of the blob for a hash (whether or not it exists).
+    std::filesystem::path blob_path(std::string_view hash) const;
+
+    /// Check if a blob is present.
+    bool contains(std::string_view hash) const;
+
+    /// Store a file, skipping the write if identical content is already present.
+    /// The blob is named by the hash of the bytes actually stored, so a file that
+    /// changes while it is being stored yields the hash of the stored version.
+    /// @param[out] hash Content hash to record in the manifest
+    /// @param[out] size Uncompressed size
+    /// @param[out] deduplicated Set if the content was already present (optional)
+    bool put_file(const std::filesystem::path& src, std::string& hash, uint64_t& size, bool* deduplicated = nullptr);
+
+    /// Store a buffer, skipping the write if identical content is already present.
+    /// @param[out] hash Content hash to record in the manifest
+    bool put_buffer(const std::vector<uint8_t>& data, std::string& hash);
+
+    /// Decompress a blob into memory (streamed, see stream()).
+    /// @param size Expected uncompressed size (from the manifest)
+    /// @return Content, or empty on failure
+    std::vector<uint8_t> read(std::string_view hash, uint64_t size) const;
+
+    /// Decompress a blob block by block.
+    /// @param size Expected uncompressed size (from the manifest)
+    /// @param sink Receives consecutive blocks; return false to stop early
+    /// @return true if the whole blob was delivered
+    bool stream(std::string_view hash, uint64_t size,
+                const std::function<bool(const uint8_t*, size_t)>& sink) const;
+
+    /// Decompress a blob to a file on disk.
+    /// @param size Expected uncompressed size (from the manifest)
+    bool extract(std::string_view hash, uint64_t size, const std::filesystem::path& dest) const;
+
+private:
+    /// Compress a source (file or buffer) into a temp file, hashing the bytes as they
+    /// are compressed, and rename it to the blob of that hash.
+    /// @param[out] hash Hash of the stored content
+    /// @param[out] size Uncompressed size of the stored content
+    bool write_blob(const std::filesystem::path* src, const std::vector<uint8_t>* data, std::string& hash, uint64_t& size);
+
+    std::filesystem::path m_root;   ///< Store directory
+    int m_compression_level;        ///< zlib level for new blobs
+};
+
+} // namespace insti
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace insti
+{
+
+/// Decides per entry whether deflating it is worth the CPU.
+///
+/// Most bytes in application snapshots are already compressed (archives, images,
+/// media, installer cabinets); deflate spends full effort on them for no gain.
+/// Such entries are recognized by extension, by their leading signature, or by
+/// the byte entropy of their first block, and stored instead. Restoring a
+/// stored entry is a plain copy.
+class CompressionPolicy final
+{
+public:
+    /// Why an entry was (or was not) stored.
+    enum class Reason : uint8_t
+    {
+        Compressible,  ///< Deflated
+        Extension,     ///< Stored: file type known to be compressed (.zip, .png, ...)
+        Signature,     ///< Stored: content starts with a compressed format's magic number
+        Entropy,       ///< Stored: first block looks random
+        Ineffective,   ///< Stored: deflate was tried and did not shrink the data
+        Count
+    };
+
+    /// Bytes examined at the start of an entry.
+    static constexpr size_t SAMPLE_SIZE = 64 * 1024;
+
+    /// Samples below this size are deflated without looking: the entropy estimate
+    /// is unreliable on few bytes and deflating them is cheap anyway.
+    static constexpr size_t MIN_ENTROPY_SAMPLE = 4 * 1024;
+
+    /// Order-0 entropy (bits per byte) above which a sample counts as incompressible.
+    /// Deflated or encrypted data measures 7.9+ on 4 KiB or more; executables and
+    /// text stay well below 7.
+    static constexpr double STORE_ENTROPY = 7.8;
+
+    /// Classify an entry.
+    /// @param name Archive path (for the extension)
+    /// @param head First bytes of the content (up to SAMPLE_SIZE)
+    /// @return Compressible, Extension, Signature or Entropy
+    static Reason classify(std::string_view name, std::span<const uint8_t> head);
+
+    /// Order-0 entropy of data in bits per byte (0-8).
+    static double entropy(std::span<const uint8_t> data);
+
+    static std::string_view reason_name(Reason reason);
+};
+
+/// Per-backup counters of CompressionPolicy decisions.
+struct CompressionStats
+{
+    uint64_t deflated_entries = 0;
+    uint64_t deflated_bytes = 0;          ///< Uncompressed size of deflated entries
+    uint64_t deflated_stored_bytes = 0;   ///< Their size in the archive
+    uint64_t stored_entries = 0;
+    uint64_t stored_bytes = 0;
+    std::array<uint64_t, static_cast<size_t>(CompressionPolicy::Reason::Count)> entries_by_reason{};
+
+    /// Count one written entry.
+    void add(CompressionPolicy::Reason reason, uint64_t size, uint64_t compressed_size);
+};
+
+} // namespace insti
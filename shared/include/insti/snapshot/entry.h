@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 namespace insti
@@ -10,6 +12,11 @@ struct ArchiveEntry
 {
     std::string path;       ///< Path within archive (using / separator)
     bool is_directory;      ///< True if this is a directory entry
+    uint64_t size = 0;      ///< Uncompressed size in bytes (0 for directories)
+    int64_t mtime = 0;      ///< Modification time as time_t (0 = unknown)
+    std::optional<uint32_t> crc32;  ///< CRC32 of the content, if the format stores one
+    uint64_t compressed_size = 0;   ///< Stored size in bytes (equals size if stored uncompressed or unknown)
+    std::optional<uint64_t> offset; ///< Position within the container (zip: local header offset), for read-order sorting
 };
 
 } // namespace insti
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace insti
+{
+
+/// One entry of a snapshot manifest.
+struct ManifestEntry
+{
+    std::string path;      ///< Path within the snapshot (using / separator)
+    std::string hash;      ///< SHA-256 of the content, lowercase hex (empty for directories)
+    uint64_t size = 0;     ///< Uncompressed size in bytes
+    int64_t mtime = 0;     ///< Source modification time as time_t (0 = unknown)
+
+    bool is_directory() const { return hash.empty(); }
+};
+
+/// Per-entry content hashes of a snapshot.
+///
+/// Zip snapshots carry one as FILE_NAME next to blueprint.xml so files can be
+/// verified against disk without decompressing anything; store snapshots
+/// consist of nothing but a manifest plus blobs.
+///
+/// Text format, one entry per line after the header (tab-separated; Windows
+/// paths cannot contain tabs or newlines):
+///   D <path>
+///   F <hash> <size> <mtime> <path>
+class SnapshotManifest final
+{
+public:
+    /// Entry name of the manifest inside zip snapshots.
+    static constexpr std::string_view FILE_NAME = "manifest.txt";
+
+    /// First line of every manifest (format version).
+    static constexpr std::string_view HEADER = "insti-manifest 1";
+
+    /// Add an entry (replaces an earlier entry with the same path).
+    void add(ManifestEntry entry);
+
+    /// Entry for a path, or nullptr if not present.
+    const ManifestEntry* find(std::string_view path) const;
+
+    /// Entries in insertion order.
+    const std::vector<ManifestEntry>& entries() const { return m_entries; }
+
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+    void clear();
+
+    /// Serialize to the text format.
+    std::string to_string() const;
+
+    /// Parse the text format, replacing current entries.
+    /// @return false if the header or any line is malformed
+    bool parse(std::string_view text);
+
+private:
+    std::vector<ManifestEntry> m_entries;                 ///< Entries in insertion order
+    std::unordered_map<std::string, size_t> m_index;      ///< Path -> index into m_entries
+};
+
+} // namespace insti
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "entry.h"
+
+namespace insti
+{
+
+/// Directory tree of all paths in a snapshot, built once per reader.
+///
+/// Path components are interned (each distinct name is stored once) and nodes are
+/// kept in depth-first order with children sorted by name, so every subtree is a
+/// contiguous range of node ids. That makes:
+///   - find() one hash lookup per path component, without allocating,
+///   - a subtree query O(depth + k),
+///   - a directory listing O(children).
+///
+/// Directories that only exist as parents of other entries (zips need not store
+/// them) are part of the tree and flagged as not being archive entries.
+class PathIndex final
+{
+public:
+    using NodeId = uint32_t;
+
+    /// The archive root (always a directory).
+    static constexpr NodeId ROOT = 0;
+
+    /// entry_index() of nodes that are not archive entries themselves.
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    PathIndex();
+
+    /// Build the tree from archive entries ('/' separated paths).
+    void build(const std::vector<ArchiveEntry>& entries);
+
+    /// Look up a path (a trailing '/' is ignored, "" is the root).
+    std::optional<NodeId> find(std::string_view path) const;
+
+    bool is_directory(NodeId id) const { return m_nodes[id].is_directory; }
+
+    /// True if the archive lists the path itself (as opposed to a synthetic parent).
+    bool is_archive_entry(NodeId id) const { return m_nodes[id].entry != NO_ENTRY; }
+
+    /// Index into the entries passed to build(), or NO_ENTRY for synthetic parents.
+    uint32_t entry_index(NodeId id) const { return m_nodes[id].entry; }
+
+    /// Last path component ("" for the root).
+    std::string_view name(NodeId id) const { return m_names[m_nodes[id].name]; }
+
+    /// Full path without trailing '/'.
+    std::string path(NodeId id) const;
+
+    /// Names of the immediate children, in sorted order.
+    std::vector<std::string> children(NodeId id) const;
+
+    /// Visit every node below id (not id itself) in depth-first, sorted order.
+    /// @param fn Receives the node and its path relative to id (no trailing '/')
+    void for_each_below(NodeId id, const std::function<void(NodeId, std::string_view rel_path)>& fn) const;
+
+    /// Number of nodes including the root and synthetic directories.
+    size_t size() const { return m_nodes.size(); }
+
+private:
+    struct Node
+    {
+        NodeId parent = ROOT;
+        uint32_t name = 0;         ///< Index into m_names
+        NodeId subtree_end = 0;    ///< One past the last node of this subtree
+        uint32_t entry = NO_ENTRY; ///< Index of the archive entry
+        bool is_directory = false;
+    };
+
+    static uint64_t child_key(NodeId parent, uint32_t name)
+    {
+        return (static_cast<uint64_t>(parent) << 32) | name;
+    }
+
+    /// Intern a component; returns its index into m_names.
+    uint32_t intern(std::string_view name);
+
+    std::deque<std::string> m_names;                              ///< Interned components (stable addresses)
+    std::unordered_map<std::string_view, uint32_t> m_name_ids;    ///< Component -> index into m_names
+    std::vector<Node> m_nodes;                                    ///< Depth-first order, ROOT first
+    std::unordered_map<uint64_t, NodeId> m_child_ids;             ///< child_key(parent, name) -> node
+};
+
+} // namespace insti
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <functional>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
-#include <unordered_set>
-#include <unordered_map>
 #include <pnq/ref_counted.h>
 #include "entry.h"
+#include "manifest.h"
+#include "path_index.h"
 
 namespace insti
 {
@@ -38,6 +41,48 @@ public:
     /// Check if snapshot is open.
     virtual bool is_open() const = 0;
 
+    // --- Optional (implementations may override) ---
+
+    /// Open an independent reader on the same snapshot.
+    /// Readers are not thread-safe; parallel consumers use one clone per thread.
+    /// @return New reader (caller owns ref), or nullptr if not supported
+    virtual SnapshotReader* open_clone() const { return nullptr; }
+
+    /// Get all entries with their metadata, in archive order.
+    /// Default implementation calls stat() for every path from get_all_paths();
+    /// implementations with a central directory override it with a single pass.
+    virtual std::vector<ArchiveEntry> get_all_entries() const;
+
+    /// Get size and modification time of a single entry.
+    /// @param path Path within archive (using / separator)
+    /// @return Entry info, or nullopt if not found or not supported
+    virtual std::optional<ArchiveEntry> stat(std::string_view path) const { return std::nullopt; }
+
+    /// Stream file content in blocks without holding the whole file in memory.
+    /// Default implementation reads the entry with read_binary() and delivers it as one block.
+    /// @param path Path within archive (using / separator)
+    /// @param sink Receives consecutive blocks; return false to stop early
+    /// @return true if the whole entry was delivered, false on error or if sink stopped
+    virtual bool read_stream(std::string_view path,
+                             const std::function<bool(const uint8_t*, size_t)>& sink) const;
+
+    /// Zero-copy access to an entry's stored bytes.
+    /// @param path Path within archive (using / separator)
+    /// @return View valid until the reader is closed, or nullopt if the entry cannot be
+    ///         viewed in place (not found, compressed, or not supported)
+    virtual std::optional<std::span<const uint8_t>> view(std::string_view path) const { return std::nullopt; }
+
+    /// Read file content into a caller-provided buffer.
+    /// Default implementation copies from read_binary().
+    /// @param path Path within archive (using / separator)
+    /// @param dest Buffer of exactly the entry's uncompressed size (see stat())
+    /// @return false if not found, on error, or if the size does not match
+    virtual bool read_into(std::string_view path, std::span<uint8_t> dest) const;
+
+    /// Per-file content hashes recorded at backup time.
+    /// @return Manifest, or nullptr if the snapshot has none (older snapshots)
+    virtual const SnapshotManifest* manifest() const { return nullptr; }
+
     // --- ABC provides (built on cached path tree) ---
 
     /// Extract a directory tree from archive to disk.
@@ -53,11 +98,27 @@ public:
     /// @param path Path within archive (using / separator)
     bool is_directory(std::string_view path) const;
 
+    /// Metadata of a single entry, from the table loaded once per reader (no I/O).
+    /// @param path Path within archive (using / separator, trailing '/' optional)
+    /// @return Entry, or nullptr if not found or only implied by other entries' paths
+    const ArchiveEntry* find_entry(std::string_view path) const;
+
+    /// Metadata of all entries, in archive order.
+    const std::vector<ArchiveEntry>& all_entries() const;
+
     /// List immediate children of a directory.
     /// @param path Directory path within archive (using / separator)
     std::vector<std::string> list_dir(std::string_view path) const;
 
+    /// Visit the archive entries below a directory in sorted order.
+    /// Costs O(depth + k) for k entries below the directory, independent of archive size.
+    /// @param dir Directory path within archive (trailing '/' optional, "" for all entries)
+    /// @param fn Receives the path relative to dir (no trailing '/') and the entry's metadata
+    void for_each_entry_below(std::string_view dir,
+                              const std::function<void(std::string_view rel_path, const ArchiveEntry& entry)>& fn) const;
+
     /// Read file content as text.
+    /// Uses view() or read_into() when available, so the content is copied at most once.
     /// @param path Path within archive (using / separator)
     std::string read_text(std::string_view path) const;
 
@@ -92,15 +153,20 @@ public:
     size_t size() const;
 
 protected:
-    /// Build path tree from get_all_paths() - call once after open.
+    /// Build path tree from get_all_entries() - call once after open.
     void build_path_cache() const;
 
+    /// Convert raw file content to UTF-8 text, honouring a UTF-8 or UTF-16LE BOM.
+    static std::string decode_text(const uint8_t* data, size_t size);
+
+    /// Set permissive ACL on an extracted file (Everyone: Full Control),
+    /// so non-admin users can access restored files.
+    static bool set_permissive_acl(const std::wstring& path);
+
 private:
-    mutable bool m_cache_built = false;                                         ///< Whether cache has been built
-    mutable std::unordered_set<std::string> m_all_paths;                        ///< All paths in archive
-    mutable std::unordered_set<std::string> m_directories;                      ///< Directory paths only
-    mutable std::unordered_map<std::string, std::vector<std::string>> m_children; ///< Parent -> children map
-    mutable std::vector<std::string> m_ordered_paths;                           ///< Paths in iteration order
+    mutable bool m_cache_built = false;                 ///< Whether cache has been built
+    mutable PathIndex m_index;                          ///< Directory tree of all paths
+    mutable std::vector<ArchiveEntry> m_entries;        ///< Entry metadata in iteration order
 };
 
 } // namespace insti
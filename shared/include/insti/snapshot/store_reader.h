@@ -0,0 +1,49 @@
+#pragma once
+
+#include "reader.h"
+#include "blob_store.h"
+#include <pnq/pnq.h>
+#include <memory>
+
+namespace insti
+{
+
+/// Deduplicating implementation of SnapshotReader (see StoreSnapshotWriter).
+class StoreSnapshotReader final : public SnapshotReader
+{
+    PNQ_DECLARE_NON_COPYABLE(StoreSnapshotReader)
+
+public:
+    StoreSnapshotReader();
+    ~StoreSnapshotReader() override;
+
+    /// Open a snapshot manifest for reading.
+    /// @param path Manifest path on disk
+    /// @param store_root Blob store directory (empty = BlobStore::root_for_manifest(path))
+    bool open(std::string_view path, std::string_view store_root = {});
+
+    /// Manifest entry for a path, or nullptr if not present.
+    const ManifestEntry* find(std::string_view path) const { return m_manifest.find(path); }
+
+    // SnapshotReader implementation
+    std::vector<std::string> get_all_paths() const override;
+    std::vector<ArchiveEntry> get_all_entries() const override;
+    std::vector<uint8_t> read_binary(std::string_view path) const override;
+    bool read_into(std::string_view path, std::span<uint8_t> dest) const override;
+    bool extract_to_file(std::string_view archive_path, std::string_view dest_path) const override;
+    void close() override;
+    bool is_open() const override { return m_open; }
+    SnapshotReader* open_clone() const override;
+    const SnapshotManifest* manifest() const override { return m_open ? &m_manifest : nullptr; }
+    std::optional<ArchiveEntry> stat(std::string_view path) const override;
+    bool read_stream(std::string_view path,
+                     const std::function<bool(const uint8_t*, size_t)>& sink) const override;
+
+private:
+    bool m_open;                                            ///< Whether a manifest is loaded
+    std::string m_path;                                     ///< Manifest path on disk
+    std::unique_ptr<BlobStore> m_store;                     ///< Blob store (null when closed)
+    SnapshotManifest m_manifest;                            ///< Entries in file order
+};
+
+} // namespace insti
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "writer.h"
+#include "blob_store.h"
+#include <pnq/pnq.h>
+#include <memory>
+
+namespace insti
+{
+
+/// Deduplicating implementation of SnapshotWriter.
+///
+/// A snapshot is a manifest file listing every entry with the hash of its
+/// content; the content itself lives in a BlobStore shared by all manifests
+/// in the same directory. Files already present in the store (from earlier
+/// snapshots of the same project) are hashed but never written again.
+class StoreSnapshotWriter final : public SnapshotWriter
+{
+    PNQ_DECLARE_NON_COPYABLE(StoreSnapshotWriter)
+
+public:
+    StoreSnapshotWriter();
+    ~StoreSnapshotWriter() override;
+
+    /// Start a new snapshot.
+    /// @param path Manifest path on disk (written by finalize())
+    /// @param store_root Blob store directory (empty = BlobStore::root_for_manifest(path))
+    bool create(std::string_view path, std::string_view store_root = {});
+
+    /// Set zlib level (0-9) for new blobs. Must be called before create().
+    void set_compression_level(int level) { m_compression_level = level; }
+
+    /// Number of entries whose content was already in the store.
+    size_t deduplicated_count() const { return m_deduplicated; }
+
+    // SnapshotWriter implementation
+    bool create_directory(std::string_view path) override;
+    bool write_binary(std::string_view path, const std::vector<uint8_t>& data) override;
+    bool write_file(std::string_view archive_path, std::string_view src_path) override;
+    bool copy_entry(const SnapshotReader& source, std::string_view path) override;
+    bool finalize() override;
+    void close() override;
+    bool is_open() const override { return m_open; }
+
+private:
+    /// Normalize path separators to forward slashes.
+    std::string normalize_path(std::string_view path) const;
+
+    bool m_open;                              ///< Whether a snapshot is being written
+    std::string m_path;                       ///< Manifest path on disk
+    int m_compression_level;                  ///< zlib level for new blobs
+    std::unique_ptr<BlobStore> m_store;       ///< Blob store (null when closed)
+    SnapshotManifest m_manifest;              ///< Manifest entries in write order
+    size_t m_deduplicated;                    ///< Entries that reused an existing blob
+};
+
+} // namespace insti
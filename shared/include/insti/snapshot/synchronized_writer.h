@@ -0,0 +1,43 @@
+#pragma once
+
+#include "writer.h"
+#include <pnq/pnq.h>
+#include <mutex>
+
+namespace insti
+{
+
+/// Serializes access to another writer, so several threads can write one snapshot.
+///
+/// Files and buffers are read and compressed outside the lock if the target supports
+/// prepare(), so only the append is serialized; other calls (and files too large to
+/// buffer) hold the lock for their whole duration. Entries of concurrent callers
+/// interleave in the archive, entries of one caller keep their order. Used when the
+/// ActionScheduler runs backups of independent actions at the same time.
+class SynchronizedSnapshotWriter final : public SnapshotWriter
+{
+    PNQ_DECLARE_NON_COPYABLE(SynchronizedSnapshotWriter)
+
+public:
+    /// Largest file read into memory to be compressed outside the lock.
+    static constexpr uint64_t MAX_UNLOCKED_FILE_SIZE = 64ull * 1024 * 1024;
+
+    /// @param target Writer to forward to (retained)
+    explicit SynchronizedSnapshotWriter(SnapshotWriter* target);
+    ~SynchronizedSnapshotWriter() override;
+
+    bool create_directory(std::string_view path) override;
+    bool write_binary(std::string_view path, const std::vector<uint8_t>& data) override;
+    bool write_file(std::string_view archive_path, std::string_view src_path) override;
+    bool write_buffer(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime) override;
+    bool finalize() override;
+    void close() override;
+    bool is_open() const override;
+    bool copy_entry(const SnapshotReader& source, std::string_view path) override;
+
+private:
+    SnapshotWriter* m_target;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace insti
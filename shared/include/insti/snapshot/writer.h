@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -8,6 +11,8 @@
 namespace insti
 {
 
+class SnapshotReader;
+
 /// Abstract base class for writing snapshots.
 /// @note Cannot be final - has virtual destructor for polymorphism.
 class SnapshotWriter : public pnq::RefCountImpl
@@ -40,6 +45,50 @@ public:
     /// Check if archive is open for writing.
     virtual bool is_open() const = 0;
 
+    // --- Optional (implementations may override) ---
+
+    /// Copy an entry from another snapshot as-is, without recompressing it.
+    /// The source must stay open until this writer is finalized or closed; writers that
+    /// append later hold a reference to it until then. Failures are reported here, not
+    /// deferred to finalize().
+    /// @param source Snapshot to copy from
+    /// @param path Path within both archives (using / separator)
+    /// @return false if the entry could not be copied or this source is not supported;
+    ///         callers then fall back to writing the content normally
+    virtual bool copy_entry(const SnapshotReader& source, std::string_view path) { return false; }
+
+    /// Entry compressed by prepare(), ready to be appended by write_prepared().
+    class PreparedEntry
+    {
+    public:
+        virtual ~PreparedEntry() = default;
+    };
+
+    /// Whether prepare() and write_prepared() are supported. Default: false.
+    virtual bool can_prepare() const { return false; }
+
+    /// Compress an entry without touching the archive. Thread-safe, so a caller that
+    /// serializes access to the writer (SynchronizedSnapshotWriter) can do the expensive
+    /// part outside its lock. Only called if can_prepare().
+    /// @param mtime Modification time as time_t (0 = now)
+    virtual std::unique_ptr<PreparedEntry> prepare(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime) const
+    {
+        return nullptr;
+    }
+
+    /// Append an entry returned by prepare() of this writer.
+    virtual bool write_prepared(std::unique_ptr<PreparedEntry> entry) { return false; }
+
+    /// Write a file's content that the caller has already read (see FileIo), keeping its
+    /// modification time. Default: write_binary(), which records the current time.
+    /// @param archive_path Path within archive (using / separator)
+    /// @param data File content
+    /// @param mtime Modification time as time_t (0 = now)
+    virtual bool write_buffer(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime)
+    {
+        return write_binary(archive_path, data);
+    }
+
     // --- ABC provides ---
 
     /// Write text content to archive (as UTF-8 bytes).
@@ -53,6 +102,18 @@ public:
     /// @param content UTF-8 text content (will be converted to UTF-16LE)
     bool write_utf16(std::string_view path, std::string_view content);
 
+    /// Copy an entry from another snapshot: raw via copy_entry() where supported,
+    /// otherwise by reading and rewriting its content.
+    /// @param source Snapshot to copy from (must stay open until finalize())
+    /// @param path Path within both archives (using / separator; directories end in /)
+    bool copy_from(const SnapshotReader& source, std::string_view path);
+
+    /// Copy all entries of another snapshot, in order.
+    /// @param source Snapshot to copy from (must stay open until finalize())
+    /// @param filter Returns false for paths to leave out (empty = copy everything)
+    bool copy_all_from(const SnapshotReader& source,
+                       const std::function<bool(std::string_view)>& filter = {});
+
     /// Add a directory recursively from disk.
     /// @param archive_prefix Prefix in archive (e.g. "files/myapp")
     /// @param src_dir Source directory on disk
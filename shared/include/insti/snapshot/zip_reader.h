@@ -2,11 +2,20 @@
 
 #include "reader.h"
 #include <pnq/pnq.h>
+#include <memory>
 
 namespace insti
 {
 
 /// Zip implementation of SnapshotReader using miniz.
+///
+/// In memory-mapped mode the archive is mapped read-only and miniz works on the
+/// mapping: the central directory is parsed without file I/O, stored entries are
+/// returned by view() as spans into the mapping, and deflated entries inflate
+/// directly from it into the caller's buffer. view() hands out stored bytes without
+/// checking their CRC. Only files on local fixed drives are mapped: a mapping of a
+/// file on a share that disappears faults on access, so other files are opened
+/// through file I/O even in memory-mapped mode.
 class ZipSnapshotReader final : public SnapshotReader
 {
     PNQ_DECLARE_NON_COPYABLE(ZipSnapshotReader)
@@ -16,19 +25,54 @@ public:
     ~ZipSnapshotReader() override;
 
     /// Open a zip file for reading.
+    /// The path cache is built on first use, so opening only to read blueprint.xml is cheap.
     /// @param path Path to the zip file on disk
     bool open(std::string_view path);
 
+    /// Map the archive into memory instead of reading it through file I/O, if it is
+    /// on a local fixed drive. Must be called before open(); clones inherit the
+    /// setting. Default is off.
+    void set_memory_mapped(bool enable) { m_memory_mapped = enable; }
+
     // SnapshotReader implementation
     std::vector<std::string> get_all_paths() const override;
+    std::vector<ArchiveEntry> get_all_entries() const override;
     std::vector<uint8_t> read_binary(std::string_view path) const override;
+    std::optional<std::span<const uint8_t>> view(std::string_view path) const override;
+    bool read_into(std::string_view path, std::span<uint8_t> dest) const override;
     bool extract_to_file(std::string_view archive_path, std::string_view dest_path) const override;
     void close() override;
     bool is_open() const override { return m_open; }
+    SnapshotReader* open_clone() const override;
+    std::optional<ArchiveEntry> stat(std::string_view path) const override;
+    bool read_stream(std::string_view path,
+                     const std::function<bool(const uint8_t*, size_t)>& sink) const override;
+    const SnapshotManifest* manifest() const override;
 
 private:
-    void* m_zip;  ///< miniz archive handle (mz_zip_archive*)
-    bool m_open;  ///< Whether archive is currently open
+    friend class ZipSnapshotWriter;  // Raw entry copy needs the miniz handle
+
+    /// Map m_path read-only into m_view.
+    bool map_file();
+
+    /// Release the mapping created by map_file().
+    void unmap_file();
+
+    /// Index of an entry, or -1 if not found.
+    int locate(std::string_view path) const;
+
+    void* m_zip;          ///< miniz archive handle (mz_zip_archive*)
+    bool m_open;          ///< Whether archive is currently open
+    std::string m_path;   ///< Path to the zip file on disk
+
+    bool m_memory_mapped = false;        ///< Open through a file mapping
+    void* m_file = nullptr;              ///< File handle backing the mapping (HANDLE)
+    void* m_mapping = nullptr;           ///< File mapping object (HANDLE)
+    const uint8_t* m_view = nullptr;     ///< Mapped archive bytes
+    uint64_t m_view_size = 0;            ///< Size of m_view
+
+    mutable std::unique_ptr<SnapshotManifest> m_manifest;  ///< Loaded on first manifest() call
+    mutable bool m_manifest_loaded = false;                ///< Whether loading was attempted
 };
 
 } // namespace insti
@@ -1,12 +1,28 @@
 #pragma once
 
 #include "writer.h"
+#include "compression_policy.h"
+#include "manifest.h"
 #include <pnq/pnq.h>
+#include <deque>
+#include <memory>
+#include <span>
+#include <string_view>
 
 namespace insti
 {
 
+class ThreadPool;
+
 /// Zip implementation of SnapshotWriter using miniz.
+///
+/// With a thread count other than 1, entries are read on the calling thread,
+/// deflated on a worker pool and appended to the archive by the calling thread
+/// in submission order, so the resulting archive is identical in layout to a
+/// single-threaded one.
+///
+/// With adaptive compression, entries that CompressionPolicy classifies as
+/// already compressed are stored without running deflate on them.
 class ZipSnapshotWriter final : public SnapshotWriter
 {
     PNQ_DECLARE_NON_COPYABLE(ZipSnapshotWriter)
@@ -18,6 +34,16 @@ public:
     static constexpr int COMPRESSION_BEST = 9;
     static constexpr int COMPRESSION_DEFAULT = -1;  // Usually level 6
 
+    /// Thread count constants for set_thread_count().
+    static constexpr unsigned THREADS_AUTO = 0;     // One worker per hardware thread
+    static constexpr unsigned THREADS_SERIAL = 1;   // Compress on the calling thread
+
+    /// Files larger than this are streamed synchronously instead of buffered for the pool.
+    static constexpr uint64_t PARALLEL_MAX_FILE_SIZE = 64ull * 1024 * 1024;
+
+    /// Upper bound on uncompressed bytes buffered for the pool before the caller blocks.
+    static constexpr uint64_t PARALLEL_MAX_PENDING_BYTES = 256ull * 1024 * 1024;
+
     ZipSnapshotWriter();
     ~ZipSnapshotWriter() override;
 
@@ -29,22 +55,88 @@ public:
     /// Must be called before adding files. Default is COMPRESSION_FAST (1).
     void set_compression_level(int level) { m_compression_level = level; }
 
+    /// Set number of compression threads (THREADS_AUTO, THREADS_SERIAL or explicit count).
+    /// Must be called before create(). Default is THREADS_SERIAL.
+    void set_thread_count(unsigned count) { m_thread_count = count; }
+
+    /// Record size, mtime and SHA-256 of every entry and store them as
+    /// SnapshotManifest::FILE_NAME on finalize(). Must be called before create().
+    void set_write_manifest(bool enable) { m_write_manifest = enable; }
+
+    /// Store entries that would not shrink (see CompressionPolicy) instead of
+    /// deflating them. Must be called before adding files. Default is off.
+    void set_adaptive_compression(bool enable) { m_adaptive = enable; }
+
+    /// Deflate/store decisions for entries written so far (not counting entries
+    /// written with compression level 0, raw copies or directories).
+    const CompressionStats& compression_stats() const { return m_stats; }
+
     // SnapshotWriter implementation
     bool create_directory(std::string_view path) override;
     bool write_binary(std::string_view path, const std::vector<uint8_t>& data) override;
     bool write_file(std::string_view archive_path, std::string_view src_path) override;
+    bool write_buffer(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime) override;
+    bool copy_entry(const SnapshotReader& source, std::string_view path) override;
+    bool can_prepare() const override { return true; }
+    std::unique_ptr<PreparedEntry> prepare(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime) const override;
+    bool write_prepared(std::unique_ptr<PreparedEntry> entry) override;
     bool finalize() override;
     void close() override;
     bool is_open() const override { return m_open; }
 
 private:
+    struct PendingEntry;
+    struct Prepared;
+
+    /// Compression level of entries deflated by deflate_entry() (pool or prepare()).
+    unsigned entry_level() const;
+
     /// Normalize path separators to forward slashes.
     std::string normalize_path(std::string_view path) const;
 
+    /// Hand an uncompressed buffer to the pool; appended later in submission order.
+    /// @param mtime Modification time to record (0 = now)
+    bool enqueue(std::string normalized, std::vector<uint8_t> data, int64_t mtime);
+
+    /// Append an in-memory entry on the calling thread (serial mode).
+    /// @param mtime Modification time to record (0 = now)
+    bool add_serial(std::string normalized, std::span<const uint8_t> data, int64_t mtime);
+
+    /// Record a written entry in the manifest (if enabled).
+    void record(std::string normalized, std::string hash, uint64_t size, int64_t mtime);
+
+    /// Level to write an entry with on the calling thread, after consulting the policy.
+    /// @param head First bytes of the entry (up to CompressionPolicy::SAMPLE_SIZE)
+    unsigned serial_level(std::string_view name, std::span<const uint8_t> head, CompressionPolicy::Reason& reason) const;
+
+    /// Count an entry written on the calling thread in m_stats.
+    void count_serial(std::string_view name, CompressionPolicy::Reason reason, uint64_t size);
+
+    /// Append completed entries to the archive in order.
+    /// Append failures are recorded in m_append_failed and surface from finalize().
+    /// @param max_pending Block until at most this many entries remain queued
+    void drain(size_t max_pending);
+
+    /// Append all queued entries (blocking).
+    void flush() { drain(0); }
+
+    /// Append one compressed or raw-copy entry to the archive.
+    bool append_pending(PendingEntry& entry);
+
     void* m_zip;              ///< miniz archive handle (mz_zip_archive*)
     bool m_open;              ///< Whether archive is currently open
     std::string m_path;       ///< Path to the archive file on disk
     int m_compression_level;  ///< Compression level (default: COMPRESSION_FAST)
+    unsigned m_thread_count;  ///< Compression threads (default: THREADS_SERIAL)
+    bool m_append_failed;     ///< A queued entry could not be appended; finalize() fails
+    bool m_write_manifest;    ///< Whether to hash entries and store a manifest
+    bool m_adaptive;          ///< Whether CompressionPolicy may store entries uncompressed
+    CompressionStats m_stats; ///< Decisions for entries written so far
+    SnapshotManifest m_manifest;  ///< Entries written so far (when m_write_manifest)
+
+    std::unique_ptr<ThreadPool> m_pool;                  ///< Compression workers (null when serial)
+    std::deque<std::unique_ptr<PendingEntry>> m_pending; ///< Entries awaiting append, in order
+    uint64_t m_pending_bytes;                            ///< Uncompressed bytes held by m_pending
 };
 
 } // namespace insti
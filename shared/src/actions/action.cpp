@@ -6,6 +6,69 @@
 namespace insti
 {
 
+    namespace
+    {
+        /// Append a path to a resource, lowercased, with '/' separators and no trailing separator.
+        void append_resource_path(std::string &resource, std::string_view path)
+        {
+            for (const char c : path)
+            {
+                if (c == '\\' || c == '/')
+                {
+                    if (resource.back() != '/')
+                        resource += '/';
+                }
+                else
+                {
+                    resource += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+            }
+            if (resource.back() == '/')
+                resource.pop_back();
+        }
+    } // anonymous namespace
+
+    std::string IAction::file_resource(std::string_view path)
+    {
+        std::string result{"file/"};
+        append_resource_path(result, path);
+        return result;
+    }
+
+    std::string IAction::registry_resource(std::string_view key, std::string_view value)
+    {
+        static constexpr std::pair<std::string_view, std::string_view> ROOTS[] = {
+            {"HKLM", "HKEY_LOCAL_MACHINE"},
+            {"HKCU", "HKEY_CURRENT_USER"},
+            {"HKCR", "HKEY_CLASSES_ROOT"},
+            {"HKU", "HKEY_USERS"},
+            {"HKCC", "HKEY_CURRENT_CONFIG"},
+        };
+
+        std::string result{"registry/"};
+        const size_t separator = key.find_first_of("\\/");
+        const std::string_view root = key.substr(0, separator);
+        for (const auto &[abbreviation, name] : ROOTS)
+        {
+            if (pnq::string::equals_nocase(root, abbreviation))
+            {
+                append_resource_path(result, name);
+                key = separator == std::string_view::npos ? std::string_view{} : key.substr(separator);
+                break;
+            }
+        }
+        append_resource_path(result, key);
+
+        if (!value.empty())
+        {
+            // Value names may contain backslashes; they are one path component
+            result += '/';
+            for (const char c : value)
+                result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+    }
+
     bool IAction::handle_decision(IActionCallback::Decision decision, ActionContext *ctx)
     {
         switch (decision)
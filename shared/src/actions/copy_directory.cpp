@@ -2,9 +2,18 @@
 #include <insti/actions/copy_directory.h>
 #include <insti/core/action_context.h>
 #include <insti/core/action_callback.h>
+#include <insti/core/background_deleter.h>
 #include <insti/core/blueprint.h>
+#include <insti/core/file_io.h>
+#include <insti/core/sha256.h>
+#include <insti/core/thread_pool.h>
+#include <insti/core/trace.h>
 #include <insti/snapshot/reader.h>
 #include <insti/snapshot/writer.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <unordered_set>
 #include <unordered_map>
@@ -12,79 +21,98 @@
 namespace insti
 {
 
-    bool CopyDirectoryAction::matches_filters(std::string_view filename) const
+    namespace
     {
-        // First check include filters (whitelist)
-        // If include filters exist, file must match at least one
-        if (!m_include_filters.empty())
+        /// Last component of a '/'-separated relative path.
+        std::string_view filename_of(std::string_view rel_path)
         {
-            bool included = false;
-            for (const auto &pattern : m_include_filters)
-            {
-                if (pnq::file::match(pattern, filename))
-                {
-                    included = true;
-                    break;
-                }
-            }
-            if (!included)
-                return false;
+            size_t last_slash = rel_path.rfind('/');
+            return (last_slash != std::string_view::npos) ? rel_path.substr(last_slash + 1) : rel_path;
         }
 
-        // Then check exclude filters (blacklist on top of whitelist)
-        for (const auto &pattern : m_exclude_filters)
+        /// Check whether a file still matches its entry in the parent snapshot (size and mtime).
+        /// Zip stores DOS timestamps with 2-second resolution, so mtimes within 2s are equal.
+        bool unchanged_since(const SnapshotReader &parent, const std::string &archive_path,
+                             const ScannedEntry &file)
         {
-            if (pnq::file::match(pattern, filename))
+            const ArchiveEntry *entry = parent.find_entry(archive_path);
+            if (!entry || entry->is_directory || entry->mtime == 0 || file.mtime == 0)
                 return false;
-        }
 
-        return true;
-    }
+            return file.size == entry->size && std::abs(file.mtime - entry->mtime) < 2;
+        }
 
-    std::optional<CopyDirectoryAction::CollectedEntries> CopyDirectoryAction::collect_entries(
-        const std::filesystem::path &base, ActionContext *ctx) const
-    {
-        CollectedEntries result;
-        auto *cb = ctx->callback();
-        std::error_code ec;
+        /// Block size for streamed file reads (verification, CRC checks).
+        constexpr size_t VERIFY_BLOCK_SIZE = 256 * 1024;
 
-        spdlog::info("collect_entries: starting iteration of {}, recursive={}", base.string(), m_recursive);
+        /// CRC32 of a file on disk, read in constant memory.
+        /// @return CRC, or nullopt if the file cannot be read
+        std::optional<uint32_t> crc32_of_file(const std::filesystem::path &path)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+                return std::nullopt;
 
-        auto iterator = m_recursive
-            ? std::filesystem::recursive_directory_iterator(base, ec)
-            : std::filesystem::recursive_directory_iterator(base, std::filesystem::directory_options::none, ec);
+            std::vector<char> buffer(VERIFY_BLOCK_SIZE);
+            mz_ulong crc = MZ_CRC32_INIT;
+            while (file)
+            {
+                file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                const auto got = static_cast<size_t>(file.gcount());
+                crc = mz_crc32(crc, reinterpret_cast<const uint8_t *>(buffer.data()), got);
+            }
+            if (file.bad())
+                return std::nullopt;
+            return static_cast<uint32_t>(crc);
+        }
 
-        if (ec)
+        /// Path below base as '/'-separated string, as used for archive entries.
+        std::string relative_key(const std::filesystem::path &path, const std::filesystem::path &base)
         {
-            spdlog::error("collect_entries: failed to create iterator: {}", ec.message());
-            return std::nullopt;
+            std::string rel = path.lexically_relative(base).string();
+            std::replace(rel.begin(), rel.end(), '\\', '/');
+            return rel;
         }
 
-        int count = 0;
-        for (const auto &entry : iterator)
+        /// Scan a directory tree, routing enumeration errors through the callback.
+        /// Subtrees that cannot be listed are skipped (Retry is treated as Skip, since the
+        /// walk has already finished).
+        /// @return scan result, or nullopt on abort
+        std::optional<ScanResult> scan_directory(const DirectoryScanner &scanner,
+                                                 const std::filesystem::path &base, ActionContext *ctx)
         {
-            if (ec)
+            auto *cb = ctx->callback();
+            ScanResult scan;
+            {
+                TraceSpan trace{"io", "scan", base};
+                scan = scanner.scan(base);
+            }
+
+            if (scan.root_failed)
             {
+                spdlog::error("Failed to enumerate {}: {}", base.string(), scan.errors.front().message);
+                if (cb)
+                    cb->on_error("Error iterating directory", base.string().c_str());
+                return std::nullopt;
+            }
+
+            for (const auto &error : scan.errors)
+            {
+                const std::string detail = error.path.string() + ": " + error.message;
                 if (ctx->skip_all_errors())
-                {
-                    ec.clear();
                     continue;
-                }
 
                 if (cb)
                 {
-                    auto decision = cb->on_error("Error iterating directory", ec.message().c_str());
+                    auto decision = cb->on_error("Error iterating directory", detail.c_str());
                     switch (decision)
                     {
                     case IActionCallback::Decision::Retry:
-                        // Can't retry iteration mid-stream, treat as skip
                     case IActionCallback::Decision::Skip:
                     case IActionCallback::Decision::Continue:
-                        ec.clear();
                         continue;
                     case IActionCallback::Decision::SkipAll:
                         ctx->set_skip_all_errors(true);
-                        ec.clear();
                         continue;
                     case IActionCallback::Decision::Abort:
                     default:
@@ -93,32 +121,52 @@ namespace insti
                 }
                 else
                 {
-                    spdlog::error("Error iterating directory: {}", ec.message());
+                    spdlog::error("Error iterating directory: {}", detail);
                     return std::nullopt;
                 }
             }
 
-            if (entry.is_directory())
-            {
-                result.dirs.push_back(entry.path());
-            }
-            else if (entry.is_regular_file())
-            {
-                // Always exclude blueprint.xml files (instance blueprints shouldn't be captured as artifacts)
-                std::string filename = entry.path().filename().string();
-                if (pnq::string::equals_nocase(filename, "blueprint.xml"))
-                    continue;
+            return scan;
+        }
+    } // anonymous namespace
 
-                if (matches_filters(filename))
-                    result.files.push_back(entry.path());
-            }
+    bool CopyDirectoryAction::matches_filters(std::string_view rel_path) const
+    {
+        // If include filters exist, file must match at least one;
+        // exclude filters are a blacklist on top of that
+        if (!m_include_set.empty() && !m_include_set.matches(rel_path))
+            return false;
 
-            ++count;
-            if (count % 100 == 0)
-                spdlog::debug("collect_entries: processed {} entries so far", count);
-        }
+        return !m_exclude_set.matches(rel_path);
+    }
+
+    DirectoryScanner CopyDirectoryAction::make_scanner() const
+    {
+        DirectoryScanner scanner;
+        scanner.set_recursive(m_recursive);
+        scanner.set_file_filter([this](std::string_view rel_path) {
+            // Always exclude blueprint.xml files (instance blueprints shouldn't be captured as artifacts)
+            return !pnq::string::equals_nocase(filename_of(rel_path), "blueprint.xml") && matches_filters(rel_path);
+        });
+        return scanner;
+    }
+
+    std::optional<CopyDirectoryAction::CollectedEntries> CopyDirectoryAction::collect_entries(
+        const std::filesystem::path &base, ActionContext *ctx) const
+    {
+        spdlog::info("collect_entries: starting scan of {}, recursive={}", base.string(), m_recursive);
+
+        auto scan = scan_directory(make_scanner(), base, ctx);
+        if (!scan)
+            return std::nullopt;
+
+        CollectedEntries result;
+        result.dirs.reserve(scan->dirs.size());
+        for (auto &dir : scan->dirs)
+            result.dirs.push_back(std::move(dir.path));
+        result.files = std::move(scan->files);
 
-        spdlog::info("collect_entries: iteration complete, {} total entries", count);
+        spdlog::info("collect_entries: scan complete, {} dirs, {} files", result.dirs.size(), result.files.size());
         return result;
     }
 
@@ -128,14 +176,13 @@ namespace insti
     {
         auto *cb = ctx->callback();
         auto *writer = ctx->writer();
-        std::error_code ec;
 
         // Pre-compute set of directories that contain files (O(n) instead of O(n²))
         std::unordered_set<std::string> dirs_with_files;
         for (const auto &file : entries.files)
         {
             // Add all parent directories of this file
-            std::filesystem::path parent = file.parent_path();
+            std::filesystem::path parent = file.path.parent_path();
             while (parent != base && !parent.empty())
             {
                 dirs_with_files.insert(parent.string());
@@ -149,14 +196,7 @@ namespace insti
             if (dirs_with_files.count(dir.string()) > 0)
                 continue;
 
-            auto rel = std::filesystem::relative(dir, base, ec);
-            if (ec)
-            {
-                spdlog::error("Error computing relative path: {}", ec.message());
-                continue;
-            }
-
-            std::string dir_rel_str = rel.string();
+            std::string dir_rel_str = dir.lexically_relative(base).string();
             std::replace(dir_rel_str.begin(), dir_rel_str.end(), '\\', '/');
             std::string dest_path = std::string{archive_prefix} + "/" + dir_rel_str;
 
@@ -200,47 +240,79 @@ namespace insti
     }
 
     bool CopyDirectoryAction::backup_files(
-        const std::filesystem::path &base, const std::vector<std::filesystem::path> &files,
+        const std::filesystem::path &base, const std::vector<ScannedEntry> &files,
         std::string_view archive_prefix, ActionContext *ctx) const
     {
         auto *cb = ctx->callback();
         auto *writer = ctx->writer();
-        std::error_code ec;
+        const auto *parent = ctx->parent();
+        auto &progress = ctx->progress();
 
         const size_t total = files.size();
-        int last_percent = -1;
+        size_t reused = 0;
 
+        // Where each file's content comes from. Small files are read ahead through the
+        // I/O backend, so opens and reads of the next files overlap with this one.
+        enum class Source : uint8_t { Parent, ReadAhead, Stream };
+        std::vector<std::string> dest_paths(total);
+        std::vector<Source> sources(total);
         for (size_t i = 0; i < total; ++i)
         {
-            const auto &file = files[i];
+            // Scanned paths are base / relative, so no filesystem lookup is needed here
+            dest_paths[i] = std::string{archive_prefix} + "/" + relative_key(files[i].path, base);
 
-            // Progress reporting at 1% thresholds
-            if (cb && total > 0)
+            // Incremental: unchanged files are taken from the parent as stored, without reading them
+            if (parent && unchanged_since(*parent, dest_paths[i], files[i]))
+                sources[i] = Source::Parent;
+            else
+                sources[i] = files[i].size <= FileIo::MAX_BUFFERED_SIZE ? Source::ReadAhead : Source::Stream;
+        }
+
+        auto io = FileIo::create(ctx->io_queue_depth(), ctx->io_pool());
+        size_t ahead = 0;  // Next file to consider for read-ahead
+        const auto fill = [&] {
+            for (; ahead < total && !io->full(); ++ahead)
             {
-                int percent = static_cast<int>((i * 100) / total);
-                if (percent >= last_percent + 1)
-                {
-                    cb->on_progress("Backup", file.filename().string(), percent);
-                    last_percent = percent;
-                }
+                if (sources[ahead] == Source::ReadAhead)
+                    io->submit({FileIo::Request::Kind::Read, files[ahead].path, {}, 0, ahead});
             }
+        };
 
-            auto rel = std::filesystem::relative(file, base, ec);
-            if (ec)
+        for (size_t i = 0; i < total; ++i)
+        {
+            const auto &file = files[i];
+            const std::string &dest_path = dest_paths[i];
+            std::string src_path = file.path.string();
+            TraceSpan trace{"file", "backup file", src_path};
+
+            if (sources[i] == Source::Parent && writer->copy_entry(*parent, dest_path))
             {
-                spdlog::error("Error computing relative path: {}", ec.message());
+                ++reused;
+                progress.advance(file.size, 1, file.path.filename().string());
                 continue;
             }
 
-            std::string rel_str = rel.string();
-            std::replace(rel_str.begin(), rel_str.end(), '\\', '/');
-            std::string dest_path = std::string{archive_prefix} + "/" + rel_str;
-            std::string src_path = file.string();
+            // Completions arrive in submission order, so the oldest one is this file's
+            std::optional<FileIo::Completion> read;
+            if (sources[i] == Source::ReadAhead)
+            {
+                fill();
+                read = io->complete();
+            }
 
             // Retry loop
             while (true)
             {
-                if (writer->write_file(dest_path, src_path))
+                // Files that could not be read ahead (and retries) go through write_file(),
+                // which reads them itself and logs why it failed
+                bool ok;
+                if (read && read->ok)
+                    ok = writer->write_buffer(dest_path, std::move(read->data), read->mtime);
+                else
+                    ok = writer->write_file(dest_path, src_path);
+                read.reset();
+
+                if (ok)
                     break;
 
                 if (ctx->skip_all_errors())
@@ -271,8 +343,14 @@ namespace insti
                     return false;
                 }
             }
+
+            // Skipped files count too: the bar tracks the work behind us, not what succeeded
+            progress.advance(file.size, 1, file.path.filename().string());
         }
 
+        if (parent)
+            spdlog::info("CopyDirectoryAction::backup: {} of {} files unchanged since parent snapshot", reused, total);
+
         return true;
     }
 
@@ -283,8 +361,7 @@ namespace insti
 
         spdlog::info("CopyDirectoryAction::backup: path={}, archive={}", resolved_path, m_archive_path);
 
-        if (cb)
-            cb->on_progress("Backup", description().c_str(), -1);
+        ctx->progress().flush(description());
 
         // Check if source exists
         std::filesystem::path base{resolved_path};
@@ -318,6 +395,12 @@ namespace insti
         }
         spdlog::info("CopyDirectoryAction::backup: collected {} dirs, {} files", entries->dirs.size(), entries->files.size());
 
+        ProgressEstimate work;
+        for (const auto &file : entries->files)
+            work.bytes += file.size;
+        work.items = entries->files.size();
+        ctx->progress().expect(work);
+
         // Create empty directories
         spdlog::info("CopyDirectoryAction::backup: backing up empty directories");
         if (!backup_empty_directories(base, *entries, prefix, ctx))
@@ -335,8 +418,7 @@ namespace insti
         }
 
         spdlog::info("CopyDirectoryAction::backup: completed successfully");
-        if (cb)
-            cb->on_progress("Backup", description().c_str(), 100);
+        ctx->progress().flush(description());
 
         return true;
     }
@@ -345,40 +427,134 @@ namespace insti
         std::string_view archive_prefix, ActionContext *ctx) const
     {
         ArchiveEntries result;
-        auto *reader = ctx->reader();
+        std::vector<std::pair<uint64_t, std::string>> files;
+        bool have_offsets = true;
 
-        // Normalize prefix (remove trailing slash)
-        std::string prefix{archive_prefix};
+        // Only the subtree below the prefix is visited, not the whole archive. The walk is
+        // depth-first, so every directory precedes its subdirectories (creation order).
+        ctx->reader()->for_each_entry_below(archive_prefix, [&](std::string_view rel_path, const ArchiveEntry &entry) {
+            if (entry.is_directory)
+            {
+                result.dirs.emplace_back(rel_path);
+                return;
+            }
+            have_offsets = have_offsets && entry.offset.has_value();
+            files.emplace_back(entry.offset.value_or(0), rel_path);
+        });
+
+        // Extract in archive order, so the archive is read front to back instead of seeking
+        if (have_offsets)
+            std::stable_sort(files.begin(), files.end(),
+                [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        result.files.reserve(files.size());
+        for (auto &file : files)
+            result.files.push_back(std::move(file.second));
+
+        return result;
+    }
+
+    std::optional<CopyDirectoryAction::DeltaPlan> CopyDirectoryAction::plan_delta(
+        const std::filesystem::path &dest_base, const ArchiveEntries &entries, ActionContext *ctx) const
+    {
+        DeltaPlan plan;
+
+        std::error_code ec;
+        if (!std::filesystem::exists(dest_base, ec))
+        {
+            // Nothing to compare against: everything is missing
+            plan.missing_dirs = entries.dirs;
+            plan.changed_files = entries.files;
+            return plan;
+        }
+        if (!std::filesystem::is_directory(dest_base, ec))
+            return std::nullopt;
+
+        // Unfiltered, like do_clean: whatever the snapshot does not contain is an extra
+        ScanResult scan;
+        {
+            TraceSpan trace{"io", "scan", dest_base};
+            scan = DirectoryScanner{}.scan(dest_base);
+        }
+        if (scan.root_failed || !scan.errors.empty())
+        {
+            spdlog::warn("plan_delta: cannot enumerate all of {}", dest_base.string());
+            return std::nullopt;
+        }
+
+        std::unordered_map<std::string, ScannedEntry> live_files;
+        std::unordered_map<std::string, std::filesystem::path> live_dirs;
+        live_files.reserve(scan.files.size());
+        for (auto &file : scan.files)
+        {
+            std::string rel = relative_key(file.path, dest_base);
+            live_files.emplace(std::move(rel), std::move(file));
+        }
+        for (auto &dir : scan.dirs)
+        {
+            std::string rel = relative_key(dir.path, dest_base);
+            live_dirs.emplace(std::move(rel), std::move(dir.path));
+        }
+
+        // Directories holding snapshot entries are not extras, even without an entry of their own
+        const auto keep_parents = [&live_dirs](const std::string &rel_path) {
+            for (size_t slash = rel_path.rfind('/'); slash != std::string::npos && slash > 0;
+                 slash = rel_path.rfind('/', slash - 1))
+                live_dirs.erase(rel_path.substr(0, slash));
+        };
+
+        for (const auto &rel_dir : entries.dirs)
+        {
+            keep_parents(rel_dir);
+            if (live_dirs.erase(rel_dir) == 0)
+                plan.missing_dirs.push_back(rel_dir);
+        }
+
+        std::string prefix = m_archive_path;
         if (!prefix.empty() && prefix.back() == '/')
             prefix.pop_back();
 
-        // Get all paths and filter by prefix
-        auto all_paths = reader->get_all_paths();
-        std::string prefix_with_slash = prefix + "/";
-
-        for (const auto &path : all_paths)
+        auto *reader = ctx->reader();
+        for (const auto &rel_file : entries.files)
         {
-            if (!path.starts_with(prefix_with_slash))
-                continue;
+            keep_parents(rel_file);
 
-            // Get relative path (after prefix/)
-            std::string rel_path = path.substr(prefix_with_slash.length());
-            if (rel_path.empty())
+            const auto live = live_files.find(rel_file);
+            if (live == live_files.end())
+            {
+                plan.changed_files.push_back(rel_file);
                 continue;
+            }
+
+            const ScannedEntry &disk_file = live->second;
+            const ArchiveEntry *entry = reader->find_entry(prefix + "/" + rel_file);
+            // The CRC is read last, only for files whose metadata already matches
+            const bool same = entry && !entry->is_directory && disk_file.size == entry->size &&
+                entry->mtime != 0 && disk_file.mtime != 0 && std::abs(disk_file.mtime - entry->mtime) < 2 &&
+                entry->crc32 && crc32_of_file(disk_file.path) == *entry->crc32;
 
-            if (reader->is_directory(path))
-                result.dirs.push_back(rel_path);
+            if (same)
+            {
+                ++plan.unchanged_files;
+                plan.unchanged_bytes += disk_file.size;
+            }
             else
-                result.files.push_back(rel_path);
+            {
+                // Deleted rather than overwritten, so read-only files behave as after a clean
+                plan.stale_files.push_back(disk_file.path);
+                plan.changed_files.push_back(rel_file);
+            }
+            live_files.erase(live);
         }
 
-        // Sort directories by depth (shallowest first for creation)
-        std::sort(result.dirs.begin(), result.dirs.end(),
-            [](const std::string &a, const std::string &b) {
-                return std::count(a.begin(), a.end(), '/') < std::count(b.begin(), b.end(), '/');
-            });
+        // A file where the snapshot has a directory (or the other way round) is an extra
+        // too; stale entries are deleted before anything is extracted
+        for (auto &[rel, file] : live_files)
+            plan.stale_files.push_back(std::move(file.path));
+        for (auto &[rel, dir] : live_dirs)
+            plan.stale_dirs.push_back(std::move(dir));
 
-        return result;
+        return plan;
     }
 
     bool CopyDirectoryAction::restore_directories(
@@ -442,12 +618,54 @@ namespace insti
         return true;
     }
 
+    bool CopyDirectoryAction::restore_file(
+        const std::string &archive_path, const std::filesystem::path &dest_path, ActionContext *ctx) const
+    {
+        auto *cb = ctx->callback();
+        auto *reader = ctx->reader();
+        TraceSpan trace{"file", "restore file", archive_path};
+
+        // Retry loop
+        while (true)
+        {
+            if (reader->extract_to_file(archive_path, dest_path.string()))
+                return true; // Success
+
+            if (ctx->skip_all_errors())
+                return true;
+
+            if (cb)
+            {
+                auto decision = cb->on_error("Failed to extract file", dest_path.string().c_str());
+                switch (decision)
+                {
+                case IActionCallback::Decision::Retry:
+                    continue;
+                case IActionCallback::Decision::Skip:
+                case IActionCallback::Decision::Continue:
+                    break;
+                case IActionCallback::Decision::SkipAll:
+                    ctx->set_skip_all_errors(true);
+                    break;
+                case IActionCallback::Decision::Abort:
+                default:
+                    return false;
+                }
+                return true;
+            }
+            else
+            {
+                spdlog::error("Failed to extract file: {}", dest_path.string());
+                return false;
+            }
+        }
+    }
+
     bool CopyDirectoryAction::restore_files(
         std::string_view archive_prefix, const std::filesystem::path &dest_base,
         const std::vector<std::string> &rel_files, ActionContext *ctx) const
     {
         auto *cb = ctx->callback();
-        auto *reader = ctx->reader();
         const bool simulate = ctx->simulate();
 
         // Normalize prefix
@@ -456,31 +674,23 @@ namespace insti
             prefix.pop_back();
 
         const size_t total = rel_files.size();
-        int last_percent = -1;
+
+        if (!simulate && total >= PARALLEL_RESTORE_MIN_FILES && ThreadPool::default_thread_count() > 1)
+            return restore_files_parallel(prefix, dest_base, rel_files, ctx);
+
+        auto *reader = ctx->reader();
+        auto &progress = ctx->progress();
 
         for (size_t i = 0; i < total; ++i)
         {
             const auto &rel_file = rel_files[i];
 
-            // Progress reporting at 1% thresholds
-            if (cb && total > 0)
-            {
-                int percent = static_cast<int>((i * 100) / total);
-                if (percent >= last_percent + 1)
-                {
-                    // Extract just filename for progress display
-                    size_t last_slash = rel_file.rfind('/');
-                    std::string filename = (last_slash != std::string::npos)
-                        ? rel_file.substr(last_slash + 1)
-                        : rel_file;
-                    cb->on_progress("Restore", filename, percent);
-                    last_percent = percent;
-                }
-            }
-
             std::string archive_path = prefix + "/" + rel_file;
             std::filesystem::path dest_path = dest_base / rel_file;
 
+            const ArchiveEntry *entry = reader->find_entry(archive_path);
+            progress.advance(entry ? entry->size : 0, 1, filename_of(rel_file));
+
             // Simulate mode: just log what would happen
             if (simulate)
             {
@@ -498,40 +708,142 @@ namespace insti
                 // Ignore errors here - will fail on extract if truly problematic
             }
 
-            // Retry loop
-            while (true)
+            if (!restore_file(archive_path, dest_path, ctx))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool CopyDirectoryAction::restore_files_parallel(
+        const std::string &prefix, const std::filesystem::path &dest_base,
+        const std::vector<std::string> &rel_files, ActionContext *ctx) const
+    {
+        auto *cb = ctx->callback();
+        auto *reader = ctx->reader();
+        auto &progress = ctx->progress();
+        const size_t total = rel_files.size();
+
+        // Sizes are looked up here: clones would each have to build the entry table
+        std::vector<uint64_t> sizes(total, 0);
+        for (size_t i = 0; i < total; ++i)
+        {
+            if (const ArchiveEntry *entry = reader->find_entry(prefix + "/" + rel_files[i]))
+                sizes[i] = entry->size;
+        }
+
+        // Create parent directories up front on this thread, parents before children,
+        // so workers only ever write files
+        {
+            std::vector<std::string> parents;
+            std::unordered_set<std::string> seen;
+            for (const auto &rel_file : rel_files)
             {
-                if (reader->extract_to_file(archive_path, dest_path.string()))
-                    break; // Success
+                size_t last_slash = rel_file.rfind('/');
+                if (last_slash != std::string::npos && seen.insert(rel_file.substr(0, last_slash)).second)
+                    parents.push_back(rel_file.substr(0, last_slash));
+            }
+            std::sort(parents.begin(), parents.end());
 
-                if (ctx->skip_all_errors())
-                    break;
+            for (const auto &parent : parents)
+            {
+                std::error_code ec;
+                std::filesystem::create_directories(dest_base / parent, ec);
+                // Ignore errors here - will fail on extract if truly problematic
+            }
+        }
 
-                if (cb)
+        enum : uint8_t { PENDING, DONE, FAILED };
+        std::vector<uint8_t> status(total, PENDING);  // Each slot written by exactly one worker
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> completed{0};
+        std::atomic<size_t> last_completed{0};
+        std::atomic<uint64_t> completed_bytes{0};
+        std::atomic<bool> stop{false};
+
+        // Without a callback the first failure aborts, so there's no point extracting the rest
+        // (unless a concurrent action has chosen SkipAll by then)
+        const auto stop_on_error = [&] { return !cb && !ctx->skip_all_errors(); };
+
+        // Concurrent actions share the operation's pool, so the total number of extraction
+        // threads stays at one per core; workers of later actions queue behind earlier ones
+        std::optional<ThreadPool> own_pool;
+        ThreadPool *pool = ctx->extract_pool();
+        if (!pool)
+            pool = &own_pool.emplace();
+
+        const size_t worker_count = std::min<size_t>(pool->thread_count(), total);
+        std::vector<std::future<void>> workers;
+        workers.reserve(worker_count);
+
+        for (size_t w = 0; w < worker_count; ++w)
+        {
+            workers.push_back(pool->submit([&] {
+                // Readers are not thread-safe, so each worker extracts through its own handle
+                SnapshotReader *local = reader->open_clone();
+                if (!local)
+                    return;
+
+                while (!stop.load())
                 {
-                    auto decision = cb->on_error("Failed to extract file", dest_path.string().c_str());
-                    switch (decision)
-                    {
-                    case IActionCallback::Decision::Retry:
-                        continue;
-                    case IActionCallback::Decision::Skip:
-                    case IActionCallback::Decision::Continue:
-                        break;
-                    case IActionCallback::Decision::SkipAll:
-                        ctx->set_skip_all_errors(true);
+                    const size_t i = next.fetch_add(1);
+                    if (i >= total)
                         break;
-                    case IActionCallback::Decision::Abort:
-                    default:
-                        return false;
+
+                    const auto &rel_file = rel_files[i];
+                    TraceSpan trace{"file", "restore file", rel_file};
+                    bool ok = false;
+                    try
+                    {
+                        ok = local->extract_to_file(prefix + "/" + rel_file, (dest_base / rel_file).string());
                     }
-                    break;
-                }
-                else
-                {
-                    spdlog::error("Failed to extract file: {}", dest_path.string());
-                    return false;
+                    catch (const std::exception &e)
+                    {
+                        spdlog::warn("Failed to extract {}: {}", rel_file, e.what());
+                    }
+
+                    status[i] = ok ? DONE : FAILED;
+                    if (!ok && stop_on_error())
+                        stop.store(true);
+                    completed_bytes.fetch_add(sizes[i]);
+                    last_completed.store(i);
+                    completed.fetch_add(1);
                 }
-            }
+
+                local->release(REFCOUNT_DEBUG_ARGS);
+            }));
+        }
+
+        // Progress is reported from this thread only, as workers finish files
+        size_t reported = 0;
+        uint64_t reported_bytes = 0;
+        const auto report = [&] {
+            const size_t done = completed.load();
+            const uint64_t done_bytes = completed_bytes.load();
+            if (done == reported)
+                return;
+            progress.advance(done_bytes - reported_bytes, done - reported, filename_of(rel_files[last_completed.load()]));
+            reported = done;
+            reported_bytes = done_bytes;
+        };
+        for (auto &worker : workers)
+        {
+            while (worker.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+                report();
+            worker.get();
+        }
+        report();
+
+        // Anything not extracted (failed, or never attempted because a worker could not
+        // open the snapshot or we stopped early) goes through the serial path, so each
+        // failure still gets the usual Retry/Skip/SkipAll/Abort decision
+        for (size_t i = 0; i < total; ++i)
+        {
+            if (status[i] == DONE)
+                continue;
+
+            if (!restore_file(prefix + "/" + rel_files[i], dest_base / rel_files[i], ctx))
+                return false;
         }
 
         return true;
@@ -542,14 +854,43 @@ namespace insti
         const std::string resolved_path = ctx->blueprint()->resolve(m_path);
         auto *cb = ctx->callback();
 
-        if (cb)
-            cb->on_progress("Restore", description().c_str(), -1);
+        ctx->progress().flush(description());
 
         if (!check_archive_exists(m_archive_path, ctx))
             return true;
 
+        std::filesystem::path dest_base{resolved_path};
+        auto entries = collect_archive_entries(m_archive_path, ctx);
+
+        if (ctx->delta_restore())
+        {
+            // The directory was not cleaned: bring it to the snapshot state in place
+            sweep_trash(dest_base, ctx);
+            auto plan = plan_delta(dest_base, entries, ctx);
+            if (plan)
+            {
+                spdlog::info("CopyDirectoryAction::restore: {} files unchanged, {} to extract, {} to delete",
+                             plan->unchanged_files, plan->changed_files.size(),
+                             plan->stale_files.size() + plan->stale_dirs.size());
+
+                if (!clean_files(plan->stale_files, ctx))
+                    return false;
+                if (!clean_directories(dest_base, plan->stale_dirs, ctx, false))
+                    return false;
+
+                ctx->progress().advance(plan->unchanged_bytes, plan->unchanged_files, {});
+                entries.dirs = std::move(plan->missing_dirs);
+                entries.files = std::move(plan->changed_files);
+            }
+            else
+            {
+                spdlog::warn("CopyDirectoryAction::restore: cannot compare {}, cleaning it first", resolved_path);
+                if (!do_clean(ctx))
+                    return false;
+            }
+        }
         // Check if destination already exists
-        if (pnq::directory::exists(resolved_path))
+        else if (pnq::directory::exists(resolved_path))
         {
             if (cb)
             {
@@ -563,7 +904,6 @@ namespace insti
         }
 
         // Create destination directory
-        std::filesystem::path dest_base{resolved_path};
         {
             std::error_code ec;
             std::filesystem::create_directories(dest_base, ec);
@@ -581,9 +921,6 @@ namespace insti
             }
         }
 
-        // Collect archive entries
-        auto entries = collect_archive_entries(m_archive_path, ctx);
-
         // Create directories first
         if (!restore_directories(dest_base, entries.dirs, ctx))
             return false;
@@ -592,8 +929,7 @@ namespace insti
         if (!restore_files(m_archive_path, dest_base, entries.files, ctx))
             return false;
 
-        if (cb)
-            cb->on_progress("Restore", description().c_str(), 100);
+        ctx->progress().flush(description());
 
         return true;
     }
@@ -603,23 +939,14 @@ namespace insti
     {
         auto *cb = ctx->callback();
         const bool simulate = ctx->simulate();
-        const size_t total = files.size();
-        int last_percent = -1;
+        auto &progress = ctx->progress();
 
-        for (size_t i = 0; i < total; ++i)
-        {
-            const auto &file = files[i];
+        // Deleting is weighted by files, so the tracker's rate and ETA count files too
+        progress.expect({0, files.size()});
 
-            // Progress reporting at 1% thresholds
-            if (cb && total > 0)
-            {
-                int percent = static_cast<int>((i * 100) / total);
-                if (percent >= last_percent + 1)
-                {
-                    cb->on_progress("Clean", file.filename().string(), percent);
-                    last_percent = percent;
-                }
-            }
+        for (const auto &file : files)
+        {
+            progress.advance(0, 1, file.filename().string());
 
             // Simulate mode: just log what would happen
             if (simulate)
@@ -635,12 +962,11 @@ namespace insti
             }
 
             // Retry loop
+            TraceSpan trace{"file", "delete file", file};
             while (true)
             {
+                // A file that is already gone is not an error for remove()
                 std::error_code ec;
-                if (!std::filesystem::exists(file, ec))
-                    break; // Already gone
-
                 std::filesystem::remove(file, ec);
                 if (!ec)
                     break; // Success
@@ -680,20 +1006,24 @@ namespace insti
 
     bool CopyDirectoryAction::clean_directories(
         const std::filesystem::path &base,
-        const std::vector<std::filesystem::path> &dirs, ActionContext *ctx) const
+        const std::vector<std::filesystem::path> &dirs, ActionContext *ctx,
+        bool remove_base) const
     {
         auto *cb = ctx->callback();
         const bool simulate = ctx->simulate();
 
-        // Sort directories by depth (deepest first) so we delete children before parents
-        std::vector<std::filesystem::path> sorted_dirs = dirs;
-        std::sort(sorted_dirs.begin(), sorted_dirs.end(),
-            [](const std::filesystem::path &a, const std::filesystem::path &b) {
-                return std::distance(a.begin(), a.end()) > std::distance(b.begin(), b.end());
-            });
+        // Sort directories by depth (deepest first) so we delete children before parents.
+        // Depths are computed once: counting path components in the comparator is O(n log n) walks
+        std::vector<std::pair<ptrdiff_t, const std::filesystem::path *>> by_depth;
+        by_depth.reserve(dirs.size());
+        for (const auto &dir : dirs)
+            by_depth.emplace_back(std::distance(dir.begin(), dir.end()), &dir);
+        std::stable_sort(by_depth.begin(), by_depth.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
 
-        for (const auto &dir : sorted_dirs)
+        for (const auto &[depth, dir_ptr] : by_depth)
         {
+            const auto &dir = *dir_ptr;
             // Simulate mode: just log what would happen
             if (simulate)
             {
@@ -711,10 +1041,7 @@ namespace insti
             while (true)
             {
                 std::error_code ec;
-                if (!std::filesystem::exists(dir, ec))
-                    break; // Already gone
-
-                std::filesystem::remove(dir, ec); // remove (not remove_all) - should be empty
+                std::filesystem::remove(dir, ec); // remove (not remove_all) - should be empty; gone is fine
                 if (!ec)
                     break; // Success
 
@@ -748,6 +1075,9 @@ namespace insti
             }
         }
 
+        if (!remove_base)
+            return true;
+
         // Finally, try to remove the base directory itself
         if (simulate)
         {
@@ -803,74 +1133,73 @@ namespace insti
         return true;
     }
 
+    void CopyDirectoryAction::sweep_trash(const std::filesystem::path &base, ActionContext *ctx) const
+    {
+        auto *deleter = ctx->background_deleter();
+        if (!deleter || ctx->simulate())
+            return;
+
+        for (auto &old_trash : BackgroundDeleter::find_trash(base))
+        {
+            spdlog::info("CopyDirectoryAction: deleting leftover {}", old_trash.string());
+            deleter->delete_async(std::move(old_trash));
+        }
+    }
+
     bool CopyDirectoryAction::do_clean(ActionContext *ctx) const
     {
-        auto *cb = ctx->callback();
         const std::string resolved_path = ctx->blueprint()->resolve(m_path);
 
         std::filesystem::path base{resolved_path};
 
+        sweep_trash(base, ctx);
+        auto *deleter = ctx->background_deleter();
+
         // Check if exists
         if (!std::filesystem::exists(base))
             return true; // Already clean
 
-        // Collect entries (reuse backup logic, but ignore filters for clean - delete everything)
-        // Note: For clean we don't apply filters - we delete everything in the directory
-        CollectedEntries entries;
-        std::error_code ec;
-
-        auto iterator = m_recursive
-            ? std::filesystem::recursive_directory_iterator(base, ec)
-            : std::filesystem::recursive_directory_iterator(base, std::filesystem::directory_options::none, ec);
-
-        for (const auto &entry : iterator)
+        // Fast path: move the whole tree aside in one rename and delete it in parallel in
+        // the background, so clean does not scale with the file count. If files are in use
+        // the rename fails and the tree is deleted in place, with Retry/Skip per locked file.
+        if (!ctx->simulate())
         {
-            if (ec)
+            if (auto trash = BackgroundDeleter::move_to_trash(base))
             {
-                if (ctx->skip_all_errors())
+                spdlog::info("CopyDirectoryAction::do_clean: moved {} to {}", resolved_path, trash->string());
+                if (deleter)
                 {
-                    ec.clear();
-                    continue;
+                    deleter->delete_async(std::move(*trash));
+                    return true;
                 }
 
-                if (cb)
-                {
-                    auto decision = cb->on_error("Error iterating directory", ec.message().c_str());
-                    switch (decision)
-                    {
-                    case IActionCallback::Decision::Retry:
-                    case IActionCallback::Decision::Skip:
-                    case IActionCallback::Decision::Continue:
-                        ec.clear();
-                        continue;
-                    case IActionCallback::Decision::SkipAll:
-                        ctx->set_skip_all_errors(true);
-                        ec.clear();
-                        continue;
-                    case IActionCallback::Decision::Abort:
-                    default:
-                        return false;
-                    }
-                }
-                else
-                {
-                    spdlog::error("Error iterating directory: {}", ec.message());
-                    return false;
-                }
+                BackgroundDeleter local;
+                local.delete_async(std::move(*trash));
+                return local.wait(ctx->progress(), ctx->callback(), ctx->skip_all_flag());
             }
-
-            if (entry.is_directory())
-                entries.dirs.push_back(entry.path());
-            else if (entry.is_regular_file())
-                entries.files.push_back(entry.path());
         }
 
+        // Collect entries (ignore filters and the recursive flag for clean - the whole
+        // directory including base is deleted)
+        auto scan = scan_directory(DirectoryScanner{}, base, ctx);
+        if (!scan)
+            return false;
+
+        std::vector<std::filesystem::path> files;
+        std::vector<std::filesystem::path> dirs;
+        files.reserve(scan->files.size());
+        dirs.reserve(scan->dirs.size());
+        for (auto &file : scan->files)
+            files.push_back(std::move(file.path));
+        for (auto &dir : scan->dirs)
+            dirs.push_back(std::move(dir.path));
+
         // Delete files first
-        if (!clean_files(entries.files, ctx))
+        if (!clean_files(files, ctx))
             return false;
 
         // Delete directories bottom-up
-        if (!clean_directories(base, entries.dirs, ctx))
+        if (!clean_directories(base, dirs, ctx))
             return false;
 
         return true;
@@ -878,48 +1207,80 @@ namespace insti
 
     namespace
     {
-        /// Compare a file on disk with a file in the archive
-        /// @return true if contents match exactly, false otherwise
-        bool compare_file_contents(const std::filesystem::path& disk_path,
+        /// Compare a file on disk with a file in the archive in constant memory.
+        /// Sizes are compared first. If the archive stores a CRC32 (zip), only the disk file
+        /// is read and its CRC compared - no decompression at all. Otherwise both sides are
+        /// streamed block by block, stopping at the first difference.
+        /// @return true if contents match, false otherwise
+        bool compare_file_contents(const ScannedEntry& disk_file,
                                    const std::string& archive_path,
                                    SnapshotReader* reader)
         {
-            // Read archive file
-            auto archive_data = reader->read_binary(archive_path);
-            if (archive_data.empty())
-            {
-                // Could be empty file - check if it exists
-                if (!reader->exists(archive_path))
-                    return false;
-            }
+            const auto& disk_path = disk_file.path;
+            const uint64_t file_size = disk_file.size;
 
-            // Read disk file
-            std::error_code ec;
-            auto file_size = std::filesystem::file_size(disk_path, ec);
-            if (ec)
+            // Quick size check against archive metadata
+            const auto entry = reader->stat(archive_path);
+            if (entry && (entry->is_directory || entry->size != file_size))
                 return false;
 
-            // Quick size check
-            if (file_size != archive_data.size())
-                return false;
+            if (entry && entry->crc32)
+                return crc32_of_file(disk_path) == *entry->crc32;
 
-            // Read and compare
             std::ifstream file(disk_path, std::ios::binary);
             if (!file)
                 return false;
 
-            std::vector<uint8_t> disk_data(static_cast<size_t>(file_size));
-            if (file_size > 0)
-            {
-                file.read(reinterpret_cast<char*>(disk_data.data()), static_cast<std::streamsize>(file_size));
-                if (!file)
+            std::vector<char> disk_block;
+            uint64_t compared = 0;
+            const bool same = reader->read_stream(archive_path, [&](const uint8_t* data, size_t size) {
+                disk_block.resize(size);
+                file.read(disk_block.data(), static_cast<std::streamsize>(size));
+                if (static_cast<size_t>(file.gcount()) != size)
                     return false;
-            }
+                compared += size;
+                return std::memcmp(disk_block.data(), data, size) == 0;
+            });
+
+            return same && compared == file_size;
+        }
+
+        /// Compare a file on disk with its snapshot manifest entry.
+        /// Only the disk file is read; the archive is not touched at all. In fast mode a
+        /// matching size and modification time (within the 2s zip granularity) counts as a
+        /// match without hashing.
+        /// @return true if contents match, false otherwise
+        bool compare_with_manifest(const ScannedEntry& disk_file,
+                                   const ManifestEntry& entry,
+                                   bool fast)
+        {
+            if (disk_file.size != entry.size)
+                return false;
+
+            if (fast && entry.mtime != 0 && disk_file.mtime != 0 && std::abs(disk_file.mtime - entry.mtime) < 2)
+                return true;
 
-            return disk_data == archive_data;
+            return Sha256::of_file(disk_file.path) == entry.hash;
         }
     } // anonymous namespace
 
+    ProgressEstimate CopyDirectoryAction::estimate(ActionContext *ctx) const
+    {
+        ProgressEstimate result;
+
+        if (auto *reader = ctx->reader())
+        {
+            reader->for_each_entry_below(m_archive_path, [&](std::string_view, const ArchiveEntry &entry) {
+                if (entry.is_directory)
+                    return;
+                result.bytes += entry.size;
+                ++result.items;
+            });
+        }
+        // A backup sizes its tree in backup(), from the one listing it makes anyway
+        return result;
+    }
+
     VerifyResult CopyDirectoryAction::verify(ActionContext *ctx) const
     {
         // Resolve path variables
@@ -947,6 +1308,7 @@ namespace insti
 
         // Reader available - do file-level comparison (instance verification)
         auto* reader = ctx->reader();
+        const auto* manifest = reader->manifest();
 
         // Check if exists in snapshot
         bool exists_in_snapshot = reader->exists(m_archive_path);
@@ -977,43 +1339,25 @@ namespace insti
 
         // Collect filesystem files
         std::filesystem::path base{resolved_path};
-        std::error_code ec;
         std::unordered_set<std::string> fs_file_set;
-        std::unordered_map<std::string, std::filesystem::path> fs_file_paths;
+        std::unordered_map<std::string, ScannedEntry> fs_file_entries;
 
         if (exists_on_system)
         {
-            auto iterator = m_recursive
-                ? std::filesystem::recursive_directory_iterator(base, ec)
-                : std::filesystem::recursive_directory_iterator(base, std::filesystem::directory_options::none, ec);
+            // Same files as backup() captures; unreadable subtrees show up as missing files,
+            // no need to interrupt verify
+            auto scan = make_scanner().scan(base);
+            for (const auto& error : scan.errors)
+                spdlog::warn("verify: cannot enumerate {}: {}", error.path.string(), error.message);
 
-            if (!ec)
+            for (auto& entry : scan.files)
             {
-                for (const auto& entry : iterator)
-                {
-                    if (entry.is_regular_file())
-                    {
-                        // Skip blueprint.xml
-                        std::string filename = entry.path().filename().string();
-                        if (pnq::string::equals_nocase(filename, "blueprint.xml"))
-                            continue;
-
-                        // Apply filters
-                        if (!matches_filters(filename))
-                            continue;
-
-                        // Compute relative path with forward slashes
-                        auto rel = std::filesystem::relative(entry.path(), base, ec);
-                        if (ec)
-                            continue;
+                // Compute relative path with forward slashes
+                std::string rel_str = entry.path.lexically_relative(base).string();
+                std::replace(rel_str.begin(), rel_str.end(), '\\', '/');
 
-                        std::string rel_str = rel.string();
-                        std::replace(rel_str.begin(), rel_str.end(), '\\', '/');
-
-                        fs_file_set.insert(rel_str);
-                        fs_file_paths[rel_str] = entry.path();
-                    }
-                }
+                fs_file_set.insert(rel_str);
+                fs_file_entries[rel_str] = std::move(entry);
             }
         }
 
@@ -1048,9 +1392,15 @@ namespace insti
             {
                 // Both exist - compare contents
                 std::string archive_full_path = prefix + "/" + rel_file;
-                const auto& disk_path = fs_file_paths[rel_file];
+                const auto& disk_file = fs_file_entries[rel_file];
+
+                // Prefer the manifest hash: no decompression, and CRC32 collisions are not an issue
+                const auto* manifest_entry = manifest ? manifest->find(archive_full_path) : nullptr;
+                const bool same = (manifest_entry && !manifest_entry->is_directory())
+                    ? compare_with_manifest(disk_file, *manifest_entry, ctx->verify_fast())
+                    : compare_file_contents(disk_file, archive_full_path, reader);
 
-                if (compare_file_contents(disk_path, archive_full_path, reader))
+                if (same)
                 {
                     result.file_match_count++;
                 }
@@ -1121,6 +1471,11 @@ namespace insti
         return params;
     }
 
+    std::vector<std::string> CopyDirectoryAction::resources(ActionContext *ctx) const
+    {
+        return {file_resource(ctx->blueprint()->resolve(m_path))};
+    }
+
     std::string CopyDirectoryAction::describe_clean() const
     {
         return "Folder: " + m_path;
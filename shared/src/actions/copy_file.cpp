@@ -21,8 +21,7 @@ namespace insti
         const std::string resolved_path = ctx->blueprint()->resolve(m_path);
         auto *cb = ctx->callback();
 
-        if (cb)
-            cb->on_progress("Backup", description(), -1);
+        ctx->progress().flush(description());
 
         // Check if source exists
         if (!pnq::file::exists(resolved_path))
@@ -67,6 +66,7 @@ namespace insti
             return false;
         }
 
+        ctx->progress().advance(content.size(), 1, description());
         return true;
     }
 
@@ -76,8 +76,7 @@ namespace insti
         auto *cb = ctx->callback();
         const bool simulate = ctx->simulate();
 
-        if (cb)
-            cb->on_progress("Restore", description(), -1);
+        ctx->progress().flush(description());
 
         if (!check_archive_exists(m_archive_path, ctx))
             return true;
@@ -141,6 +140,7 @@ namespace insti
             return false;
         }
 
+        ctx->progress().advance(content.size(), 1, description());
         return true;
     }
 
@@ -169,6 +169,19 @@ namespace insti
         return !ec;
     }
 
+    ProgressEstimate CopyFileAction::estimate(ActionContext *ctx) const
+    {
+        if (auto *reader = ctx->reader())
+        {
+            const ArchiveEntry *entry = reader->find_entry(m_archive_path);
+            return entry ? ProgressEstimate{entry->size, 1} : ProgressEstimate{};
+        }
+
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(ctx->blueprint()->resolve(m_path), ec);
+        return ec ? ProgressEstimate{} : ProgressEstimate{size, 1};
+    }
+
     VerifyResult CopyFileAction::verify(ActionContext *ctx) const
     {
         const std::string resolved_path = ctx->blueprint()->resolve(m_path);
@@ -199,6 +212,11 @@ namespace insti
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> CopyFileAction::resources(ActionContext *ctx) const
+    {
+        return {file_resource(ctx->blueprint()->resolve(m_path))};
+    }
+
     std::string CopyFileAction::describe_clean() const
     {
         return "File: " + m_path;
@@ -202,6 +202,11 @@ namespace insti
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> DelimitedEntryAction::resources(ActionContext *ctx) const
+    {
+        return {registry_resource(m_key, m_value_name)};
+    }
+
     std::string DelimitedEntryAction::describe_clean() const
     {
         return "Registry entry in " + m_key + "\\" + m_value_name + ": " + m_entry;
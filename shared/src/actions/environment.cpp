@@ -255,6 +255,15 @@ namespace insti
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> EnvironmentAction::resources(ActionContext *ctx) const
+    {
+        // Where open_env_key() keeps the variable
+        return {registry_resource(m_scope == EnvironmentScope::User
+                                      ? "HKEY_CURRENT_USER\\Environment"
+                                      : "HKEY_LOCAL_MACHINE\\SYSTEM\\CurrentControlSet\\Control\\Session Manager\\Environment",
+                                  m_name)};
+    }
+
     std::string EnvironmentAction::describe_clean() const
     {
         const char* scope_str = m_scope == EnvironmentScope::User ? "User" : "System";
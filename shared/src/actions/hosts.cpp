@@ -258,6 +258,12 @@ namespace insti
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> HostsAction::resources(ActionContext *ctx) const
+    {
+        // All entries share the one hosts file, which is rewritten as a whole
+        return {file_resource(hosts_file_path())};
+    }
+
     std::string HostsAction::describe_clean() const
     {
         return "Hosts entry: " + m_hostname;
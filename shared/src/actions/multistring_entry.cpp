@@ -230,6 +230,11 @@ namespace insti
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> MultiStringEntryAction::resources(ActionContext *ctx) const
+    {
+        return {registry_resource(m_key, m_value_name)};
+    }
+
     std::string MultiStringEntryAction::describe_clean() const
     {
         return "Registry entry in " + m_key + "\\" + m_value_name + ": " + m_entry;
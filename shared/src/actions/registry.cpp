@@ -294,6 +294,11 @@ void set_permissive_registry_sddl(const std::string& key_path)
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> RegistryAction::resources(ActionContext *ctx) const
+    {
+        return {registry_resource(ctx->blueprint()->resolve(m_key))};
+    }
+
     std::string RegistryAction::describe_clean() const
     {
         return "Registry: " + m_key;
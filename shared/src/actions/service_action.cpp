@@ -5,6 +5,8 @@
 #include <insti/snapshot/reader.h>
 #include <insti/snapshot/writer.h>
 #include <pnq/win32/service.h>
+#include <algorithm>
+#include <filesystem>
 #include <toml++/toml.hpp>
 
 namespace insti
@@ -79,6 +81,53 @@ namespace insti
         }
     }
 
+    namespace
+    {
+        /// Directory of the executable in a service's ImagePath, which may be quoted, carry
+        /// arguments, or use the kernel forms "\SystemRoot\..." and "\??\C:\...".
+        /// @return nullopt if no absolute path can be worked out
+        std::optional<std::string> binary_directory(std::string_view image_path)
+        {
+            while (!image_path.empty() && image_path.front() == ' ')
+                image_path.remove_prefix(1);
+
+            std::string binary;
+            if (!image_path.empty() && image_path.front() == '"')
+            {
+                const size_t end = image_path.find('"', 1);
+                if (end == std::string_view::npos)
+                    return std::nullopt;
+                binary = image_path.substr(1, end - 1);
+            }
+            else
+            {
+                // Unquoted paths may contain spaces; the executable ends at ".exe"
+                std::string lower{image_path};
+                std::transform(lower.begin(), lower.end(), lower.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                const size_t exe = lower.find(".exe");
+                binary = exe != std::string::npos ? image_path.substr(0, exe + 4) : image_path.substr(0, image_path.find(' '));
+            }
+
+            if (binary.starts_with("\\??\\"))
+                binary.erase(0, 4);
+            else if (_strnicmp(binary.c_str(), "\\SystemRoot\\", 12) == 0)
+                binary = "%SystemRoot%" + binary.substr(11);
+            else if (_strnicmp(binary.c_str(), "System32\\", 9) == 0)
+                binary = "%SystemRoot%\\" + binary;
+
+            char expanded[MAX_PATH * 2];
+            const DWORD length = ExpandEnvironmentStringsA(binary.c_str(), expanded, static_cast<DWORD>(std::size(expanded)));
+            if (length == 0 || length > std::size(expanded))
+                return std::nullopt;
+
+            const std::filesystem::path path{expanded};
+            if (!path.is_absolute() || !path.has_parent_path())
+                return std::nullopt;
+            return path.parent_path().string();
+        }
+    } // anonymous namespace
+
     // ============================================================================
     // ServiceAction implementation
     // ============================================================================
@@ -366,6 +415,32 @@ namespace insti
             {"archive", m_archive_path}};
     }
 
+    std::vector<std::string> ServiceAction::resources(ActionContext *ctx) const
+    {
+        // The service must not start before its binary is restored, nor be stopped while its
+        // files are being deleted, so it also claims the binary's directory. A restore takes
+        // the binary path from the snapshot, backup and clean from the installed service.
+        std::optional<ServiceConfig> config;
+        if (ctx->reader() && ctx->reader()->exists(m_archive_path))
+            config = ServiceConfig::from_toml(ctx->reader()->read_text(m_archive_path));
+        else
+            config = read_config();
+
+        const auto directory = config ? binary_directory(config->binary_path) : std::nullopt;
+        if (!directory)
+        {
+            spdlog::debug("ServiceAction: binary of '{}' unknown, running on its own", m_name);
+            return {};
+        }
+
+        std::string resource = "service/" + m_name;
+        std::transform(resource.begin(), resource.end(), resource.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return {resource,
+                file_resource(*directory),
+                registry_resource("HKLM\\SYSTEM\\CurrentControlSet\\Services\\" + m_name)};
+    }
+
     std::string ServiceAction::describe_clean() const
     {
         return "Service: " + m_name;
@@ -10,7 +10,9 @@ namespace insti
 
 #define ASSIGN_ADDREF(member, value) member = value; PNQ_ADDREF(value)
 
-ActionContext::ActionContext(const Blueprint* blueprint, SnapshotReader* reader, SnapshotWriter* writer, IActionCallback* callback)
+ActionContext::ActionContext(const Blueprint* blueprint, SnapshotReader* reader, SnapshotWriter* writer, IActionCallback* callback,
+                             ProgressTracker* progress)
+    : m_progress{progress}
 {
     ASSIGN_ADDREF(m_blueprint, blueprint);
     ASSIGN_ADDREF(m_reader, reader);
@@ -18,19 +20,47 @@ ActionContext::ActionContext(const Blueprint* blueprint, SnapshotReader* reader,
     ASSIGN_ADDREF(m_callback, callback);
 }
 
-ActionContext* ActionContext::for_backup(const Blueprint* blueprint, SnapshotWriter* writer, IActionCallback* callback)
+ActionContext* ActionContext::for_backup(const Blueprint* blueprint, SnapshotWriter* writer, IActionCallback* callback,
+                                         SnapshotReader* parent)
 {
-    return new ActionContext(blueprint, nullptr, writer, callback);
+    auto progress = std::make_unique<ProgressTracker>(callback, "Backup");
+    auto* ctx = new ActionContext(blueprint, nullptr, writer, callback, progress.get());
+    ctx->m_own_progress = std::move(progress);
+    ASSIGN_ADDREF(ctx->m_parent, parent);
+    return ctx;
 }
 
 ActionContext* ActionContext::for_restore(const Blueprint* blueprint, SnapshotReader* reader, IActionCallback* callback)
 {
-    return new ActionContext(blueprint, reader, nullptr, callback);
+    auto progress = std::make_unique<ProgressTracker>(callback, "Restore");
+    auto* ctx = new ActionContext(blueprint, reader, nullptr, callback, progress.get());
+    ctx->m_own_progress = std::move(progress);
+    return ctx;
 }
 
 ActionContext* ActionContext::for_clean(const Blueprint* blueprint, IActionCallback* callback)
 {
-    return new ActionContext(blueprint, nullptr, nullptr, callback);
+    auto progress = std::make_unique<ProgressTracker>(callback, "Clean");
+    auto* ctx = new ActionContext(blueprint, nullptr, nullptr, callback, progress.get());
+    ctx->m_own_progress = std::move(progress);
+    return ctx;
+}
+
+ActionContext* ActionContext::for_worker(ActionContext* owner, SnapshotReader* reader, SnapshotWriter* writer,
+                                         IActionCallback* callback)
+{
+    auto* ctx = new ActionContext(owner->m_blueprint, reader, writer, callback, owner->m_progress);
+    ASSIGN_ADDREF(ctx->m_parent, owner->m_parent);
+    ctx->m_background_deleter = owner->m_background_deleter;
+    ctx->m_simulate = owner->m_simulate;
+    ctx->m_verify_fast = owner->m_verify_fast;
+    ctx->m_delta_restore = owner->m_delta_restore;
+    ctx->m_skip_all_errors = owner->m_skip_all_errors;
+    ctx->m_io_queue_depth = owner->m_io_queue_depth;
+    ctx->m_io_pool = owner->m_io_pool;
+    ctx->m_extract_pool = owner->m_extract_pool;
+    ctx->m_overrides = owner->m_overrides;
+    return ctx;
 }
 
 ActionContext::~ActionContext()
@@ -39,6 +69,7 @@ ActionContext::~ActionContext()
     PNQ_RELEASE(m_reader);
     PNQ_RELEASE(m_writer);
     PNQ_RELEASE(m_callback);
+    PNQ_RELEASE(m_parent);
 }
 
 void ActionContext::set_override(std::string_view name, std::string_view value)
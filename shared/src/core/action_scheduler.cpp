@@ -0,0 +1,325 @@
+#include "pch.h"
+#include <insti/core/action_scheduler.h>
+#include <insti/actions/action.h>
+#include <insti/core/action_callback.h>
+#include <insti/core/action_context.h>
+#include <insti/core/thread_pool.h>
+#include <insti/core/trace.h>
+#include <insti/snapshot/reader.h>
+#include <insti/snapshot/synchronized_writer.h>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+
+namespace insti
+{
+
+    namespace
+    {
+        /// What workers hand to the thread running the schedule.
+        class Mailbox final
+        {
+        public:
+            /// Queue a function to be run on the owner thread.
+            void post_call(std::move_only_function<void()> call)
+            {
+                {
+                    std::lock_guard lock{m_mutex};
+                    m_calls.push_back(std::move(call));
+                }
+                m_changed.notify_one();
+            }
+
+            /// Report a finished action.
+            void post_done(size_t index, bool ok)
+            {
+                {
+                    std::lock_guard lock{m_mutex};
+                    m_done.emplace_back(index, ok);
+                }
+                m_changed.notify_one();
+            }
+
+            /// Block until something arrives, run the queued calls and return finished actions.
+            std::vector<std::pair<size_t, bool>> wait()
+            {
+                std::deque<std::move_only_function<void()>> calls;
+                std::vector<std::pair<size_t, bool>> done;
+                {
+                    std::unique_lock lock{m_mutex};
+                    m_changed.wait(lock, [this] { return !m_calls.empty() || !m_done.empty(); });
+                    calls.swap(m_calls);
+                    done.swap(m_done);
+                }
+
+                for (auto& call : calls)
+                    call();
+                return done;
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::condition_variable m_changed;
+            std::deque<std::move_only_function<void()>> m_calls;
+            std::vector<std::pair<size_t, bool>> m_done;
+        };
+
+        /// Callback for workers: every call runs on the owner thread and the worker
+        /// blocks until it returns (decisions such as Retry/Abort need the answer).
+        class ForwardingCallback final : public IActionCallback
+        {
+        public:
+            ForwardingCallback(IActionCallback* target, Mailbox& mailbox)
+                : m_target{target}
+                , m_mailbox{mailbox}
+                , m_owner{std::this_thread::get_id()}
+            {
+            }
+
+            void on_progress(std::string_view phase, std::string_view detail, int percent) override
+            {
+                forward([&] { m_target->on_progress(phase, detail, percent); });
+            }
+
+            void on_progress_info(const ProgressInfo& info) override
+            {
+                forward([&] { m_target->on_progress_info(info); });
+            }
+
+            void on_warning(std::string_view message) override
+            {
+                forward([&] { m_target->on_warning(message); });
+            }
+
+            Decision on_error(std::string_view message, std::string_view context) override
+            {
+                return forward([&] { return m_target->on_error(message, context); });
+            }
+
+            Decision on_file_conflict(std::string_view path, std::string_view action) override
+            {
+                return forward([&] { return m_target->on_file_conflict(path, action); });
+            }
+
+        private:
+            template <typename F>
+            auto forward(F&& fn) -> std::invoke_result_t<F&>
+            {
+                if (std::this_thread::get_id() == m_owner)
+                    return fn();
+
+                // Arguments are views into the worker's stack, which stays put until the call returns
+                std::packaged_task<std::invoke_result_t<F&>()> task{std::ref(fn)};
+                auto result = task.get_future();
+                m_mailbox.post_call([&task] { task(); });
+                return result.get();
+            }
+
+            IActionCallback* m_target;
+            Mailbox& m_mailbox;
+            const std::thread::id m_owner;
+        };
+
+        /// True if the actions must not run at the same time.
+        bool conflict(const std::vector<std::string>& a, const std::vector<std::string>& b)
+        {
+            // Unknown resources: could be anything
+            if (a.empty() || b.empty())
+                return true;
+
+            for (const auto& x : a)
+            {
+                for (const auto& y : b)
+                {
+                    if (ActionScheduler::overlap(x, y))
+                        return true;
+                }
+            }
+            return false;
+        }
+    } // anonymous namespace
+
+    ActionScheduler::ActionScheduler(std::vector<const IAction*> actions, ActionContext* ctx)
+        : m_actions{std::move(actions)}
+        , m_ctx{ctx}
+        , m_dependents(m_actions.size())
+        , m_dependency_count(m_actions.size(), 0)
+    {
+        std::vector<std::vector<std::string>> resources;
+        resources.reserve(m_actions.size());
+        for (const auto* action : m_actions)
+            resources.push_back(action->resources(ctx));
+
+        // Each action waits for every earlier one it conflicts with, so conflicting
+        // actions keep their order and everything else is free to overlap
+        size_t independent = 0;
+        for (size_t later = 0; later < m_actions.size(); ++later)
+        {
+            for (size_t earlier = 0; earlier < later; ++earlier)
+            {
+                if (conflict(resources[earlier], resources[later]))
+                {
+                    m_dependents[earlier].push_back(later);
+                    ++m_dependency_count[later];
+                }
+            }
+            if (m_dependency_count[later] == 0)
+                ++independent;
+        }
+
+        spdlog::debug("ActionScheduler: {} actions, {} without dependencies", m_actions.size(), independent);
+    }
+
+    bool ActionScheduler::overlap(std::string_view a, std::string_view b)
+    {
+        const std::string_view shorter = a.size() <= b.size() ? a : b;
+        const std::string_view longer = a.size() <= b.size() ? b : a;
+        return longer.starts_with(shorter) && (longer.size() == shorter.size() || longer[shorter.size()] == '/');
+    }
+
+    bool ActionScheduler::run_serial(const Step& step)
+    {
+        for (const auto* action : m_actions)
+        {
+            if (!step(action, m_ctx))
+                return false;
+        }
+        return true;
+    }
+
+    bool ActionScheduler::run(const Step& step)
+    {
+        TraceSpan trace{"phase", "actions"};
+        if (m_max_parallel <= 1 || m_actions.size() <= 1)
+            return run_serial(step);
+
+        // Workers read through clones of the snapshot (readers are not thread-safe)
+        std::vector<SnapshotReader*> idle_readers;
+        if (auto* reader = m_ctx->reader())
+        {
+            auto* clone = reader->open_clone();
+            if (!clone)
+            {
+                spdlog::debug("ActionScheduler: snapshot cannot be cloned, running actions in order");
+                return run_serial(step);
+            }
+            idle_readers.push_back(clone);
+        }
+
+        // Unchanged-file lookups in the parent snapshot must not build its index concurrently
+        if (auto* parent = m_ctx->parent())
+            parent->all_entries();
+
+        std::optional<SynchronizedSnapshotWriter> writer;
+        if (m_ctx->writer())
+            writer.emplace(m_ctx->writer());
+
+        Mailbox mailbox;
+        IActionCallback* const owner_callback = m_ctx->callback();
+        ForwardingCallback forwarder{owner_callback, mailbox};
+        IActionCallback* const worker_callback = owner_callback ? &forwarder : nullptr;
+        IActionCallback* const previous_progress_callback = m_ctx->progress().set_callback(worker_callback);
+
+        const size_t count = m_actions.size();
+        std::vector<size_t> waiting = m_dependency_count;
+        std::set<size_t> ready;  // Started in blueprint order where possible
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (waiting[i] == 0)
+                ready.insert(i);
+        }
+
+        std::vector<ActionContext*> contexts(count, nullptr);
+        std::vector<SnapshotReader*> readers(count, nullptr);
+        size_t running = 0;
+        bool ok = true;
+
+        {
+            ThreadPool pool{static_cast<unsigned>(std::min<size_t>(m_max_parallel, count))};
+
+            while (true)
+            {
+                while (ok && !ready.empty() && running < m_max_parallel)
+                {
+                    const size_t index = *ready.begin();
+                    ready.erase(ready.begin());
+
+                    if (m_ctx->reader())
+                    {
+                        if (idle_readers.empty())
+                        {
+                            auto* clone = m_ctx->reader()->open_clone();
+                            if (!clone)
+                            {
+                                spdlog::error("ActionScheduler: failed to open snapshot for {}", m_actions[index]->description());
+                                ok = false;
+                                break;
+                            }
+                            idle_readers.push_back(clone);
+                        }
+                        readers[index] = idle_readers.back();
+                        idle_readers.pop_back();
+                    }
+
+                    contexts[index] = ActionContext::for_worker(m_ctx, readers[index], writer ? &*writer : nullptr,
+                                                                worker_callback);
+                    ++running;
+                    pool.submit([this, &step, &mailbox, &contexts, index] {
+                        bool result = false;
+                        try
+                        {
+                            result = step(m_actions[index], contexts[index]);
+                        }
+                        catch (const std::exception& e)
+                        {
+                            spdlog::error("ActionScheduler: {} failed: {}", m_actions[index]->description(), e.what());
+                        }
+                        catch (...)
+                        {
+                            // Anything escaping the worker would terminate the process
+                            // and leave the owner waiting for this action forever
+                            spdlog::error("ActionScheduler: {} failed with an unknown exception", m_actions[index]->description());
+                        }
+                        mailbox.post_done(index, result);
+                    });
+                }
+
+                if (running == 0)
+                    break;
+
+                for (const auto& [index, result] : mailbox.wait())
+                {
+                    --running;
+                    contexts[index]->release(REFCOUNT_DEBUG_ARGS);
+                    contexts[index] = nullptr;
+                    if (readers[index])
+                    {
+                        idle_readers.push_back(readers[index]);
+                        readers[index] = nullptr;
+                    }
+
+                    if (!result)
+                    {
+                        ok = false;
+                        continue;
+                    }
+                    for (const size_t dependent : m_dependents[index])
+                    {
+                        if (--waiting[dependent] == 0)
+                            ready.insert(dependent);
+                    }
+                }
+            }
+        }
+
+        for (auto* reader : idle_readers)
+            reader->release(REFCOUNT_DEBUG_ARGS);
+        m_ctx->progress().set_callback(previous_progress_callback);
+        return ok;
+    }
+
+} // namespace insti
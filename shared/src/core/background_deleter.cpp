@@ -0,0 +1,238 @@
+#include "pch.h"
+#include <insti/core/background_deleter.h>
+#include <insti/core/action_callback.h>
+#include <insti/core/directory_scanner.h>
+#include <insti/core/progress_tracker.h>
+#include <insti/core/thread_pool.h>
+#include <insti/core/trace.h>
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+namespace insti
+{
+
+    namespace
+    {
+        /// Distinguishes trash directories created in the same millisecond.
+        std::atomic<uint32_t> s_trash_counter{0};
+
+        /// Trash names of path start with this: ".<name>.insti-trash-".
+        std::wstring trash_prefix(const std::filesystem::path& path)
+        {
+            return L"." + path.filename().wstring() +
+                std::filesystem::path{BackgroundDeleter::TRASH_INFIX}.wstring();
+        }
+    } // anonymous namespace
+
+    BackgroundDeleter::~BackgroundDeleter()
+    {
+        for (auto& [trash, future] : m_pending)
+            future.wait();
+    }
+
+    std::optional<std::filesystem::path> BackgroundDeleter::move_to_trash(const std::filesystem::path& path)
+    {
+        // A sibling is on the same volume, so the rename never degrades into a copy
+        const auto parent = path.parent_path();
+        if (!path.has_filename() || parent.empty() || parent == path)
+            return std::nullopt;
+
+        const auto stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        const auto trash = parent / (trash_prefix(path) +
+            std::to_wstring(stamp) + L"-" + std::to_wstring(s_trash_counter.fetch_add(1)));
+
+        std::error_code ec;
+        std::filesystem::rename(path, trash, ec);
+        if (ec)
+        {
+            spdlog::info("move_to_trash: cannot rename {}: {}", path.string(), ec.message());
+            return std::nullopt;
+        }
+
+        // Out of sight if the deletion does not finish (best effort)
+        const DWORD attributes = GetFileAttributesW(trash.c_str());
+        if (attributes != INVALID_FILE_ATTRIBUTES)
+            SetFileAttributesW(trash.c_str(), attributes | FILE_ATTRIBUTE_HIDDEN);
+        return trash;
+    }
+
+    std::vector<std::filesystem::path> BackgroundDeleter::find_trash(const std::filesystem::path& path)
+    {
+        std::vector<std::filesystem::path> result;
+        const auto parent = path.parent_path();
+        if (!path.has_filename() || parent.empty())
+            return result;
+
+        const std::wstring prefix = trash_prefix(path);
+        std::error_code ec;
+        for (std::filesystem::directory_iterator it{parent, ec}, end; !ec && it != end; it.increment(ec))
+        {
+            const std::wstring name = it->path().filename().wstring();
+            if (name.size() > prefix.size() && _wcsnicmp(name.c_str(), prefix.c_str(), prefix.size()) == 0)
+                result.push_back(it->path());
+        }
+        return result;
+    }
+
+    void BackgroundDeleter::delete_async(std::filesystem::path trash)
+    {
+        std::lock_guard lock{m_mutex};
+        auto future = std::async(std::launch::async, [this, trash] { return delete_tree(trash); });
+        m_pending.emplace_back(std::move(trash), std::move(future));
+    }
+
+    BackgroundDeleter::Leftovers BackgroundDeleter::delete_tree(const std::filesystem::path& path)
+    {
+        TraceSpan trace{"io", "delete tree", path};
+
+        ScanResult scan;
+        {
+            TraceSpan scan_trace{"io", "scan", path};
+            scan = DirectoryScanner{}.scan(path);
+        }
+        m_total.fetch_add(scan.files.size() + scan.dirs.size() + 1);
+
+        Leftovers leftovers;
+
+        // Files first, in parallel: deleting is one metadata round trip per file,
+        // which is what makes large trees slow
+        if (!scan.files.empty())
+        {
+            std::mutex failed_mutex;
+            std::atomic<size_t> next{0};
+            ThreadPool pool;
+            for (unsigned w = 0; w < pool.thread_count(); ++w)
+            {
+                pool.submit([&] {
+                    for (size_t i = next.fetch_add(1); i < scan.files.size(); i = next.fetch_add(1))
+                    {
+                        std::error_code ec;
+                        std::filesystem::remove(scan.files[i].path, ec);
+                        if (ec)
+                        {
+                            std::lock_guard lock{failed_mutex};
+                            leftovers.files.push_back(scan.files[i].path);
+                        }
+                        m_done.fetch_add(1);
+                    }
+                });
+            }
+            pool.wait_idle();
+        }
+
+        // Then directories, deepest first (depth counted once, not per comparison)
+        std::vector<std::pair<size_t, const std::filesystem::path*>> dirs;
+        dirs.reserve(scan.dirs.size());
+        for (const auto& dir : scan.dirs)
+            dirs.emplace_back(static_cast<size_t>(std::distance(dir.path.begin(), dir.path.end())), &dir.path);
+        std::sort(dirs.begin(), dirs.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        for (const auto& [depth, dir] : dirs)
+        {
+            std::error_code ec;
+            std::filesystem::remove(*dir, ec);
+            if (ec)
+                leftovers.dirs.push_back(*dir);
+            m_done.fetch_add(1);
+        }
+
+        // Subtrees the scan could not list are still there; the root removal fails with them
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        if (ec)
+            leftovers.dirs.push_back(path);
+        m_done.fetch_add(1);
+
+        std::sort(leftovers.files.begin(), leftovers.files.end());
+        return leftovers;
+    }
+
+    bool BackgroundDeleter::delete_leftovers(const std::filesystem::path& trash, const Leftovers& leftovers,
+                                             IActionCallback* cb, std::atomic<bool>& skip_all)
+    {
+        for (const auto& file : leftovers.files)
+        {
+            // Same handling as a locked file deleted in place (see CopyDirectoryAction::clean_files)
+            while (true)
+            {
+                std::error_code ec;
+                std::filesystem::remove(file, ec);
+                if (!ec)
+                    break;
+
+                if (skip_all || !cb)
+                {
+                    spdlog::warn("BackgroundDeleter: cannot delete {}: {}", file.string(), ec.message());
+                    break;
+                }
+
+                auto decision = cb->on_error("Failed to delete file", (file.string() + ": " + ec.message()).c_str());
+                switch (decision)
+                {
+                case IActionCallback::Decision::Retry:
+                    continue;
+                case IActionCallback::Decision::Skip:
+                case IActionCallback::Decision::Continue:
+                    break;
+                case IActionCallback::Decision::SkipAll:
+                    skip_all = true;
+                    break;
+                case IActionCallback::Decision::Abort:
+                default:
+                    return false;
+                }
+                break;
+            }
+        }
+
+        size_t remaining = 0;
+        for (const auto& dir : leftovers.dirs)
+        {
+            std::error_code ec;
+            std::filesystem::remove(dir, ec);
+            if (ec)
+                ++remaining;
+        }
+        if (remaining > 0)
+            spdlog::info("BackgroundDeleter: {} directories left in {}, deleted by the next clean", remaining, trash.string());
+        return true;
+    }
+
+    bool BackgroundDeleter::wait(ProgressTracker& progress, IActionCallback* cb, std::atomic<bool>& skip_all)
+    {
+        std::vector<std::pair<std::filesystem::path, std::future<Leftovers>>> pending;
+        {
+            std::lock_guard lock{m_mutex};
+            pending.swap(m_pending);
+        }
+
+        // Workers count what they find and delete; the tracker gets the difference since the last look
+        uint64_t reported_total = 0;
+        uint64_t reported_done = 0;
+        const auto report = [&] {
+            const uint64_t total = m_total.load();
+            const uint64_t done = m_done.load();
+            progress.expect({0, total - reported_total});
+            progress.advance(0, done - reported_done, "Removing old files");
+            reported_total = total;
+            reported_done = done;
+        };
+
+        bool ok = true;
+        for (auto& [trash, future] : pending)
+        {
+            while (future.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready)
+                report();
+            report();
+
+            // After an abort the remaining trees are still waited for, but not retried
+            const Leftovers leftovers = future.get();
+            if (ok && (!leftovers.files.empty() || !leftovers.dirs.empty()))
+                ok = delete_leftovers(trash, leftovers, cb, skip_all);
+        }
+        return ok;
+    }
+
+} // namespace insti
@@ -0,0 +1,727 @@
+#include "pch.h"
+#include <insti/core/benchmark.h>
+#include <insti/core/action_callback.h>
+#include <insti/core/instance.h>
+#include <insti/core/orchestrator.h>
+#include <insti/core/project.h>
+#include <insti/registry/blueprint_cache.h>
+#include <insti/registry/snapshot_registry.h>
+#include <insti/snapshot/zip_reader.h>
+#include <insti/snapshot/zip_writer.h>
+#include <insti/insti.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <system_error>
+
+namespace insti
+{
+
+    namespace
+    {
+        /// Fixed seed: every run generates the same bytes.
+        constexpr uint64_t SEED = 0x696e737469ull;
+
+        using Clock = std::chrono::steady_clock;
+
+        /// Scaled count or size, at least 1.
+        uint64_t scaled(uint64_t value, double scale)
+        {
+            return std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(value) * scale));
+        }
+
+        /// Fill data with text-like content that deflates roughly like config and source files.
+        void fill_text(std::vector<char>& data, std::mt19937_64& rng)
+        {
+            static constexpr std::string_view WORDS[] = {
+                "setting", "value", "enabled", "true", "false", "path", "user", "server",
+                "timeout", "=", "0", "1", "42", "<entry>", "</entry>", "# comment", "\r\n",
+            };
+            size_t pos = 0;
+            while (pos < data.size())
+            {
+                const auto& word = WORDS[rng() % std::size(WORDS)];
+                const size_t n = std::min(word.size(), data.size() - pos);
+                std::copy_n(word.data(), n, data.data() + pos);
+                pos += n;
+                if (pos < data.size())
+                    data[pos++] = ' ';
+            }
+        }
+
+        void fill_random(std::vector<char>& data, std::mt19937_64& rng)
+        {
+            size_t pos = 0;
+            while (pos < data.size())
+            {
+                const uint64_t word = rng();
+                const size_t n = std::min(sizeof(word), data.size() - pos);
+                std::memcpy(data.data() + pos, &word, n);
+                pos += n;
+            }
+        }
+
+        bool write_file(const std::filesystem::path& path, const std::vector<char>& data, GeneratedData& generated)
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out || !out.write(data.data(), static_cast<std::streamsize>(data.size())))
+            {
+                spdlog::error("benchmark: failed to write {}", path.string());
+                return false;
+            }
+            generated.bytes += data.size();
+            ++generated.files;
+            return true;
+        }
+
+        bool create_directory(const std::filesystem::path& path, GeneratedData& generated)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(path, ec);
+            if (ec)
+            {
+                spdlog::error("benchmark: failed to create {}: {}", path.string(), ec.message());
+                return false;
+            }
+            ++generated.directories;
+            return true;
+        }
+
+        std::string xml_escape(std::string_view text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            for (const char c : text)
+            {
+                switch (c)
+                {
+                case '&': out += "&amp;"; break;
+                case '<': out += "&lt;"; break;
+                case '>': out += "&gt;"; break;
+                case '"': out += "&quot;"; break;
+                default: out += c; break;
+                }
+            }
+            return out;
+        }
+
+        std::string json_escape(std::string_view text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            for (const char c : text)
+            {
+                switch (c)
+                {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        out += std::format("\\u{:04x}", static_cast<unsigned>(c));
+                    else
+                        out += c;
+                    break;
+                }
+            }
+            return out;
+        }
+
+        /// Project blueprint backing up one directory.
+        std::string directory_blueprint(std::string_view name, const std::filesystem::path& dir)
+        {
+            return std::format(
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<blueprint name=\"{}\" version=\"1.0\">\n"
+                "    <description>insti benchmark data</description>\n"
+                "    <resources>\n"
+                "        <files path=\"{}\" archive=\"files\"/>\n"
+                "    </resources>\n"
+                "</blueprint>\n",
+                xml_escape(name), xml_escape(dir.string()));
+        }
+
+        double elapsed_ms(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        void remove_all(const std::filesystem::path& path)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(path, ec);
+        }
+
+        /// Points the blueprint cache of every registry at a database in the work
+        /// directory while the benchmark runs, so the user's cache.db is left alone.
+        class ScopedBenchmarkCache final
+        {
+            PNQ_DECLARE_NON_COPYABLE(ScopedBenchmarkCache)
+
+        public:
+            explicit ScopedBenchmarkCache(const std::filesystem::path& work_dir)
+            {
+                BlueprintCache::set_default_path((work_dir / "cache.db").string());
+            }
+
+            ~ScopedBenchmarkCache()
+            {
+                BlueprintCache::set_default_path({});
+            }
+        };
+    } // anonymous namespace
+
+    std::string_view tree_shape_name(TreeShape shape)
+    {
+        switch (shape)
+        {
+        case TreeShape::SmallFiles: return "small_files";
+        case TreeShape::LargeFiles: return "large_files";
+        case TreeShape::DeepNesting: return "deep_nesting";
+        case TreeShape::Incompressible: return "incompressible";
+        }
+        return "unknown";
+    }
+
+    // =========================================================================
+    // BenchmarkResult
+    // =========================================================================
+
+    double BenchmarkResult::min_ms() const
+    {
+        return samples.empty() ? 0.0 : *std::min_element(samples.begin(), samples.end());
+    }
+
+    double BenchmarkResult::median_ms() const
+    {
+        if (samples.empty())
+            return 0.0;
+        std::vector<double> sorted{samples};
+        std::sort(sorted.begin(), sorted.end());
+        const size_t mid = sorted.size() / 2;
+        return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+    }
+
+    double BenchmarkResult::mean_ms() const
+    {
+        return samples.empty() ? 0.0 : std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    }
+
+    double BenchmarkResult::max_ms() const
+    {
+        return samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+    }
+
+    // =========================================================================
+    // Generators
+    // =========================================================================
+
+    bool BenchmarkSuite::generate_tree(const std::filesystem::path& root, TreeShape shape, double scale,
+                                       GeneratedData& generated)
+    {
+        std::mt19937_64 rng{SEED + static_cast<uint64_t>(shape)};
+        std::vector<char> data;
+
+        if (!create_directory(root, generated))
+            return false;
+
+        switch (shape)
+        {
+        case TreeShape::SmallFiles:
+        {
+            // 1-16 KiB each, 100 per directory
+            const uint64_t count = scaled(20000, scale);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const auto dir = root / std::format("dir{:04}", i / 100);
+                if (i % 100 == 0 && !create_directory(dir, generated))
+                    return false;
+                data.resize(1024 + rng() % (15 * 1024));
+                fill_text(data, rng);
+                if (!write_file(dir / std::format("file{:06}.cfg", i), data, generated))
+                    return false;
+            }
+            break;
+        }
+        case TreeShape::LargeFiles:
+        {
+            // Written in 1 MiB pieces with the same content, so generation needs no big buffer
+            const uint64_t size = scaled(128ull * 1024 * 1024, scale);
+            data.resize(1024 * 1024);
+            fill_text(data, rng);
+            for (int i = 0; i < 4; ++i)
+            {
+                const auto path = root / std::format("large{}.dat", i);
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                for (uint64_t written = 0; out && written < size; written += data.size())
+                    out.write(data.data(), static_cast<std::streamsize>(std::min<uint64_t>(data.size(), size - written)));
+                if (!out)
+                {
+                    spdlog::error("benchmark: failed to write {}", path.string());
+                    return false;
+                }
+                generated.bytes += size;
+                ++generated.files;
+            }
+            break;
+        }
+        case TreeShape::DeepNesting:
+        {
+            // Chains of 20 levels; short names keep the deepest paths well below MAX_PATH
+            const uint64_t chains = scaled(200, scale);
+            for (uint64_t chain = 0; chain < chains; ++chain)
+            {
+                auto dir = root / std::format("c{:03}", chain);
+                for (int level = 0; level < 20; ++level)
+                {
+                    dir /= std::format("d{:02}", level);
+                    if (!create_directory(dir, generated))
+                        return false;
+                    data.resize(512 + rng() % 1024);
+                    fill_text(data, rng);
+                    if (!write_file(dir / "leaf.ini", data, generated))
+                        return false;
+                }
+            }
+            break;
+        }
+        case TreeShape::Incompressible:
+        {
+            const uint64_t count = scaled(2000, scale);
+            data.resize(64 * 1024);
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                const auto dir = root / std::format("dir{:03}", i / 100);
+                if (i % 100 == 0 && !create_directory(dir, generated))
+                    return false;
+                fill_random(data, rng);
+                if (!write_file(dir / std::format("blob{:05}.bin", i), data, generated))
+                    return false;
+            }
+            break;
+        }
+        }
+
+        spdlog::info("benchmark: generated {} ({} files, {} bytes)", root.string(), generated.files, generated.bytes);
+        return true;
+    }
+
+    bool BenchmarkSuite::generate_snapshot(const std::filesystem::path& path, std::string_view project_name,
+                                           size_t entry_count, size_t entry_size, GeneratedData& generated)
+    {
+        Project* project = Project::load_from_string(
+            directory_blueprint(project_name, path.parent_path() / project_name), path.string());
+        if (!project)
+            return false;
+
+        const std::string xml = project->to_instance_xml(std::chrono::system_clock::now(), "benchmark", "benchmark",
+                                                         "Synthetic snapshot");
+        project->release(REFCOUNT_DEBUG_ARGS);
+
+        std::mt19937_64 rng{SEED + entry_count};
+        std::vector<char> text(entry_size);
+        std::vector<uint8_t> data(entry_size);
+
+        ZipSnapshotWriter writer;
+        writer.set_thread_count(ZipSnapshotWriter::THREADS_AUTO);
+        bool ok = writer.create(path.string());
+        for (size_t i = 0; ok && i < entry_count; ++i)
+        {
+            fill_text(text, rng);
+            std::copy(text.begin(), text.end(), data.begin());
+            ok = writer.write_binary(std::format("files/dir{:04}/file{:06}.cfg", i / 100, i), data);
+            generated.bytes += entry_size;
+            ++generated.files;
+        }
+        ok = ok && writer.write_text("blueprint.xml", xml) && writer.finalize();
+        if (!ok)
+        {
+            spdlog::error("benchmark: failed to write snapshot {}", path.string());
+            writer.close();
+            return false;
+        }
+        return true;
+    }
+
+    // =========================================================================
+    // BenchmarkSuite
+    // =========================================================================
+
+    BenchmarkSuite::BenchmarkSuite(Options options)
+        : m_options{std::move(options)}
+    {
+        m_options.iterations = std::max<uint32_t>(1, m_options.iterations);
+    }
+
+    bool BenchmarkSuite::selected(std::string_view name) const
+    {
+        return m_options.filter.empty() || name.find(m_options.filter) != std::string_view::npos;
+    }
+
+    bool BenchmarkSuite::run(IActionCallback* cb)
+    {
+        m_results.clear();
+
+        GeneratedData unused;
+        if (!create_directory(m_options.work_dir / "snapshots", unused))
+            return false;
+
+        // Registry roots (and their .insti-index files) are below work_dir as well
+        ScopedBenchmarkCache cache{m_options.work_dir};
+
+        const size_t steps = m_options.shapes.size() + 3;
+        size_t step = 0;
+        const auto report = [&](std::string_view detail) {
+            if (cb)
+                cb->on_progress("Benchmark", detail, static_cast<int>(step++ * 100 / steps));
+        };
+
+        bool ok = true;
+        for (const auto shape : m_options.shapes)
+        {
+            report(tree_shape_name(shape));
+            ok = ok && run_copy_directory(shape);
+        }
+
+        report("snapshot_reader");
+        ok = ok && run_snapshot_reader();
+        report("unresolve");
+        ok = ok && run_unresolve();
+        report("registry");
+        ok = ok && run_registry();
+
+        if (cb)
+            cb->on_progress("Benchmark", "Complete", 100);
+
+        if (!m_options.keep_data)
+            remove_all(m_options.work_dir);
+        return ok;
+    }
+
+    bool BenchmarkSuite::run_copy_directory(TreeShape shape)
+    {
+        const std::string dataset{tree_shape_name(shape)};
+        const char* const operations[] = {"copy_directory.backup", "copy_directory.clean",
+                                          "copy_directory.restore", "copy_directory.verify"};
+        if (std::none_of(std::begin(operations), std::end(operations), [this](const char* op) { return selected(op); }))
+            return true;
+
+        GeneratedData generated;
+        const auto tree = m_options.work_dir / "trees" / dataset;
+        remove_all(tree);
+        if (!generate_tree(tree, shape, m_options.scale, generated))
+            return false;
+
+        const auto archive = m_options.work_dir / "snapshots" / std::format("bench-{}.zip", dataset);
+        Project* project = Project::load_from_string(directory_blueprint("bench-" + dataset, tree), tree.string());
+        if (!project)
+            return false;
+
+        SnapshotRegistry registry{std::vector<std::string>{(m_options.work_dir / "snapshots").string()}};
+        Orchestrator orchestrator{&registry};
+        NullCallback silent;
+
+        const auto make_result = [&](const char* name) {
+            BenchmarkResult result;
+            result.name = name;
+            result.dataset = dataset;
+            result.bytes = generated.bytes;
+            result.items = generated.files;
+            return result;
+        };
+
+        // Backup; the last archive is kept for the other operations
+        BenchmarkResult backup = make_result("copy_directory.backup");
+        bool ok = true;
+        for (uint32_t i = 0; ok && i < m_options.iterations; ++i)
+        {
+            remove_all(archive);
+            const auto start = Clock::now();
+            ok = orchestrator.backup(project, archive.string(), &silent);
+            backup.samples.push_back(elapsed_ms(start));
+        }
+        project->release(REFCOUNT_DEBUG_ARGS);
+        if (!ok)
+        {
+            spdlog::error("benchmark: backup of {} failed", dataset);
+            return false;
+        }
+        if (selected(backup.name))
+            m_results.push_back(std::move(backup));
+
+        Instance* instance = Instance::load_from_archive(archive.string());
+        if (!instance)
+            return false;
+
+        // Clean and restore alternate, so every clean removes a full tree and
+        // every restore starts from none
+        BenchmarkResult clean = make_result("copy_directory.clean");
+        BenchmarkResult restore = make_result("copy_directory.restore");
+        for (uint32_t i = 0; ok && i < m_options.iterations; ++i)
+        {
+            auto start = Clock::now();
+            ok = orchestrator.clean(instance, &silent);
+            clean.samples.push_back(elapsed_ms(start));
+
+            start = Clock::now();
+            ok = ok && orchestrator.restore(instance, archive.string(), &silent);
+            restore.samples.push_back(elapsed_ms(start));
+        }
+
+        // Full verify hashes every file; fast verify trusts size and modification time
+        BenchmarkResult verify = make_result("copy_directory.verify");
+        BenchmarkResult verify_fast = make_result("copy_directory.verify");
+        verify_fast.dataset += ".fast";
+        ZipSnapshotReader reader;
+        ok = ok && reader.open(archive.string());
+        for (uint32_t i = 0; ok && i < m_options.iterations; ++i)
+        {
+            for (auto* result : {&verify, &verify_fast})
+            {
+                const auto start = Clock::now();
+                const auto verified = orchestrator.verify(instance, nullptr, &reader, result == &verify_fast);
+                result->samples.push_back(elapsed_ms(start));
+
+                // A restored tree that does not verify means the timings measured the wrong thing
+                if (!std::all_of(verified.begin(), verified.end(),
+                                 [](const VerifyResult& r) { return r.status == VerifyResult::Status::Match; }))
+                    ok = false;
+            }
+        }
+        reader.close();
+        instance->release(REFCOUNT_DEBUG_ARGS);
+
+        if (!ok)
+        {
+            spdlog::error("benchmark: clean/restore/verify of {} failed", dataset);
+            return false;
+        }
+        for (auto* result : {&clean, &restore, &verify, &verify_fast})
+        {
+            if (selected(result->name))
+                m_results.push_back(std::move(*result));
+        }
+
+        if (!m_options.keep_data)
+        {
+            remove_all(tree);
+            remove_all(archive);
+        }
+        return true;
+    }
+
+    bool BenchmarkSuite::run_snapshot_reader()
+    {
+        if (!selected("snapshot_reader.open") && !selected("snapshot_reader.lookup"))
+            return true;
+
+        GeneratedData generated;
+        const auto archive = m_options.work_dir / "snapshots" / "bench-reader.zip";
+        if (!generate_snapshot(archive, "bench-reader", scaled(50000, m_options.scale), 256, generated))
+            return false;
+
+        // Open includes building the path index, as the first lookup would
+        BenchmarkResult open;
+        open.name = "snapshot_reader.open";
+        open.dataset = "entries";
+        open.bytes = generated.bytes;
+        open.items = generated.files;
+
+        std::vector<std::string> paths;
+        for (uint32_t i = 0; i < m_options.iterations; ++i)
+        {
+            ZipSnapshotReader reader;
+            const auto start = Clock::now();
+            if (!reader.open(archive.string()))
+                return false;
+            const auto& entries = reader.all_entries();
+            open.samples.push_back(elapsed_ms(start));
+
+            if (paths.empty())
+            {
+                for (const auto& entry : entries)
+                    paths.push_back(entry.path);
+            }
+            reader.close();
+        }
+
+        // Lookups in random order, plus as many misses
+        std::mt19937_64 rng{SEED};
+        std::shuffle(paths.begin(), paths.end(), rng);
+        const size_t hits = paths.size();
+        for (size_t i = 0; i < hits; ++i)
+            paths.push_back(std::format("files/missing{:06}/file.cfg", i));
+
+        BenchmarkResult lookup;
+        lookup.name = "snapshot_reader.lookup";
+        lookup.dataset = "entries";
+        lookup.items = paths.size();
+
+        ZipSnapshotReader reader;
+        if (!reader.open(archive.string()))
+            return false;
+        reader.all_entries();
+        for (uint32_t i = 0; i < m_options.iterations; ++i)
+        {
+            size_t found = 0;
+            const auto start = Clock::now();
+            for (const auto& path : paths)
+                found += reader.find_entry(path) != nullptr;
+            lookup.samples.push_back(elapsed_ms(start));
+
+            if (found != hits)
+            {
+                spdlog::error("benchmark: found {} of {} snapshot entries", found, hits);
+                return false;
+            }
+        }
+        reader.close();
+
+        for (auto* result : {&open, &lookup})
+        {
+            if (selected(result->name))
+                m_results.push_back(std::move(*result));
+        }
+        if (!m_options.keep_data)
+            remove_all(archive);
+        return true;
+    }
+
+    bool BenchmarkSuite::run_unresolve()
+    {
+        if (!selected("blueprint.unresolve"))
+            return true;
+
+        const auto dir = m_options.work_dir / "trees" / "unresolve";
+        Project* project = Project::load_from_string(directory_blueprint("bench-unresolve", dir), dir.string());
+        if (!project)
+            return false;
+
+        // Text as substitute hooks see it: config lines, a fifth of them mentioning a resolved path
+        std::vector<std::string_view> values;
+        for (const auto& [name, value] : project->resolved_variables())
+        {
+            if (value.size() >= 3)
+                values.push_back(value);
+        }
+        std::sort(values.begin(), values.end());
+
+        std::string input;
+        const uint64_t target = scaled(8ull * 1024 * 1024, m_options.scale);
+        for (size_t line = 0; input.size() < target; ++line)
+        {
+            if (line % 5 == 0 && !values.empty())
+                input += std::format("path{}={}\\data\\file{}.dat\r\n", line, values[line / 5 % values.size()], line);
+            else
+                input += std::format("setting{}=value {} enabled timeout 30\r\n", line, line);
+        }
+
+        BenchmarkResult result;
+        result.name = "blueprint.unresolve";
+        result.dataset = std::format("{}_variables", values.size());
+        result.bytes = input.size();
+        result.items = 1;
+        for (uint32_t i = 0; i < m_options.iterations; ++i)
+        {
+            const auto start = Clock::now();
+            const std::string output = project->unresolve(input);
+            result.samples.push_back(elapsed_ms(start));
+        }
+        project->release(REFCOUNT_DEBUG_ARGS);
+
+        m_results.push_back(std::move(result));
+        return true;
+    }
+
+    bool BenchmarkSuite::run_registry()
+    {
+        if (!selected("snapshot_registry.initialize"))
+            return true;
+
+        // A root of its own, so leftovers of other benchmarks don't change the count
+        const auto root = m_options.work_dir / "registry";
+        GeneratedData generated;
+        if (!create_directory(root, generated))
+            return false;
+
+        const uint64_t count = scaled(200, m_options.scale);
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (!generate_snapshot(root / std::format("bench-registry{:04}.zip", i), std::format("bench-registry{:04}", i),
+                                   20, 1024, generated))
+                return false;
+        }
+
+        // The first sample is cold (blueprint cache empty for these files), the rest warm
+        BenchmarkResult result;
+        result.name = "snapshot_registry.initialize";
+        result.dataset = "snapshots";
+        result.bytes = generated.bytes;
+        result.items = count;
+        for (uint32_t i = 0; i < m_options.iterations; ++i)
+        {
+            SnapshotRegistry registry{std::vector<std::string>{root.string()}};
+            const auto start = Clock::now();
+            const bool ok = registry.initialize(SnapshotRegistry::WAIT_FOR_ALL);
+            result.samples.push_back(elapsed_ms(start));
+
+            if (!ok || registry.m_instances.size() != count)
+            {
+                spdlog::error("benchmark: registry found {} of {} snapshots", registry.m_instances.size(), count);
+                return false;
+            }
+        }
+        m_results.push_back(std::move(result));
+
+        if (!m_options.keep_data)
+            remove_all(root);
+        return true;
+    }
+
+    std::string BenchmarkSuite::to_json() const
+    {
+        const auto now = std::chrono::system_clock::now();
+
+        std::ostringstream out;
+        out << "{\n";
+        out << std::format("  \"insti_version\": \"{}\",\n", json_escape(version()));
+        out << std::format("  \"timestamp\": \"{:%Y-%m-%dT%H:%M:%SZ}\",\n",
+                           std::chrono::floor<std::chrono::seconds>(now));
+        out << std::format("  \"iterations\": {},\n", m_options.iterations);
+        out << std::format("  \"scale\": {},\n", m_options.scale);
+        out << "  \"results\": [";
+        for (size_t i = 0; i < m_results.size(); ++i)
+        {
+            const auto& r = m_results[i];
+            const double median_s = r.median_ms() / 1000.0;
+
+            std::string samples;
+            for (const double sample : r.samples)
+                samples += std::format("{}{:.3f}", samples.empty() ? "" : ", ", sample);
+
+            out << (i ? ",\n" : "\n");
+            out << "    {\n";
+            out << std::format("      \"name\": \"{}\",\n", json_escape(r.name));
+            out << std::format("      \"dataset\": \"{}\",\n", json_escape(r.dataset));
+            out << std::format("      \"bytes\": {},\n", r.bytes);
+            out << std::format("      \"items\": {},\n", r.items);
+            out << std::format("      \"min_ms\": {:.3f},\n", r.min_ms());
+            out << std::format("      \"median_ms\": {:.3f},\n", r.median_ms());
+            out << std::format("      \"mean_ms\": {:.3f},\n", r.mean_ms());
+            out << std::format("      \"max_ms\": {:.3f},\n", r.max_ms());
+            out << std::format("      \"bytes_per_second\": {:.0f},\n", median_s > 0.0 ? r.bytes / median_s : 0.0);
+            out << std::format("      \"samples_ms\": [{}]\n", samples);
+            out << "    }";
+        }
+        out << (m_results.empty() ? "]\n" : "\n  ]\n");
+        out << "}\n";
+        return out.str();
+    }
+
+} // namespace insti
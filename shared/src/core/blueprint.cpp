@@ -116,12 +116,10 @@ std::string Blueprint::resolve(std::string_view input) const
         .expand(input);
 }
 
-std::string Blueprint::unresolve(std::string_view input) const
+void Blueprint::compile_unresolver()
 {
-    // Build sorted list of variables by value length (longest first)
-    // This ensures we replace "C:\Program Files (x86)" before "C:\Program Files"
-    std::vector<std::pair<std::string, std::string>> sorted_vars;
-    sorted_vars.reserve(m_resolved_variables.size());
+    std::vector<std::pair<std::string, std::string>> patterns;
+    patterns.reserve(m_resolved_variables.size());
 
     for (const auto& [name, value] : m_resolved_variables)
     {
@@ -134,29 +132,21 @@ std::string Blueprint::unresolve(std::string_view input) const
         if (name == "SYSTEMDRIVE")
             continue;
 
-        sorted_vars.emplace_back(name, value);
+        patterns.emplace_back(value, "${" + name + "}");
     }
 
-    // Sort by value length descending
-    std::sort(sorted_vars.begin(), sorted_vars.end(),
-              [](const auto& a, const auto& b) { return a.second.length() > b.second.length(); });
-
-    std::string result{input};
-
-    for (const auto& [name, value] : sorted_vars)
-    {
-        std::string placeholder = "${" + name + "}";
+    // Variables sharing a value: the first one wins, so make that independent of hash order
+    std::sort(patterns.begin(), patterns.end(),
+              [](const auto& a, const auto& b) { return a.second < b.second; });
 
-        // Case-insensitive search and replace
-        size_t pos = 0;
-        while ((pos = pnq::string::find_nocase(result, value, pos)) != std::string::npos)
-        {
-            result.replace(pos, value.length(), placeholder);
-            pos += placeholder.length();
-        }
-    }
+    m_unresolver = MultiPatternReplacer{patterns};
+}
 
-    return result;
+std::string Blueprint::unresolve(std::string_view input) const
+{
+    // Leftmost-longest in one pass, so "C:\Program Files (x86)" is replaced
+    // as a whole before "C:\Program Files" could match
+    return m_unresolver.replace(input);
 }
 
 const std::string& Blueprint::get_var(std::string_view name) const
@@ -175,6 +165,7 @@ void Blueprint::set_override(std::string_view name, std::string_view value)
         .expand(value);
 
     m_resolved_variables[name.data()] = resolved;
+    compile_unresolver();
 }
 
 Blueprint* Blueprint::load_from_file(std::string_view path)
@@ -263,6 +254,7 @@ bool Blueprint::parse_xml(std::string_view xml)
     // Resolve user variables
     if (!resolve_user_variables())
         return false;
+    compile_unresolver();
 
     // Actions
     if (auto resources = root.child("resources"))
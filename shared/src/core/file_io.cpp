@@ -0,0 +1,180 @@
+#include "pch.h"
+#include <insti/core/file_io.h>
+#include <insti/core/file_time.h>
+#include <insti/core/thread_pool.h>
+#include <insti/core/trace.h>
+#include <algorithm>
+#include <system_error>
+
+namespace insti
+{
+
+    namespace
+    {
+
+        /// Largest single ReadFile()/WriteFile() call.
+        constexpr size_t MAX_CHUNK = 16 * 1024 * 1024;
+
+        std::string last_error_message()
+        {
+            return std::system_category().message(static_cast<int>(GetLastError()));
+        }
+    } // anonymous namespace
+
+    FileIo::Completion FileIo::read_file(const std::filesystem::path& path)
+    {
+        Completion result;
+
+        // Share like the C runtime does, so files open in other processes can still be read
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            result.error = last_error_message();
+            return result;
+        }
+
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size))
+        {
+            result.error = last_error_message();
+            CloseHandle(file);
+            return result;
+        }
+
+        // Sized from the open handle, not the (possibly stale) directory listing
+        result.data.resize(static_cast<size_t>(size.QuadPart));
+
+        size_t done = 0;
+        while (done < result.data.size())
+        {
+            DWORD got = 0;
+            const auto chunk = static_cast<DWORD>(std::min(result.data.size() - done, MAX_CHUNK));
+            if (!ReadFile(file, result.data.data() + done, chunk, &got, nullptr))
+            {
+                result.error = last_error_message();
+                break;
+            }
+            if (got == 0)
+                break;  // Truncated since GetFileSizeEx
+            done += got;
+        }
+        result.data.resize(done);
+
+        FILETIME write_time{};
+        if (GetFileTime(file, nullptr, nullptr, &write_time))
+            result.mtime = FileTime::to_time_t(write_time);
+        CloseHandle(file);
+
+        result.ok = result.error.empty();
+        return result;
+    }
+
+    std::string FileIo::write_file(const std::filesystem::path& path, std::span<const uint8_t> data, int64_t mtime)
+    {
+        if (path.has_parent_path())
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(path.parent_path(), ec);
+            // Ignore errors here - CreateFileW reports what matters
+        }
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return last_error_message();
+
+        // Reserve the final size up front, so the file is allocated once (best effort)
+        FILE_ALLOCATION_INFO allocation{};
+        allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(data.size());
+        SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+
+        std::string error;
+        size_t done = 0;
+        while (done < data.size())
+        {
+            DWORD written = 0;
+            const auto chunk = static_cast<DWORD>(std::min(data.size() - done, MAX_CHUNK));
+            if (!WriteFile(file, data.data() + done, chunk, &written, nullptr) || written == 0)
+            {
+                error = last_error_message();
+                break;
+            }
+            done += written;
+        }
+
+        if (error.empty() && mtime != 0)
+        {
+            const FILETIME write_time = FileTime::to_filetime(mtime);
+            SetFileTime(file, nullptr, &write_time, &write_time);
+        }
+        CloseHandle(file);
+        return error;
+    }
+
+    FileIo::Completion FileIo::execute(Request& request)
+    {
+        if (request.kind == Request::Kind::Read)
+        {
+            TraceSpan trace{"io", "read", request.path};
+            Completion result = read_file(request.path);
+            result.tag = request.tag;
+            return result;
+        }
+
+        TraceSpan trace{"io", "write", request.path};
+        Completion result;
+        result.tag = request.tag;
+        result.error = write_file(request.path, request.data, request.mtime);
+        result.ok = result.error.empty();
+        return result;
+    }
+
+    std::unique_ptr<FileIo> FileIo::create(unsigned queue_depth, ThreadPool* pool)
+    {
+        if (queue_depth <= 1)
+            return std::make_unique<BlockingFileIo>();
+        return std::make_unique<QueuedFileIo>(queue_depth, pool);
+    }
+
+    void BlockingFileIo::submit(Request request)
+    {
+        m_done.push_back(execute(request));
+    }
+
+    FileIo::Completion BlockingFileIo::complete()
+    {
+        Completion result = std::move(m_done.front());
+        m_done.pop_front();
+        return result;
+    }
+
+    QueuedFileIo::QueuedFileIo(unsigned queue_depth, ThreadPool* pool)
+        : FileIo{queue_depth}
+        , m_own_pool{pool ? nullptr : std::make_unique<ThreadPool>(queue_depth)}
+        , m_pool{pool ? pool : m_own_pool.get()}
+    {
+    }
+
+    QueuedFileIo::~QueuedFileIo()
+    {
+        // Requests reference nothing of the caller's, but writes must not be left half done
+        for (auto& future : m_in_flight)
+            future.wait();
+    }
+
+    void QueuedFileIo::submit(Request request)
+    {
+        m_in_flight.push_back(m_pool->submit([request = std::move(request)]() mutable {
+            return execute(request);
+        }));
+    }
+
+    FileIo::Completion QueuedFileIo::complete()
+    {
+        auto future = std::move(m_in_flight.front());
+        m_in_flight.pop_front();
+        return future.get();
+    }
+
+} // namespace insti
@@ -0,0 +1,34 @@
+#include "pch.h"
+#include <insti/core/file_time.h>
+#include <chrono>
+#include <system_error>
+
+namespace insti
+{
+
+    int64_t FileTime::to_time_t(const FILETIME& time)
+    {
+        const int64_t ticks = (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+        return ticks > UNIX_EPOCH_TICKS ? (ticks - UNIX_EPOCH_TICKS) / TICKS_PER_SECOND : 0;
+    }
+
+    int64_t FileTime::to_time_t(std::filesystem::file_time_type time)
+    {
+        return static_cast<int64_t>(std::chrono::system_clock::to_time_t(
+            std::chrono::clock_cast<std::chrono::system_clock>(time)));
+    }
+
+    FILETIME FileTime::to_filetime(int64_t time)
+    {
+        const int64_t ticks = time * TICKS_PER_SECOND + UNIX_EPOCH_TICKS;
+        return FILETIME{static_cast<DWORD>(ticks), static_cast<DWORD>(ticks >> 32)};
+    }
+
+    int64_t FileTime::last_write_time(const std::filesystem::path& path)
+    {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(path, ec);
+        return ec ? 0 : to_time_t(time);
+    }
+
+} // namespace insti
@@ -0,0 +1,227 @@
+#include "pch.h"
+#include <insti/core/glob.h>
+
+namespace insti
+{
+
+    namespace
+    {
+        /// Lowercase (ASCII) and turn backslashes into forward slashes.
+        std::string normalize(std::string_view text)
+        {
+            std::string result{text};
+            for (char& c : result)
+            {
+                if (c == '\\')
+                    c = '/';
+                else
+                    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            return result;
+        }
+
+        bool has_wildcard(std::string_view text)
+        {
+            return text.find_first_of("*?") != std::string_view::npos;
+        }
+
+        std::string_view filename_of(std::string_view path)
+        {
+            const size_t slash = path.rfind('/');
+            return slash == std::string_view::npos ? path : path.substr(slash + 1);
+        }
+
+        constexpr std::string_view GLOBSTAR = "**";
+    } // anonymous namespace
+
+    GlobPattern::GlobPattern(std::string_view pattern)
+    {
+        std::string normalized = normalize(pattern);
+        if (normalized.find('/') == std::string::npos)
+        {
+            m_segments.push_back(std::move(normalized));
+            return;
+        }
+
+        // "dir/" means everything below dir
+        if (normalized.back() == '/')
+            normalized += GLOBSTAR;
+
+        m_path_pattern = true;
+        size_t start = 0;
+        while (start <= normalized.size())
+        {
+            size_t end = normalized.find('/', start);
+            if (end == std::string::npos)
+                end = normalized.size();
+
+            std::string segment = normalized.substr(start, end - start);
+            // Skip empty segments (leading '/' anchors to the root anyway) and repeated globstars
+            const bool repeated = segment == GLOBSTAR && !m_segments.empty() && m_segments.back() == GLOBSTAR;
+            if (!segment.empty() && !repeated)
+                m_segments.push_back(std::move(segment));
+            start = end + 1;
+        }
+    }
+
+    bool GlobPattern::is_literal() const
+    {
+        for (const auto& segment : m_segments)
+        {
+            if (has_wildcard(segment))
+                return false;
+        }
+        return true;
+    }
+
+    bool GlobPattern::match_segment(std::string_view pattern, std::string_view text)
+    {
+        size_t p = 0, t = 0;
+        size_t star_p = std::string_view::npos;
+        size_t star_t = 0;
+
+        while (t < text.size())
+        {
+            if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t]))
+            {
+                ++p;
+                ++t;
+            }
+            else if (p < pattern.size() && pattern[p] == '*')
+            {
+                star_p = p++;
+                star_t = t;
+            }
+            else if (star_p != std::string_view::npos)
+            {
+                p = star_p + 1;
+                t = ++star_t;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (p < pattern.size() && pattern[p] == '*')
+            ++p;
+
+        return p == pattern.size();
+    }
+
+    bool GlobPattern::matches(std::string_view rel_path) const
+    {
+        return matches_normalized(normalize(rel_path));
+    }
+
+    bool GlobPattern::matches_normalized(std::string_view path) const
+    {
+        if (!m_path_pattern)
+            return match_segment(m_segments.front(), filename_of(path));
+
+        std::vector<std::string_view> text;
+        size_t start = 0;
+        while (start <= path.size())
+        {
+            size_t end = path.find('/', start);
+            if (end == std::string_view::npos)
+                end = path.size();
+            if (end > start)
+                text.push_back(path.substr(start, end - start));
+            start = end + 1;
+        }
+
+        // Same backtracking as match_segment, one level up: "**" plays the role of '*'
+        // and whole segments the role of characters
+        size_t p = 0, t = 0;
+        size_t star_p = std::string_view::npos;
+        size_t star_t = 0;
+
+        while (t < text.size())
+        {
+            if (p < m_segments.size() && m_segments[p] == GLOBSTAR)
+            {
+                star_p = p++;
+                star_t = t;
+            }
+            else if (p < m_segments.size() && match_segment(m_segments[p], text[t]))
+            {
+                ++p;
+                ++t;
+            }
+            else if (star_p != std::string_view::npos)
+            {
+                p = star_p + 1;
+                t = ++star_t;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        while (p < m_segments.size() && m_segments[p] == GLOBSTAR)
+            ++p;
+
+        return p == m_segments.size();
+    }
+
+    GlobSet::GlobSet(const std::vector<std::string>& patterns)
+    {
+        for (const auto& pattern : patterns)
+            add(pattern);
+    }
+
+    void GlobSet::add(std::string_view pattern)
+    {
+        GlobPattern glob{pattern};
+        ++m_count;
+
+        if (!glob.is_path_pattern())
+        {
+            const std::string& name = glob.segments().front();
+            if (!has_wildcard(name))
+            {
+                m_names.insert(name);
+                return;
+            }
+
+            // "*.ext" with a plain extension: hash lookup on the file's last extension
+            if (name.size() > 2 && name.starts_with("*.") &&
+                name.find_first_of("*?.", 2) == std::string::npos)
+            {
+                m_extensions.insert(name.substr(2));
+                return;
+            }
+        }
+
+        m_patterns.push_back(std::move(glob));
+    }
+
+    bool GlobSet::matches(std::string_view rel_path) const
+    {
+        if (m_count == 0)
+            return false;
+
+        const std::string path = normalize(rel_path);
+        const std::string_view filename = filename_of(path);
+
+        if (!m_names.empty() && m_names.contains(std::string{filename}))
+            return true;
+
+        if (!m_extensions.empty())
+        {
+            const size_t dot = filename.rfind('.');
+            if (dot != std::string_view::npos && m_extensions.contains(std::string{filename.substr(dot + 1)}))
+                return true;
+        }
+
+        for (const auto& pattern : m_patterns)
+        {
+            if (pattern.matches_normalized(path))
+                return true;
+        }
+        return false;
+    }
+
+} // namespace insti
@@ -44,8 +44,9 @@ namespace insti
 	{
 		std::string path_str{ zip_path };
 
-		// Open the archive
+		// Open the archive (mapped if local: the registry opens every snapshot just to read blueprint.xml)
 		auto reader = new ZipSnapshotReader();
+		reader->set_memory_mapped(true);
 		if (!reader->open(path_str))
 		{
 			spdlog::error("Failed to open archive: {}", zip_path);
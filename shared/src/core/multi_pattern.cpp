@@ -0,0 +1,217 @@
+#include "pch.h"
+#include <insti/core/multi_pattern.h>
+#include <algorithm>
+#include <deque>
+
+namespace insti
+{
+
+    namespace
+    {
+        unsigned char fold(unsigned char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+        }
+
+        /// Transition not (yet) defined while the trie is built.
+        constexpr uint32_t NO_STATE = UINT32_MAX;
+    } // anonymous namespace
+
+    MultiPatternReplacer::MultiPatternReplacer()
+        : m_states(1)
+        , m_delta(1, ROOT)
+    {
+    }
+
+    MultiPatternReplacer::MultiPatternReplacer(const std::vector<std::pair<std::string, std::string>>& patterns)
+    {
+        // Alphabet: one class per distinct (folded) byte in the patterns. Upper- and
+        // lowercase letters share a class, so matching needs no case conversion.
+        for (const auto& [pattern, replacement] : patterns)
+        {
+            for (const char ch : pattern)
+            {
+                const unsigned char c = fold(static_cast<unsigned char>(ch));
+                if (m_class[c] == 0)
+                    m_class[c] = static_cast<uint8_t>(m_class_count++);
+            }
+        }
+        for (unsigned char c = 'A'; c <= 'Z'; ++c)
+            m_class[c] = m_class[fold(c)];
+
+        // Trie
+        m_states.emplace_back();
+        m_delta.assign(m_class_count, NO_STATE);
+        for (const auto& [pattern, replacement] : patterns)
+        {
+            if (pattern.empty())
+                continue;
+
+            StateId state = ROOT;
+            for (const char ch : pattern)
+            {
+                StateId& target = m_delta[state * m_class_count + m_class[static_cast<unsigned char>(ch)]];
+                if (target == NO_STATE)
+                {
+                    target = static_cast<StateId>(m_states.size());
+                    m_states.push_back({m_states[state].depth + 1, NO_MATCH, 0});
+                    m_delta.resize(m_delta.size() + m_class_count, NO_STATE);
+                }
+                state = m_delta[state * m_class_count + m_class[static_cast<unsigned char>(ch)]];
+            }
+
+            if (m_states[state].match == NO_MATCH)
+            {
+                m_states[state].match = static_cast<uint32_t>(m_replacements.size());
+                m_states[state].match_length = static_cast<uint32_t>(pattern.size());
+                m_replacements.push_back(replacement);
+            }
+        }
+
+        // Suffix links, breadth-first: every missing transition takes the one of the
+        // longest proper suffix, which turns the trie into a complete automaton
+        std::vector<StateId> fail(m_states.size(), ROOT);
+        std::deque<StateId> queue;
+        for (uint32_t c = 0; c < m_class_count; ++c)
+        {
+            StateId& target = m_delta[c];
+            if (target == NO_STATE)
+                target = ROOT;
+            else
+                queue.push_back(target);
+        }
+
+        while (!queue.empty())
+        {
+            const StateId state = queue.front();
+            queue.pop_front();
+
+            // A suffix match is shorter than the state's own, so only inherit if there is none
+            State& s = m_states[state];
+            if (s.match == NO_MATCH)
+            {
+                s.match = m_states[fail[state]].match;
+                s.match_length = m_states[fail[state]].match_length;
+            }
+
+            for (uint32_t c = 0; c < m_class_count; ++c)
+            {
+                StateId& target = m_delta[state * m_class_count + c];
+                const StateId fallback = m_delta[fail[state] * m_class_count + c];
+                if (target == NO_STATE)
+                {
+                    target = fallback;
+                }
+                else
+                {
+                    fail[target] = fallback;
+                    queue.push_back(target);
+                }
+            }
+        }
+    }
+
+    std::string MultiPatternReplacer::replace(std::string_view input) const
+    {
+        if (empty())
+            return std::string{input};
+
+        std::string result;
+        result.reserve(input.size());
+        size_t replacements = 0;
+        replace_into(input, true, result, replacements);
+        return result;
+    }
+
+    size_t MultiPatternReplacer::replace_into(std::string_view input, bool final, std::string& out,
+                                              size_t& replacements) const
+    {
+        size_t copied = 0;   // input[0, copied) has been emitted
+        size_t pos = 0;      // Next byte to feed the automaton
+        StateId state = ROOT;
+
+        // Best match found so far that is not emitted yet
+        uint32_t match = NO_MATCH;
+        size_t match_start = 0;
+        size_t match_length = 0;
+
+        while (true)
+        {
+            if (pos < input.size())
+            {
+                state = next(state, static_cast<unsigned char>(input[pos++]));
+                const State& s = m_states[state];
+
+                if (s.match != NO_MATCH)
+                {
+                    const size_t start = pos - s.match_length;
+                    if (match == NO_MATCH || start < match_start ||
+                        (start == match_start && s.match_length > match_length))
+                    {
+                        match = s.match;
+                        match_start = start;
+                        match_length = s.match_length;
+                    }
+                }
+
+                // Any later match starts at pos - depth or after; keep going while
+                // one could still start at or before the pending match
+                if (match == NO_MATCH || pos - s.depth <= match_start)
+                    continue;
+            }
+            else if (!final)
+            {
+                // More input follows: keep back what the next chunk could still extend
+                size_t safe = pos - m_states[state].depth;
+                if (match != NO_MATCH)
+                    safe = std::min(safe, match_start);
+                out.append(input, copied, safe - copied);
+                return safe;
+            }
+            else if (match == NO_MATCH)
+            {
+                break;
+            }
+
+            // Emit the pending match and resume right behind it (rescans less than
+            // one pattern length, so the pass stays linear)
+            out.append(input, copied, match_start - copied);
+            out += m_replacements[match];
+            ++replacements;
+            copied = pos = match_start + match_length;
+            state = ROOT;
+            match = NO_MATCH;
+        }
+
+        out.append(input, copied);
+        return input.size();
+    }
+
+    void MultiPatternReplacer::Stream::write(std::string_view chunk, std::string& out)
+    {
+        if (m_replacer.empty())
+        {
+            out += chunk;
+            return;
+        }
+
+        if (m_carry.empty())
+        {
+            const size_t consumed = m_replacer.replace_into(chunk, false, out, m_replacements);
+            m_carry.assign(chunk.substr(consumed));
+            return;
+        }
+
+        m_carry += chunk;
+        const size_t consumed = m_replacer.replace_into(m_carry, false, out, m_replacements);
+        m_carry.erase(0, consumed);
+    }
+
+    void MultiPatternReplacer::Stream::finish(std::string& out)
+    {
+        if (!m_carry.empty())
+            m_replacer.replace_into(m_carry, true, out, m_replacements);
+        m_carry.clear();
+    }
+
+} // namespace insti
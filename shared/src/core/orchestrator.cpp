@@ -1,5 +1,10 @@
 #include "pch.h"
 #include <insti/insti.h>
+#include <insti/core/action_scheduler.h>
+#include <insti/core/background_deleter.h>
+#include <insti/core/file_io.h>
+#include <insti/core/thread_pool.h>
+#include <insti/core/trace.h>
 
 namespace insti
 {
@@ -7,6 +12,33 @@ namespace insti
 	namespace
 	{
 
+		/// Actions in blueprint order, or reversed (clean undoes in reverse).
+		std::vector<const IAction*> ordered(const pnq::RefCountedVector<IAction*>& actions, bool reverse = false)
+		{
+			std::vector<const IAction*> result;
+			result.reserve(actions.size());
+			for (const auto* action : actions)
+				result.push_back(action);
+			if (reverse)
+				std::reverse(result.begin(), result.end());
+			return result;
+		}
+
+		/// Size up all actions before running them, so progress spans the whole operation.
+		/// Work only known once an action runs (a backup's tree) is added by the action.
+		void plan_progress(const pnq::RefCountedVector<IAction*>& actions, ActionContext* ctx)
+		{
+			ProgressEstimate total;
+			for (const auto* action : actions)
+			{
+				const auto estimate = action->estimate(ctx);
+				total.bytes += estimate.bytes;
+				total.items += estimate.items;
+			}
+			spdlog::info("{} files, {} bytes to process", total.items, total.bytes);
+			ctx->progress().plan(total);
+		}
+
 		/// Run lifecycle hooks (startup or shutdown).
 		/// @param hooks Vector of hooks to execute
 		/// @param lifecycle_name Name for progress reporting ("Startup" or "Shutdown")
@@ -26,6 +58,7 @@ namespace insti
 			if (hooks.empty())
 				return true;
 
+			TraceSpan trace{"phase", lifecycle_name};
 			for (auto* hook : hooks)
 			{
 				// Skip force-only hooks unless force is enabled
@@ -35,7 +68,12 @@ namespace insti
 				if (cb)
 					cb->on_progress(lifecycle_name, hook->type_name(), -1);
 
-				if (!hook->execute(vars))
+				bool executed;
+				{
+					TraceSpan hook_trace{"hook", "hook", hook->name().empty() ? hook->type_name() : hook->type_name() + ": " + hook->name()};
+					executed = hook->execute(vars);
+				}
+				if (!executed)
 				{
 					if (skip_all)
 						continue; // Skip without prompting
@@ -74,6 +112,9 @@ namespace insti
 
 	Orchestrator::Orchestrator(SnapshotRegistry* snapshot_registry)
 			: m_snapshot_registry{ snapshot_registry }
+			, m_max_parallel_actions{ ActionScheduler::DEFAULT_MAX_PARALLEL }
+			, m_delta_restore{ false }
+			, m_io_queue_depth{ FileIo::DEFAULT_QUEUE_DEPTH }
 		{
 			PNQ_ADDREF(m_snapshot_registry);
 		}
@@ -83,7 +124,8 @@ namespace insti
 			PNQ_RELEASE(m_snapshot_registry);
 		}
 
-		bool Orchestrator::backup(const Project* bp, std::string_view output_path, IActionCallback* cb, bool force, const std::string& description)
+		bool Orchestrator::backup(const Project* bp, std::string_view output_path, IActionCallback* cb, bool force, const std::string& description,
+			std::string_view parent_path)
 		{
 			if (!bp)
 			{
@@ -92,10 +134,33 @@ namespace insti
 			}
 
 			spdlog::info("backup: starting backup to {}", output_path);
+			TraceSpan trace{"operation", "backup", bp->project_name()};
 
 			bool skip_all = false;
 			const auto& vars = bp->resolved_variables();
 
+			// Open parent snapshot for incremental backup (must outlive the writer, which copies from it)
+			ZipSnapshotReader parent;
+			if (!parent_path.empty())
+			{
+				spdlog::info("backup: incremental against {}", parent_path);
+				std::error_code ec;
+				if (std::filesystem::equivalent(parent_path, output_path, ec))
+				{
+					spdlog::error("backup: parent snapshot and output are the same file");
+					if (cb)
+						cb->on_error("Parent snapshot cannot be overwritten by its own backup", parent_path);
+					return false;
+				}
+				if (!parent.open(parent_path))
+				{
+					spdlog::error("backup: failed to open parent snapshot");
+					if (cb)
+						cb->on_error("Failed to open parent snapshot", parent_path);
+					return false;
+				}
+			}
+
 			// Shutdown before backup
 			spdlog::info("backup: running shutdown hooks");
 			if (!run_lifecycle_hooks(bp->shutdown_hooks(), "Shutdown", vars, cb, skip_all, force))
@@ -105,8 +170,12 @@ namespace insti
 			}
 			spdlog::info("backup: shutdown hooks completed");
 
-			// Create snapshot writer
+			// Create snapshot writer (compresses on all cores, appends in blueprint order,
+			// records per-file hashes for verify, stores already-compressed files as they are)
 			ZipSnapshotWriter writer;
+			writer.set_thread_count(ZipSnapshotWriter::THREADS_AUTO);
+			writer.set_write_manifest(true);
+			writer.set_adaptive_compression(true);
 			std::string output_path_str{ output_path };
 			spdlog::info("backup: creating snapshot file");
 			if (!writer.create(output_path_str))
@@ -119,26 +188,34 @@ namespace insti
 			spdlog::info("backup: snapshot file created");
 
 			// Create context
-			auto* ctx = ActionContext::for_backup(bp, &writer, cb);
+			auto* ctx = ActionContext::for_backup(bp, &writer, cb, parent.is_open() ? &parent : nullptr);
 			ctx->set_skip_all_errors(skip_all);
+			ctx->set_io_queue_depth(m_io_queue_depth);
+
+			// One set of I/O workers for the whole backup, however many actions run at once
+			std::optional<ThreadPool> io_pool;
+			if (m_io_queue_depth > 1)
+				io_pool.emplace(m_io_queue_depth);
+			ctx->set_io_pool(io_pool ? &*io_pool : nullptr);
 
-			// Backup each action (forward order)
-			bool success = true;
+			// Backup each action (forward order; independent actions concurrently)
 			const auto& actions = bp->actions();
 			spdlog::info("backup: backing up {} actions", actions.size());
-
-			int action_idx = 0;
-			for (const auto* action : actions)
-			{
-				spdlog::info("backup: action {}/{}: {}", ++action_idx, actions.size(), action->description());
-				if (!action->backup(ctx))
+			plan_progress(actions, ctx);
+
+			ActionScheduler scheduler{ordered(actions), ctx};
+			scheduler.set_max_parallel(m_max_parallel_actions);
+			const bool success = scheduler.run([](const IAction* action, ActionContext* action_ctx) {
+				TraceSpan action_trace{"action", "backup", action->description()};
+				spdlog::info("backup: action: {}", action->description());
+				if (!action->backup(action_ctx))
 				{
 					spdlog::error("backup: action failed: {}", action->description());
-					success = false;
-					break;
+					return false;
 				}
 				spdlog::info("backup: action completed: {}", action->description());
-			}
+				return true;
+			});
 
 			// Propagate skip_all state back for PostBackup hooks
 			skip_all = ctx->skip_all_errors();
@@ -173,7 +250,13 @@ namespace insti
 
 			// Finalize archive
 			spdlog::info("backup: finalizing archive");
-			if (!writer.finalize())
+			bool finalized;
+			{
+				// Waits for compression still in flight, then writes the central directory
+				TraceSpan finalize_trace{"phase", "finalize"};
+				finalized = writer.finalize();
+			}
+			if (!finalized)
 			{
 				spdlog::error("backup: failed to finalize archive");
 				if (cb)
@@ -181,6 +264,13 @@ namespace insti
 				return false;
 			}
 
+			const auto& stats = writer.compression_stats();
+			const auto stored_by = [&stats](CompressionPolicy::Reason reason) { return stats.entries_by_reason[static_cast<size_t>(reason)]; };
+			spdlog::info("backup: {} entries deflated ({} -> {} bytes), {} stored ({} bytes: {} by extension, {} by signature, {} by entropy, {} did not shrink)",
+				stats.deflated_entries, stats.deflated_bytes, stats.deflated_stored_bytes, stats.stored_entries, stats.stored_bytes,
+				stored_by(CompressionPolicy::Reason::Extension), stored_by(CompressionPolicy::Reason::Signature),
+				stored_by(CompressionPolicy::Reason::Entropy), stored_by(CompressionPolicy::Reason::Ineffective));
+
 			// Startup after backup
 			spdlog::info("backup: running startup hooks");
 			if (!run_lifecycle_hooks(bp->startup_hooks(), "Startup", vars, cb, skip_all, force))
@@ -198,11 +288,87 @@ namespace insti
 			return true;
 		}
 
+		bool Orchestrator::update_description(std::string_view snapshot_path, const std::string& description)
+		{
+			const std::string path_str{ snapshot_path };
+			spdlog::info("update_description: {}", path_str);
+
+			ZipSnapshotReader source;
+			if (!source.open(path_str))
+			{
+				spdlog::error("update_description: failed to open snapshot");
+				return false;
+			}
+
+			// Edit the stored XML rather than re-serializing, so everything else is kept verbatim
+			const std::string xml = source.read_text("blueprint.xml");
+			pugi::xml_document doc;
+			if (xml.empty() || !doc.load_string(xml.c_str()))
+			{
+				spdlog::error("update_description: snapshot has no readable blueprint.xml");
+				return false;
+			}
+
+			auto instance_node = doc.child("blueprint").child("instance");
+			if (!instance_node)
+			{
+				spdlog::error("update_description: blueprint.xml has no <instance> section");
+				return false;
+			}
+
+			auto desc = instance_node.child("description");
+			if (description.empty())
+			{
+				instance_node.remove_child(desc);
+			}
+			else
+			{
+				if (!desc)
+					desc = instance_node.append_child("description");
+				desc.text().set(description.c_str());
+			}
+
+			std::ostringstream oss;
+			doc.save(oss, "    ");
+
+			// Repack into a temp file next to the original: raw copies, only blueprint.xml is compressed
+			const std::string temp_path = path_str + ".tmp";
+			{
+				ZipSnapshotWriter writer;
+				bool ok = writer.create(temp_path)
+					&& writer.copy_all_from(source, [](std::string_view path) { return path != "blueprint.xml"; })
+					&& writer.write_text("blueprint.xml", oss.str())
+					&& writer.finalize();
+				if (!ok)
+				{
+					spdlog::error("update_description: failed to write {}", temp_path);
+					writer.close();
+					std::error_code ec;
+					std::filesystem::remove(temp_path, ec);
+					return false;
+				}
+			}
+			source.close();
+
+			std::error_code ec;
+			std::filesystem::rename(temp_path, path_str, ec);
+			if (ec)
+			{
+				spdlog::error("update_description: failed to replace snapshot: {}", ec.message());
+				std::filesystem::remove(temp_path, ec);
+				return false;
+			}
+
+			spdlog::info("update_description: completed");
+			return true;
+		}
+
 		bool Orchestrator::restore(const Instance* bp, std::string_view archive_path, IActionCallback* cb, bool simulate, bool force)
 		{
 			if (!bp)
 				return false;
 
+			TraceSpan trace{"operation", "restore", bp->project_name()};
 			bool skip_all = false;
 			const auto& vars = bp->resolved_variables();
 
@@ -216,19 +382,27 @@ namespace insti
 				return false;
 			}
 
-			// Clean existing resources (reverse order)
+			// Clean existing resources (reverse order). In delta mode, actions that update
+			// in place are left alone: their restore removes what the snapshot lacks
+			const bool delta = m_delta_restore;
+			BackgroundDeleter trash;
 			auto* clean_ctx = ActionContext::for_clean(bp, cb);
 			clean_ctx->set_skip_all_errors(skip_all);
 			clean_ctx->set_simulate(simulate);
+			clean_ctx->set_background_deleter(&trash);
 			const auto& actions = bp->actions();
 
-			for (auto it = actions.rbegin(); it != actions.rend(); ++it)
+			ActionScheduler clean_scheduler{ordered(actions, true), clean_ctx};
+			clean_scheduler.set_max_parallel(m_max_parallel_actions);
+			if (!clean_scheduler.run([delta](const IAction* action, ActionContext* action_ctx) {
+					if (delta && action->supports_delta_restore())
+						return true;
+					TraceSpan action_trace{"action", "clean", action->description()};
+					return action->clean(action_ctx);
+				}))
 			{
-				if (!(*it)->clean(clean_ctx))
-				{
-					clean_ctx->release(REFCOUNT_DEBUG_ARGS);
-					return false;
-				}
+				clean_ctx->release(REFCOUNT_DEBUG_ARGS);
+				return false;
 			}
 
 			skip_all = clean_ctx->skip_all_errors();
@@ -238,16 +412,20 @@ namespace insti
 			auto* ctx = ActionContext::for_restore(bp, &reader, cb);
 			ctx->set_skip_all_errors(skip_all);
 			ctx->set_simulate(simulate);
+			ctx->set_delta_restore(delta);
+			ctx->set_background_deleter(&trash);
 
-			bool success = true;
-			for (const auto* action : actions)
-			{
-				if (!action->restore(ctx))
-				{
-					success = false;
-					break;
-				}
-			}
+			// One extraction worker per core for the whole restore, however many actions run at once
+			ThreadPool extract_pool;
+			ctx->set_extract_pool(&extract_pool);
+			plan_progress(actions, ctx);
+
+			ActionScheduler scheduler{ordered(actions), ctx};
+			scheduler.set_max_parallel(m_max_parallel_actions);
+			const bool success = scheduler.run([](const IAction* action, ActionContext* action_ctx) {
+				TraceSpan action_trace{"action", "restore", action->description()};
+				return action->restore(action_ctx);
+			});
 
 			skip_all = ctx->skip_all_errors();
 			ctx->release(REFCOUNT_DEBUG_ARGS);
@@ -255,6 +433,14 @@ namespace insti
 			if (!success)
 				return false;
 
+			// Old trees were deleted while restoring; finish before starting the application
+			ProgressTracker cleanup{ cb, "Clean" };
+			std::atomic<bool> skip_deletes{ skip_all };
+			const bool deleted = trash.wait(cleanup, cb, skip_deletes);
+			skip_all = skip_deletes;
+			if (!deleted)
+				return false;
+
 			// Startup after restore (skip in simulate mode)
 			if (!simulate && !run_lifecycle_hooks(bp->startup_hooks(), "Startup", vars, cb, skip_all, force))
 				return false;
@@ -274,6 +460,7 @@ namespace insti
 			if (!bp)
 				return false;
 
+			TraceSpan trace{"operation", "clean", bp->project_name()};
 			bool skip_all = false;
 			const auto& vars = bp->resolved_variables();
 
@@ -282,25 +469,26 @@ namespace insti
 				return false;
 
 			// Create context
+			BackgroundDeleter trash;
 			auto* ctx = ActionContext::for_clean(bp, cb);
 			ctx->set_skip_all_errors(skip_all);
 			ctx->set_simulate(simulate);
-
-			// Clean each action (reverse order)
-			bool success = true;
-			const auto& actions = bp->actions();
-
-			for (auto it = actions.rbegin(); it != actions.rend(); ++it)
-			{
-				if (!(*it)->clean(ctx))
-				{
-					success = false;
-					break;
-				}
-			}
-
+			ctx->set_background_deleter(&trash);
+
+			// Clean each action (reverse order; independent actions concurrently)
+			ActionScheduler scheduler{ordered(bp->actions(), true), ctx};
+			scheduler.set_max_parallel(m_max_parallel_actions);
+			const bool success = scheduler.run([](const IAction* action, ActionContext* action_ctx) {
+				TraceSpan action_trace{"action", "clean", action->description()};
+				return action->clean(action_ctx);
+			});
+
+			// The moved-away trees are part of the clean, so their deletion extends its progress
+			const bool deleted = trash.wait(ctx->progress(), cb, ctx->skip_all_flag());
 			skip_all = ctx->skip_all_errors();
 			ctx->release(REFCOUNT_DEBUG_ARGS);
+			if (!deleted)
+				return false;
 
 			if (!simulate && success)
 			{
@@ -313,24 +501,28 @@ namespace insti
 			return success;
 		}
 
-		std::vector<VerifyResult> Orchestrator::verify(const Blueprint* bp, IActionCallback* cb, SnapshotReader* reader)
+		std::vector<VerifyResult> Orchestrator::verify(const Blueprint* bp, IActionCallback* cb, SnapshotReader* reader, bool fast)
 		{
 			std::vector<VerifyResult> results;
 
 			if (!bp)
 				return results;
 
+			TraceSpan trace{"operation", "verify", bp->project_name()};
+
 			// Use restore context if reader is available (instance verification)
 			// Otherwise use clean context (project verification - just checks existence)
 			ActionContext* ctx = reader
 				? ActionContext::for_restore(bp, reader, cb)
 				: ActionContext::for_clean(bp, cb);
+			ctx->set_verify_fast(fast);
 
 			for (const auto* action : bp->actions())
 			{
 				if (cb)
 					cb->on_progress("Verify", action->description().c_str(), -1);
 
+				TraceSpan action_trace{"action", "verify", action->description()};
 				results.push_back(action->verify(ctx));
 			}
 
@@ -0,0 +1,136 @@
+#include "pch.h"
+#include <insti/core/progress_tracker.h>
+#include <algorithm>
+#include <utility>
+
+namespace insti
+{
+
+    namespace
+    {
+        /// Weight of the newest throughput sample in the moving average.
+        constexpr double RATE_SMOOTHING = 0.3;
+    } // anonymous namespace
+
+    ProgressTracker::ProgressTracker(IActionCallback* callback, std::string phase)
+        : m_callback{callback}
+        , m_phase{std::move(phase)}
+    {
+    }
+
+    IActionCallback* ProgressTracker::set_callback(IActionCallback* callback)
+    {
+        std::lock_guard lock{m_mutex};
+        return std::exchange(m_callback, callback);
+    }
+
+    void ProgressTracker::plan(const ProgressEstimate& total)
+    {
+        std::lock_guard lock{m_mutex};
+        m_total = total;
+    }
+
+    void ProgressTracker::expect(const ProgressEstimate& work)
+    {
+        std::lock_guard lock{m_mutex};
+        m_total.bytes += work.bytes;
+        m_total.items += work.items;
+    }
+
+    uint64_t ProgressTracker::bytes_done() const
+    {
+        std::lock_guard lock{m_mutex};
+        return m_done.bytes;
+    }
+
+    uint64_t ProgressTracker::items_done() const
+    {
+        std::lock_guard lock{m_mutex};
+        return m_done.items;
+    }
+
+    void ProgressTracker::advance(uint64_t bytes, uint64_t items, std::string_view detail)
+    {
+        ProgressInfo info;
+        IActionCallback* callback;
+        {
+            std::lock_guard lock{m_mutex};
+            m_done.bytes += bytes;
+            m_done.items += items;
+
+            const auto now = Clock::now();
+            if (m_last_report != Clock::time_point{} && now - m_last_report < m_interval)
+                return;
+            info = sample(detail, now);
+            callback = m_callback;
+        }
+        if (callback)
+            callback->on_progress_info(info);
+    }
+
+    void ProgressTracker::flush(std::string_view detail)
+    {
+        ProgressInfo info;
+        IActionCallback* callback;
+        {
+            std::lock_guard lock{m_mutex};
+            info = sample(detail, Clock::now());
+            callback = m_callback;
+        }
+        if (callback)
+            callback->on_progress_info(info);
+    }
+
+    ProgressInfo ProgressTracker::sample(std::string_view detail, Clock::time_point now)
+    {
+        // Throughput: moving average over report intervals, so the ETA neither
+        // jumps with every file nor lags behind a change of pace for long
+        if (m_last_sample == Clock::time_point{})
+        {
+            m_last_sample = now;
+            m_sample_bytes = m_done.bytes;
+            m_sample_items = m_done.items;
+        }
+        else if (const std::chrono::duration<double> elapsed = now - m_last_sample; elapsed.count() >= 0.05)
+        {
+            const auto smooth = [](double rate, double sample) {
+                return rate == 0.0 ? sample : RATE_SMOOTHING * sample + (1.0 - RATE_SMOOTHING) * rate;
+            };
+            m_rate = smooth(m_rate, static_cast<double>(m_done.bytes - m_sample_bytes) / elapsed.count());
+            m_item_rate = smooth(m_item_rate, static_cast<double>(m_done.items - m_sample_items) / elapsed.count());
+            m_last_sample = now;
+            m_sample_bytes = m_done.bytes;
+            m_sample_items = m_done.items;
+        }
+        m_last_report = now;
+
+        ProgressInfo info;
+        info.phase = m_phase;
+        info.detail = detail;
+        info.bytes_done = m_done.bytes;
+        info.bytes_total = m_total.bytes;
+        info.items_done = m_done.items;
+        info.items_total = m_total.items;
+        info.bytes_per_second = m_rate;
+        info.items_per_second = m_item_rate;
+
+        // Estimates can be short (files grow during backup), so never report past 100
+        if (m_total.bytes > 0)
+            info.percent = static_cast<int>(std::min<uint64_t>(100, m_done.bytes * 100 / m_total.bytes));
+        else if (m_total.items > 0)
+            info.percent = static_cast<int>(std::min<uint64_t>(100, m_done.items * 100 / m_total.items));
+
+        if (m_total.bytes > 0)
+        {
+            if (m_rate > 0.0 && m_total.bytes > m_done.bytes)
+                info.eta = std::chrono::seconds{static_cast<int64_t>((m_total.bytes - m_done.bytes) / m_rate)};
+        }
+        else if (m_item_rate > 0.0 && m_total.items > m_done.items)
+        {
+            info.eta = std::chrono::seconds{static_cast<int64_t>((m_total.items - m_done.items) / m_item_rate)};
+        }
+
+        return info;
+    }
+
+} // namespace insti
@@ -0,0 +1,135 @@
+#include "pch.h"
+#include <insti/core/sha256.h>
+#include <bcrypt.h>
+#include <algorithm>
+#include <fstream>
+
+#pragma comment(lib, "bcrypt.lib")
+
+namespace insti
+{
+
+    namespace
+    {
+        /// Block size for hashing files.
+        constexpr size_t HASH_BLOCK_SIZE = 256 * 1024;
+
+        /// Largest chunk passed to one BCryptHashData call (its size is a ULONG).
+        constexpr size_t MAX_UPDATE_SIZE = 1u << 30;
+
+        /// SHA-256 algorithm provider shared by all hashers. Opening a provider is far more
+        /// expensive than creating a hash object, and provider handles may be used from
+        /// several threads at once.
+        class Sha256Provider final
+        {
+            PNQ_DECLARE_NON_COPYABLE(Sha256Provider)
+
+        public:
+            Sha256Provider()
+            {
+                if (!BCRYPT_SUCCESS(BCryptOpenAlgorithmProvider(&m_alg, BCRYPT_SHA256_ALGORITHM, nullptr, 0)))
+                    m_alg = nullptr;
+            }
+
+            ~Sha256Provider()
+            {
+                if (m_alg)
+                    BCryptCloseAlgorithmProvider(m_alg, 0);
+            }
+
+            BCRYPT_ALG_HANDLE handle() const { return m_alg; }
+
+        private:
+            BCRYPT_ALG_HANDLE m_alg = nullptr;
+        };
+
+        BCRYPT_ALG_HANDLE sha256_provider()
+        {
+            static const Sha256Provider provider;
+            return provider.handle();
+        }
+    } // anonymous namespace
+
+    Sha256::Sha256()
+    {
+        BCRYPT_HASH_HANDLE hash = nullptr;
+        if (BCRYPT_ALG_HANDLE alg = sha256_provider())
+        {
+            m_ok = BCRYPT_SUCCESS(BCryptCreateHash(alg, &hash, nullptr, 0, nullptr, 0, 0));
+            m_hash = hash;
+        }
+    }
+
+    Sha256::~Sha256()
+    {
+        if (m_hash)
+            BCryptDestroyHash(static_cast<BCRYPT_HASH_HANDLE>(m_hash));
+    }
+
+    bool Sha256::update(const void *data, size_t size)
+    {
+        // Buffers of 4 GiB and more would be truncated by the ULONG length
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        while (m_ok && size > 0)
+        {
+            const size_t chunk = std::min(size, MAX_UPDATE_SIZE);
+            m_ok = BCRYPT_SUCCESS(BCryptHashData(static_cast<BCRYPT_HASH_HANDLE>(m_hash),
+                                                 const_cast<PUCHAR>(bytes), static_cast<ULONG>(chunk), 0));
+            bytes += chunk;
+            size -= chunk;
+        }
+        return m_ok;
+    }
+
+    std::string Sha256::finish()
+    {
+        uint8_t digest[32];
+        if (!m_ok || !BCRYPT_SUCCESS(BCryptFinishHash(static_cast<BCRYPT_HASH_HANDLE>(m_hash), digest, sizeof(digest), 0)))
+            return {};
+        m_ok = false;  // CNG hash objects cannot be reused after finishing
+
+        static constexpr char HEX[] = "0123456789abcdef";
+        std::string result;
+        result.reserve(sizeof(digest) * 2);
+        for (uint8_t b : digest)
+        {
+            result += HEX[b >> 4];
+            result += HEX[b & 0x0F];
+        }
+        return result;
+    }
+
+    std::string Sha256::of_buffer(const void *data, size_t size)
+    {
+        Sha256 sha;
+        if (!sha.update(data, size))
+            return {};
+        return sha.finish();
+    }
+
+    std::string Sha256::of_file(const std::filesystem::path &path, uint64_t *size)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return {};
+
+        Sha256 sha;
+        std::vector<char> buffer(HASH_BLOCK_SIZE);
+        uint64_t total = 0;
+        while (file)
+        {
+            file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            const auto got = static_cast<size_t>(file.gcount());
+            if (!sha.update(buffer.data(), got))
+                return {};
+            total += got;
+        }
+        if (file.bad())
+            return {};
+
+        if (size)
+            *size = total;
+        return sha.finish();
+    }
+
+} // namespace insti
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include <insti/core/thread_pool.h>
+
+namespace insti
+{
+
+    ThreadPool::ThreadPool(unsigned thread_count)
+    {
+        if (thread_count == 0)
+            thread_count = default_thread_count();
+
+        m_threads.reserve(thread_count);
+        for (unsigned i = 0; i < thread_count; ++i)
+            m_threads.emplace_back(&ThreadPool::worker_loop, this);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stopping = true;
+        }
+        m_work_available.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    unsigned ThreadPool::default_thread_count()
+    {
+        const unsigned hw = std::thread::hardware_concurrency();
+        return hw > 0 ? hw : 1;
+    }
+
+    void ThreadPool::enqueue(std::move_only_function<void()> task)
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_queue.push_back(std::move(task));
+        }
+        m_work_available.notify_one();
+    }
+
+    void ThreadPool::wait_idle()
+    {
+        std::unique_lock lock{m_mutex};
+        m_idle.wait(lock, [this] { return m_queue.empty() && m_active == 0; });
+    }
+
+    void ThreadPool::worker_loop()
+    {
+        while (true)
+        {
+            std::move_only_function<void()> task;
+            {
+                std::unique_lock lock{m_mutex};
+                m_work_available.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+
+                // Drain remaining work before exiting so futures never dangle
+                if (m_queue.empty())
+                    return;
+
+                task = std::move(m_queue.front());
+                m_queue.pop_front();
+                ++m_active;
+            }
+
+            task();
+
+            {
+                std::lock_guard lock{m_mutex};
+                --m_active;
+                if (m_queue.empty() && m_active == 0)
+                    m_idle.notify_all();
+            }
+        }
+    }
+
+} // namespace insti
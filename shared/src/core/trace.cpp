@@ -0,0 +1,125 @@
+#include "pch.h"
+#include <insti/core/trace.h>
+#include <algorithm>
+#include <fstream>
+
+namespace insti
+{
+
+    namespace
+    {
+        std::string json_escape(std::string_view text)
+        {
+            std::string out;
+            out.reserve(text.size());
+            for (const char c : text)
+            {
+                switch (c)
+                {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                        out += std::format("\\u{:04x}", static_cast<unsigned>(c));
+                    else
+                        out += c;
+                    break;
+                }
+            }
+            return out;
+        }
+
+        int64_t microseconds(std::chrono::steady_clock::duration d)
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        }
+    } // anonymous namespace
+
+    Tracer& Tracer::instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void Tracer::start()
+    {
+        std::lock_guard lock{m_mutex};
+        for (auto& buffer : m_buffers)
+        {
+            std::lock_guard buffer_lock{buffer->mutex};
+            buffer->events.clear();
+        }
+        m_epoch = std::chrono::steady_clock::now();
+        s_enabled.store(true, std::memory_order_relaxed);
+        spdlog::info("Tracer: recording");
+    }
+
+    Tracer::ThreadBuffer& Tracer::thread_buffer()
+    {
+        thread_local ThreadBuffer* t_buffer = nullptr;
+        if (!t_buffer)
+        {
+            std::lock_guard lock{m_mutex};
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->tid = static_cast<uint32_t>(m_buffers.size() + 1);
+            t_buffer = buffer.get();
+            m_buffers.push_back(std::move(buffer));
+        }
+        return *t_buffer;
+    }
+
+    void Tracer::record(const char* category, const char* name, std::string detail,
+                        std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        auto& buffer = thread_buffer();
+        std::lock_guard lock{buffer.mutex};
+        buffer.events.push_back({category, name, std::move(detail), start, end});
+    }
+
+    bool Tracer::stop(std::string_view path)
+    {
+        s_enabled.store(false, std::memory_order_relaxed);
+
+        // Complete events ("ph":"X") nest by time per thread in the viewer
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        json += R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"insti"}})";
+        size_t count = 0;
+        {
+            std::lock_guard lock{m_mutex};
+            for (auto& buffer : m_buffers)
+            {
+                std::lock_guard buffer_lock{buffer->mutex};
+                for (const auto& event : buffer->events)
+                {
+                    // Spans begun before start() have no place on the timeline
+                    if (event.start < m_epoch)
+                        continue;
+
+                    json += std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{},\"dur\":{},\"pid\":1,\"tid\":{}",
+                                        event.name, event.category, microseconds(event.start - m_epoch),
+                                        microseconds(event.end - event.start), buffer->tid);
+                    if (!event.detail.empty())
+                        json += std::format(",\"args\":{{\"detail\":\"{}\"}}", json_escape(event.detail));
+                    json += '}';
+                    ++count;
+                }
+                buffer->events.clear();
+            }
+        }
+        json += "\n]}\n";
+
+        const std::string path_str{path};
+        std::ofstream out(path_str, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(json.data(), static_cast<std::streamsize>(json.size())))
+        {
+            spdlog::error("Tracer: failed to write {}", path_str);
+            return false;
+        }
+        spdlog::info("Tracer: wrote {} spans to {}", count, path_str);
+        return true;
+    }
+
+} // namespace insti
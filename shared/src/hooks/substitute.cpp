@@ -1,58 +1,16 @@
 #include "pch.h"
 #include <insti/hooks/substitute.h>
+#include <insti/core/directory_scanner.h>
+#include <insti/core/glob.h>
+#include <insti/core/thread_pool.h>
 #include <algorithm>
 #include <filesystem>
+#include <fstream>
+#include <system_error>
 
 namespace insti
 {
 
-namespace
-{
-
-/// Case-insensitive character comparison
-bool char_equal_nocase(char a, char b)
-{
-    return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
-}
-
-/// Simple glob pattern matching (supports * and ?)
-bool matches_glob(std::string_view pattern, std::string_view text)
-{
-    size_t p = 0, t = 0;
-    size_t star_p = std::string_view::npos;
-    size_t star_t = 0;
-
-    while (t < text.size())
-    {
-        if (p < pattern.size() && (pattern[p] == '?' || char_equal_nocase(pattern[p], text[t])))
-        {
-            ++p;
-            ++t;
-        }
-        else if (p < pattern.size() && pattern[p] == '*')
-        {
-            star_p = p++;
-            star_t = t;
-        }
-        else if (star_p != std::string_view::npos)
-        {
-            p = star_p + 1;
-            t = ++star_t;
-        }
-        else
-        {
-            return false;
-        }
-    }
-
-    while (p < pattern.size() && pattern[p] == '*')
-        ++p;
-
-    return p == pattern.size();
-}
-
-} // namespace
-
 std::vector<std::string> SubstituteHook::expand_glob(const std::string& resolved_pattern) const
 {
     std::vector<std::string> results;
@@ -71,38 +29,42 @@ std::vector<std::string> SubstituteHook::expand_glob(const std::string& resolved
         return results;
     }
 
-    // Split into directory and filename pattern
-    std::filesystem::path pattern_path{resolved_pattern};
-    std::filesystem::path parent = pattern_path.parent_path();
-    std::string filename_pattern = pattern_path.filename().string();
-
-    // Check if directory part also has wildcards (not supported yet)
-    if (parent.string().find('*') != std::string::npos ||
-        parent.string().find('?') != std::string::npos)
+    // Split at the last separator before the first wildcard: everything before it is
+    // a plain directory, everything after it is matched relative to that directory
+    std::string normalized = resolved_pattern;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    const size_t first_wildcard = normalized.find_first_of("*?");
+    const size_t split = normalized.rfind('/', first_wildcard);
+    if (split == std::string::npos)
     {
-        spdlog::warn("Wildcards in directory path not supported: {}", resolved_pattern);
+        spdlog::warn("Directory not found: {}", resolved_pattern);
         return results;
     }
 
-    // Iterate directory and match
+    std::filesystem::path parent{resolved_pattern.substr(0, split + 1)};
+    const std::string relative_pattern = normalized.substr(split + 1);
+    const GlobPattern glob{relative_pattern};
+
     std::error_code ec;
-    if (!std::filesystem::exists(parent, ec))
+    if (!std::filesystem::is_directory(parent, ec))
     {
         spdlog::warn("Directory not found: {}", parent.string());
         return results;
     }
 
-    for (const auto& entry : std::filesystem::directory_iterator(parent, ec))
-    {
-        if (!entry.is_regular_file())
-            continue;
+    // Wildcards in directory segments ("logs/*/app.ini", "**/*.config") need a recursive walk
+    DirectoryScanner scanner;
+    scanner.set_recursive(glob.is_path_pattern());
+    if (!glob.is_path_pattern())
+        scanner.set_thread_count(1);
+    scanner.set_file_filter([&glob](std::string_view rel_path) { return glob.matches(rel_path); });
 
-        std::string filename = entry.path().filename().string();
-        if (matches_glob(filename_pattern, filename))
-        {
-            results.push_back(entry.path().string());
-        }
-    }
+    const auto scan = scanner.scan(parent);
+    for (const auto& error : scan.errors)
+        spdlog::warn("Cannot enumerate {}: {}", error.path.string(), error.message);
+
+    for (const auto& file : scan.files)
+        results.push_back(file.path.string());
 
     if (results.empty())
         spdlog::warn("No files matched pattern: {}", resolved_pattern);
@@ -110,112 +72,195 @@ std::vector<std::string> SubstituteHook::expand_glob(const std::string& resolved
     return results;
 }
 
-bool SubstituteHook::substitute_to_placeholders(
-    const std::string& file_path,
-    const std::unordered_map<std::string, std::string>& variables) const
+namespace
 {
-    // Read file content
-    std::string content = pnq::text_file::read_auto(file_path);
-    if (content.empty() && !pnq::file::exists(file_path))
-    {
-        spdlog::error("Failed to read file: {}", file_path);
-        return false;
-    }
 
-    // Build list of (value, varname) pairs, sorted by value length descending
-    // This ensures longest match first to avoid partial substitution
-    std::vector<std::pair<std::string, std::string>> replacements;
+/// Bytes read per step when streaming a file; bounds memory regardless of file size.
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+/// Suffix of the temporary file written next to the target.
+constexpr std::string_view TEMP_SUFFIX = ".insti-tmp";
+
+/// Backup: known values -> ${VARNAME}.
+MultiPatternReplacer make_placeholder_replacer(const std::unordered_map<std::string, std::string>& variables)
+{
+    std::vector<std::pair<std::string, std::string>> patterns;
     for (const auto& [name, value] : variables)
     {
         // Skip empty values and variables that look like placeholders themselves
         if (value.empty() || value.find("${") != std::string::npos)
             continue;
 
-        replacements.emplace_back(value, name);
+        patterns.emplace_back(value, "${" + name + "}");
     }
 
-    // Sort by value length descending
-    std::sort(replacements.begin(), replacements.end(),
-              [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
-
-    // Perform replacements (case-insensitive for paths)
-    std::string result = content;
-    bool modified = false;
+    // Variables sharing a value: the first one wins, so make that independent of hash order
+    std::sort(patterns.begin(), patterns.end(),
+              [](const auto& a, const auto& b) { return a.second < b.second; });
+    return MultiPatternReplacer{patterns};
+}
 
-    for (const auto& [value, name] : replacements)
+/// Restore: ${VARNAME} and %VARNAME% -> value. Unknown placeholders are left alone.
+MultiPatternReplacer make_value_replacer(const std::unordered_map<std::string, std::string>& variables)
+{
+    std::vector<std::pair<std::string, std::string>> patterns;
+    patterns.reserve(variables.size() * 2);
+    for (const auto& [name, value] : variables)
     {
-        std::string placeholder = "${" + name + "}";
-        size_t pos = 0;
-
-        while (true)
-        {
-            // Case-insensitive search
-            auto it = std::search(result.begin() + pos, result.end(),
-                                  value.begin(), value.end(),
-                                  [](char a, char b) {
-                                      return std::tolower(static_cast<unsigned char>(a)) ==
-                                             std::tolower(static_cast<unsigned char>(b));
-                                  });
-
-            if (it == result.end())
-                break;
-
-            size_t found_pos = it - result.begin();
-            result.replace(found_pos, value.size(), placeholder);
-            pos = found_pos + placeholder.size();
-            modified = true;
-        }
+        patterns.emplace_back("${" + name + "}", value);
+        patterns.emplace_back("%" + name + "%", value);
     }
+    std::sort(patterns.begin(), patterns.end());
+    return MultiPatternReplacer{patterns};
+}
+
+/// True if the file starts with a UTF-16 byte order mark.
+bool is_utf16(std::istream& in)
+{
+    char bom[2] = {};
+    in.read(bom, 2);
+    const bool utf16 = in.gcount() == 2 &&
+        ((bom[0] == '\xFF' && bom[1] == '\xFE') || (bom[0] == '\xFE' && bom[1] == '\xFF'));
+    in.clear();
+    in.seekg(0);
+    return utf16;
+}
 
-    if (!modified)
+/// UTF-16 files: convert to UTF-8 in memory, as text_file does.
+bool substitute_in_memory(const std::string& file_path, const MultiPatternReplacer& replacer, size_t& replacements)
+{
+    std::string content = pnq::text_file::read_auto(file_path);
+    if (content.empty() && !pnq::file::exists(file_path))
     {
-        spdlog::debug("No substitutions made in: {}", file_path);
-        return true;
+        spdlog::error("Failed to read file: {}", file_path);
+        return false;
     }
 
+    MultiPatternReplacer::Stream stream{replacer};
+    std::string result;
+    result.reserve(content.size());
+    stream.write(content, result);
+    stream.finish(result);
+    replacements = stream.replacements();
+    if (replacements == 0)
+        return true;
+
     // Write back (no BOM to preserve original format)
     if (!pnq::text_file::write_utf8(file_path, result, false))
     {
         spdlog::error("Failed to write file: {}", file_path);
         return false;
     }
-
-    spdlog::info("Substituted values with placeholders in: {}", file_path);
     return true;
 }
 
-bool SubstituteHook::substitute_from_placeholders(
-    const std::string& file_path,
-    const std::unordered_map<std::string, std::string>& variables) const
+/// Stream the file through the replacer in CHUNK_SIZE steps into a temporary file,
+/// then swap it in. The target is either the old or the new content at any time,
+/// and ReplaceFileW keeps its attributes and ACL.
+/// @param replacements Receives the number of replacements (0 leaves the file untouched)
+bool substitute_file(const std::string& file_path, const MultiPatternReplacer& replacer, size_t& replacements)
 {
-    // Read file content
-    std::string content = pnq::text_file::read_auto(file_path);
-    if (content.empty() && !pnq::file::exists(file_path))
+    replacements = 0;
+    const std::filesystem::path target{file_path};
+    std::ifstream in{target, std::ios::binary};
+    if (!in)
     {
         spdlog::error("Failed to read file: {}", file_path);
         return false;
     }
 
-    // Use pnq::string::Expander for ${VAR} replacement
-    pnq::string::Expander expander{variables, true};
-    expander.expand_dollar(true).expand_percent(true);
+    if (is_utf16(in))
+    {
+        in.close();
+        return substitute_in_memory(file_path, replacer, replacements);
+    }
+
+    std::filesystem::path temp = target;
+    temp += TEMP_SUFFIX;
+    std::ofstream out{temp, std::ios::binary | std::ios::trunc};
+    if (!out)
+    {
+        spdlog::error("Failed to create temporary file: {}", temp.string());
+        return false;
+    }
 
-    std::string result = expander.expand(content);
+    MultiPatternReplacer::Stream stream{replacer};
+    std::string buffer(CHUNK_SIZE, '\0');
+    std::string output;
+    output.reserve(CHUNK_SIZE);
+    bool ok = true;
+
+    while (ok && in)
+    {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto count = static_cast<size_t>(in.gcount());
+        if (count == 0)
+            break;
+
+        output.clear();
+        stream.write(std::string_view{buffer}.substr(0, count), output);
+        ok = static_cast<bool>(out.write(output.data(), static_cast<std::streamsize>(output.size())));
+    }
+    ok = ok && !in.bad();
+    if (ok)
+    {
+        output.clear();
+        stream.finish(output);
+        ok = static_cast<bool>(out.write(output.data(), static_cast<std::streamsize>(output.size())));
+    }
+    in.close();
+    out.close();
+    ok = ok && !out.fail();
+
+    std::error_code ec;
+    if (!ok)
+    {
+        spdlog::error("Failed to rewrite file: {}", file_path);
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
 
-    if (result == content)
+    replacements = stream.replacements();
+    if (replacements == 0)
     {
-        spdlog::debug("No placeholders found in: {}", file_path);
+        std::filesystem::remove(temp, ec);
         return true;
     }
 
-    // Write back (no BOM to preserve original format)
-    if (!pnq::text_file::write_utf8(file_path, result, false))
+    if (!ReplaceFileW(target.c_str(), temp.c_str(), nullptr, REPLACEFILE_IGNORE_MERGE_ERRORS, nullptr, nullptr))
     {
-        spdlog::error("Failed to write file: {}", file_path);
+        spdlog::error("Failed to replace file: {} ({})", file_path,
+                      std::system_category().message(static_cast<int>(GetLastError())));
+        std::filesystem::remove(temp, ec);
         return false;
     }
+    return true;
+}
 
-    spdlog::info("Resolved placeholders in: {}", file_path);
+} // anonymous namespace
+
+bool SubstituteHook::substitute(const std::string& file_path, const MultiPatternReplacer& replacer) const
+{
+    size_t replacements = 0;
+    if (!substitute_file(file_path, replacer, replacements))
+        return false;
+
+    switch (m_direction)
+    {
+    case Direction::Backup:
+        if (replacements == 0)
+            spdlog::debug("No substitutions made in: {}", file_path);
+        else
+            spdlog::info("Substituted values with placeholders in: {}", file_path);
+        break;
+
+    case Direction::Restore:
+        if (replacements == 0)
+            spdlog::debug("No placeholders found in: {}", file_path);
+        else
+            spdlog::info("Resolved placeholders in: {}", file_path);
+        break;
+    }
     return true;
 }
 
@@ -233,25 +278,25 @@ bool SubstituteHook::execute(const std::unordered_map<std::string, std::string>&
     if (files.empty())
         return true; // No files to process - not an error
 
-    bool all_ok = true;
-    for (const auto& file : files)
-    {
-        bool ok = false;
+    // Compiled once for all files
+    const MultiPatternReplacer replacer = m_direction == Direction::Backup
+        ? make_placeholder_replacer(variables)   // Replace values with placeholders
+        : make_value_replacer(variables);        // Replace placeholders with values
 
-        switch (m_direction)
-        {
-        case Direction::Backup:
-            // Replace values with placeholders
-            ok = substitute_to_placeholders(file, variables);
-            break;
+    if (files.size() == 1)
+        return substitute(files.front(), replacer);
 
-        case Direction::Restore:
-            // Replace placeholders with values
-            ok = substitute_from_placeholders(file, variables);
-            break;
-        }
+    // Files are independent; each one is streamed, so memory stays bounded per worker
+    ThreadPool pool{static_cast<unsigned>(std::min<size_t>(files.size(), ThreadPool::default_thread_count()))};
+    std::vector<std::future<bool>> results;
+    results.reserve(files.size());
+    for (const auto& file : files)
+        results.push_back(pool.submit([this, &file, &replacer] { return substitute(file, replacer); }));
 
-        if (!ok)
+    bool all_ok = true;
+    for (auto& result : results)
+    {
+        if (!result.get())
             all_ok = false;
     }
 
@@ -1,10 +1,21 @@
 #include "pch.h"
 #include <insti/registry/blueprint_cache.h>
 #include <algorithm>
+#include <charconv>
+#include <mutex>
 
 namespace insti
 {
 
+namespace
+{
+
+/// Override set by BlueprintCache::set_default_path() (empty = none).
+std::mutex g_default_path_mutex;
+std::string g_default_path_override;
+
+} // anonymous namespace
+
 BlueprintCache::BlueprintCache() = default;
 
 BlueprintCache::~BlueprintCache()
@@ -22,6 +33,14 @@ bool BlueprintCache::open(std::string_view path)
         return false;
     }
 
+    // Registry roots, the CLI and the GUI may all have the cache open at once: WAL lets
+    // readers proceed during a write, and the busy timeout makes a second writer wait
+    // instead of failing with SQLITE_BUSY. The cache can be rebuilt at any time, so
+    // NORMAL sync (no fsync per commit) is sufficient.
+    m_db.execute("PRAGMA journal_mode = WAL");
+    m_db.execute("PRAGMA synchronous = NORMAL");
+    m_db.execute("PRAGMA busy_timeout = 5000");
+
     ensure_schema();
     spdlog::info("BlueprintCache: opened database at '{}'", path);
     return true;
@@ -43,8 +62,14 @@ void BlueprintCache::close()
 {
     if (is_open())
     {
+        commit_batch();
         m_db.close();
     }
+    m_preloaded = false;
+    m_preload_prefix.clear();
+    m_entries.clear();
+    m_batching = false;
+    m_pending_writes.clear();
 }
 
 bool BlueprintCache::is_open() const
@@ -62,18 +87,16 @@ std::optional<std::string> BlueprintCache::get(std::string_view path, int64_t mt
 
     std::string normalized = normalize_path(path);
 
-    pnq::sqlite::Statement stmt{ m_db, "SELECT mtime, size, xml, install_status FROM blueprints WHERE path = ?" };
-    stmt.bind(normalized);
-
-    if (!stmt.execute() || stmt.is_empty())
+    auto entry = lookup(normalized);
+    if (!entry)
     {
         spdlog::info("BlueprintCache::get: no entry for '{}'", normalized);
         return std::nullopt;
     }
 
-    int64_t cached_mtime = stmt.get_int64(0);
-    int64_t cached_size = stmt.get_int64(1);
-    std::string cached_status = stmt.get_text(3);
+    int64_t cached_mtime = entry->mtime;
+    int64_t cached_size = entry->size;
+    const std::string& cached_status = entry->install_status;
 
     spdlog::info("BlueprintCache::get: found '{}' with status='{}' (mtime match={}, size match={})",
                  normalized, cached_status, cached_mtime == mtime, cached_size == size);
@@ -89,7 +112,31 @@ std::optional<std::string> BlueprintCache::get(std::string_view path, int64_t mt
         return std::nullopt;
     }
 
-    return stmt.get_text(2);
+    return std::move(entry->xml);
+}
+
+std::optional<BlueprintCache::Entry> BlueprintCache::lookup(const std::string& normalized)
+{
+    if (m_preloaded && normalized.starts_with(m_preload_prefix))
+    {
+        auto it = m_entries.find(normalized);
+        if (it == m_entries.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    pnq::sqlite::Statement stmt{ m_db, "SELECT mtime, size, xml, install_status FROM blueprints WHERE path = ?" };
+    stmt.bind(normalized);
+
+    if (!stmt.execute() || stmt.is_empty())
+        return std::nullopt;
+
+    Entry entry;
+    entry.mtime = stmt.get_int64(0);
+    entry.size = stmt.get_int64(1);
+    entry.xml = stmt.get_text(2);
+    entry.install_status = stmt.get_text(3);
+    return entry;
 }
 
 bool BlueprintCache::put(std::string_view path, int64_t mtime, int64_t size, std::string_view xml, InstallStatus install_status)
@@ -99,6 +146,16 @@ bool BlueprintCache::put(std::string_view path, int64_t mtime, int64_t size, std
 
     const auto normalized{ normalize_path(path) };
 
+    Entry entry{ mtime, size, std::string{ xml }, std::string{ as_string(install_status) } };
+    if (m_preloaded && normalized.starts_with(m_preload_prefix))
+        m_entries[normalized] = entry;
+
+    if (m_batching)
+    {
+        m_pending_writes.push_back({ normalized, std::move(entry) });
+        return true;
+    }
+
     pnq::sqlite::Statement stmt{ m_db,
         "INSERT OR REPLACE INTO blueprints (path, mtime, size, xml, install_status) VALUES (?, ?, ?, ?, ?)" };
     stmt.bind(normalized);
@@ -109,13 +166,171 @@ bool BlueprintCache::put(std::string_view path, int64_t mtime, int64_t size, std
     return stmt.execute();
 }
 
+size_t BlueprintCache::preload(std::string_view path_prefix)
+{
+    m_preloaded = false;
+    m_entries.clear();
+    if (!is_open())
+        return 0;
+
+    m_preload_prefix = normalize_path(path_prefix);
+
+    // The statement wrapper only exposes the first result row, so each page of rows comes
+    // back as one string. Every field is written as "<byte length>:<bytes>": no content
+    // (XML included) can be mistaken for a separator, and COALESCE keeps rows with NULL
+    // columns, which concatenation would otherwise turn into NULL and group_concat drop.
+    // Pages are keyed by path, so at most PRELOAD_PAGE_SIZE rows are held as one string.
+    const auto field = [](const char* column, const char* empty) {
+        const std::string value = std::format("COALESCE({}, {})", column, empty);
+        return std::format("length(CAST({0} AS BLOB)) || ':' || {0}", value);
+    };
+    const std::string sql = std::format(
+        "SELECT count(*), group_concat({} || {} || {} || {} || {}, '') FROM "
+        "(SELECT path, mtime, size, install_status, xml FROM blueprints "
+        "WHERE substr(path, 1, ?) = ? AND path > ? ORDER BY path LIMIT ?)",
+        field("path", "''"), field("mtime", "0"), field("size", "0"), field("install_status", "''"), field("xml", "''"));
+
+    std::string after;  // Largest path of the previous page
+    for (;;)
+    {
+        pnq::sqlite::Statement stmt{ m_db, sql };
+        stmt.bind(static_cast<int64_t>(m_preload_prefix.size()));
+        stmt.bind(m_preload_prefix);
+        stmt.bind(after);
+        stmt.bind(static_cast<int64_t>(PRELOAD_PAGE_SIZE));
+
+        if (!stmt.execute() || stmt.is_empty())
+        {
+            spdlog::warn("BlueprintCache: preload failed: {}", m_db.last_error());
+            m_entries.clear();
+            return 0;
+        }
+
+        const int64_t rows = stmt.get_int64(0);
+        const std::string page = rows > 0 ? stmt.get_text(1) : std::string{};
+        std::string_view rest{ page };
+        int64_t parsed = 0;
+        while (!rest.empty())
+        {
+            std::string_view fields[5];
+            for (auto& value : fields)
+            {
+                const size_t colon = rest.find(':');
+                size_t length = 0;
+                const auto [end, ec] = std::from_chars(rest.data(), rest.data() + std::min(colon, rest.size()), length);
+                if (colon == std::string_view::npos || ec != std::errc{} || end != rest.data() + colon ||
+                    length > rest.size() - colon - 1)
+                {
+                    spdlog::error("BlueprintCache: preload got a malformed record after '{}', falling back to single lookups", after);
+                    m_entries.clear();
+                    return 0;
+                }
+                value = rest.substr(colon + 1, length);
+                rest.remove_prefix(colon + 1 + length);
+            }
+
+            Entry entry;
+            std::from_chars(fields[1].data(), fields[1].data() + fields[1].size(), entry.mtime);
+            std::from_chars(fields[2].data(), fields[2].data() + fields[2].size(), entry.size);
+            entry.install_status = fields[3];
+            entry.xml = fields[4];
+            // group_concat() does not promise to keep the subquery's order
+            if (fields[0] > after)
+                after = fields[0];
+            m_entries.emplace(std::string{ fields[0] }, std::move(entry));
+            ++parsed;
+        }
+
+        if (parsed != rows)
+        {
+            spdlog::error("BlueprintCache: preload parsed {} of {} records after '{}', falling back to single lookups",
+                parsed, rows, after);
+            m_entries.clear();
+            return 0;
+        }
+        if (rows < static_cast<int64_t>(PRELOAD_PAGE_SIZE))
+            break;
+    }
+
+    m_preloaded = true;
+    spdlog::info("BlueprintCache: preloaded {} entries below '{}'", m_entries.size(), m_preload_prefix);
+    return m_entries.size();
+}
+
+void BlueprintCache::begin_batch()
+{
+    m_batching = true;
+}
+
+bool BlueprintCache::commit_batch()
+{
+    m_batching = false;
+    if (m_pending_writes.empty())
+        return true;
+
+    auto writes = std::move(m_pending_writes);
+    m_pending_writes.clear();
+    if (!is_open())
+        return false;
+
+    // Multi-row INSERTs: one statement per chunk instead of one per entry.
+    // 100 rows bind 500 parameters, well within SQLite's limit.
+    constexpr size_t ROWS_PER_STATEMENT = 100;
+
+    if (!m_db.execute("BEGIN IMMEDIATE"))
+    {
+        spdlog::error("BlueprintCache: failed to start batch transaction: {}", m_db.last_error());
+        return false;
+    }
+
+    bool ok = true;
+    for (size_t first = 0; ok && first < writes.size(); first += ROWS_PER_STATEMENT)
+    {
+        const size_t count = std::min(ROWS_PER_STATEMENT, writes.size() - first);
+
+        std::string sql{ "INSERT OR REPLACE INTO blueprints (path, mtime, size, xml, install_status) VALUES " };
+        for (size_t i = 0; i < count; ++i)
+            sql += i ? ", (?, ?, ?, ?, ?)" : "(?, ?, ?, ?, ?)";
+
+        pnq::sqlite::Statement stmt{ m_db, sql };
+        for (size_t i = first; i < first + count; ++i)
+        {
+            const auto& write = writes[i];
+            stmt.bind(write.path);
+            stmt.bind(write.entry.mtime);
+            stmt.bind(write.entry.size);
+            stmt.bind(write.entry.xml);
+            stmt.bind(write.entry.install_status);
+        }
+        ok = stmt.execute();
+    }
+
+    if (!ok || !m_db.execute("COMMIT"))
+    {
+        spdlog::error("BlueprintCache: batch write of {} entries failed: {}", writes.size(), m_db.last_error());
+        m_db.execute("ROLLBACK");
+        return false;
+    }
+
+    spdlog::info("BlueprintCache: wrote {} entries in one transaction", writes.size());
+    return true;
+}
+
 bool BlueprintCache::update_install_status(std::string_view path, InstallStatus install_status)
 {
     if (!is_open())
         return false;
 
+    commit_batch();
     const auto normalized{ normalize_path(path) };
 
+    if (m_preloaded)
+    {
+        auto it = m_entries.find(normalized);
+        if (it != m_entries.end())
+            it->second.install_status = as_string(install_status);
+    }
+
     pnq::sqlite::Statement stmt{ m_db,
         "UPDATE blueprints SET install_status = ? WHERE path = ?" };
     stmt.bind(as_string(install_status));
@@ -128,6 +343,11 @@ int BlueprintCache::mark_all_instances_not_installed(std::string_view project_na
     if (!is_open())
         return 0;
 
+    // Bulk update in SQL; drop the in-memory copy rather than replicate the match
+    commit_batch();
+    m_preloaded = false;
+    m_entries.clear();
+
     // Only update .zip files (instances), never .xml files (projects)
     // Use INSTR for more reliable matching - looks for name="ProjectName" in XML
     std::string search_str = std::format("name=\"{}\"", project_name);
@@ -152,7 +372,9 @@ void BlueprintCache::remove(std::string_view path)
     if (!is_open())
         return;
 
+    commit_batch();
     std::string normalized = normalize_path(path);
+    m_entries.erase(normalized);
 
     pnq::sqlite::Statement stmt{ m_db, "DELETE FROM blueprints WHERE path = ?" };
     stmt.bind(normalized);
@@ -164,12 +386,21 @@ void BlueprintCache::clear()
     if (!is_open())
         return;
 
+    m_batching = false;
+    m_pending_writes.clear();
+    m_entries.clear();
     m_db.execute("DELETE FROM blueprints");
     spdlog::info("BlueprintCache: cleared all entries");
 }
 
 std::string BlueprintCache::default_path()
 {
+    {
+        std::lock_guard lock{g_default_path_mutex};
+        if (!g_default_path_override.empty())
+            return g_default_path_override;
+    }
+
     char localappdata[MAX_PATH];
     if (SUCCEEDED(SHGetFolderPathA(nullptr, CSIDL_LOCAL_APPDATA, nullptr, 0, localappdata)))
     {
@@ -178,6 +409,12 @@ std::string BlueprintCache::default_path()
     return "cache.db";
 }
 
+void BlueprintCache::set_default_path(std::string path)
+{
+    std::lock_guard lock{g_default_path_mutex};
+    g_default_path_override = std::move(path);
+}
+
 void BlueprintCache::ensure_schema()
 {
     if (!m_db.table_exists("blueprints"))
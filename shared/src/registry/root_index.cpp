@@ -0,0 +1,213 @@
+#include "pch.h"
+#include <insti/registry/root_index.h>
+#include <insti/core/file_io.h>
+#include <algorithm>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+namespace insti
+{
+
+	namespace fs = std::filesystem;
+
+	namespace
+	{
+		/// Format version written to the root element; other versions are ignored.
+		constexpr const char* INDEX_VERSION = "1";
+
+		/// Retry interval while waiting for the lock or for a reader to close the index.
+		constexpr std::chrono::milliseconds RETRY_INTERVAL{ 50 };
+
+		/// Exclusive lock on a root's index, held for one read-merge-write cycle.
+		///
+		/// The lock file is opened without sharing, so a second writer (also on another
+		/// machine: SMB enforces share modes on the server) fails to open it until the
+		/// first one closes it. It is deleted on close, also if the process dies.
+		class IndexLock final
+		{
+			PNQ_DECLARE_NON_COPYABLE(IndexLock)
+
+		public:
+			IndexLock(const fs::path& root, const std::atomic<bool>* cancel)
+			{
+				const auto path = root / (std::string{ RootIndex::FILE_NAME } + ".lock");
+				const auto deadline = std::chrono::steady_clock::now() + RootIndex::LOCK_TIMEOUT;
+				for (;;)
+				{
+					m_handle = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+						FILE_ATTRIBUTE_HIDDEN | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+					if (m_handle != INVALID_HANDLE_VALUE)
+						return;
+
+					// Held by another writer, or being deleted by one that just finished (access
+					// denied on an existing file). Access denied otherwise means a read-only root.
+					const DWORD error = GetLastError();
+					const bool busy = error == ERROR_SHARING_VIOLATION ||
+						(error == ERROR_ACCESS_DENIED && GetFileAttributesW(path.c_str()) != INVALID_FILE_ATTRIBUTES);
+					if (!busy || std::chrono::steady_clock::now() >= deadline || (cancel && *cancel))
+					{
+						spdlog::info("RootIndex: cannot lock {}: {}", path.string(),
+							std::system_category().message(static_cast<int>(error)));
+						return;
+					}
+					std::this_thread::sleep_for(RETRY_INTERVAL);
+				}
+			}
+
+			~IndexLock()
+			{
+				if (m_handle != INVALID_HANDLE_VALUE)
+					CloseHandle(m_handle);
+			}
+
+			bool locked() const { return m_handle != INVALID_HANDLE_VALUE; }
+
+		private:
+			HANDLE m_handle = INVALID_HANDLE_VALUE;
+		};
+
+		std::string serialize(const RootIndex::Entries& entries)
+		{
+			// Sorted, so that the file only changes where entries do
+			std::vector<const RootIndex::Entry*> sorted;
+			sorted.reserve(entries.size());
+			for (const auto& [key, entry] : entries)
+				sorted.push_back(&entry);
+			std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->path < b->path; });
+
+			pugi::xml_document doc;
+			auto root = doc.append_child("insti-index");
+			root.append_attribute("version") = INDEX_VERSION;
+			for (const auto* entry : sorted)
+			{
+				auto node = root.append_child("snapshot");
+				node.append_attribute("path") = entry->path.c_str();
+				node.append_attribute("project") = entry->project.c_str();
+				node.append_attribute("size") = static_cast<long long>(entry->size);
+				node.append_attribute("mtime") = static_cast<long long>(entry->mtime);
+				node.text().set(entry->xml.c_str());
+			}
+
+			std::ostringstream oss;
+			doc.save(oss, "    ");
+			return oss.str();
+		}
+	} // anonymous namespace
+
+	std::string RootIndex::key(std::string_view rel_path)
+	{
+		return pnq::string::lowercase(std::string{ rel_path });
+	}
+
+	std::optional<std::string> RootIndex::relative_path(const fs::path& root, const fs::path& file)
+	{
+		const auto rel = file.lexically_normal().lexically_relative(root.lexically_normal());
+		if (rel.empty() || *rel.begin() == "..")
+			return std::nullopt;
+		return rel.generic_string();
+	}
+
+	RootIndex::Entries RootIndex::load(const fs::path& root)
+	{
+		Entries entries;
+
+		// Read through a handle that shares delete access, so writers can replace the
+		// index while it is being read
+		const auto path = root / FILE_NAME;
+		auto file = FileIo::read_file(path);
+		if (!file.ok)
+		{
+			spdlog::debug("RootIndex: no index at {}: {}", path.string(), file.error);
+			return entries;
+		}
+
+		pugi::xml_document doc;
+		if (!doc.load_buffer(file.data.data(), file.data.size()))
+		{
+			spdlog::warn("RootIndex: cannot parse {}", path.string());
+			return entries;
+		}
+
+		auto index = doc.child("insti-index");
+		if (std::string_view{ index.attribute("version").as_string() } != INDEX_VERSION)
+		{
+			spdlog::warn("RootIndex: ignoring {} (unknown version)", path.string());
+			return entries;
+		}
+
+		for (auto node : index.children("snapshot"))
+		{
+			Entry entry;
+			entry.path = node.attribute("path").as_string();
+			entry.project = node.attribute("project").as_string();
+			entry.size = node.attribute("size").as_llong();
+			entry.mtime = node.attribute("mtime").as_llong();
+			entry.xml = node.text().as_string();
+			if (entry.path.empty() || entry.xml.empty())
+				continue;
+			entries[key(entry.path)] = std::move(entry);
+		}
+
+		spdlog::info("RootIndex: {} entries in {}", entries.size(), path.string());
+		return entries;
+	}
+
+	bool RootIndex::update(const fs::path& root, const std::vector<Entry>& upserts, const std::vector<std::string>& removals,
+		const std::atomic<bool>* cancel)
+	{
+		if (upserts.empty() && removals.empty())
+			return true;
+
+		IndexLock lock{ root, cancel };
+		if (!lock.locked())
+			return false;
+
+		// Merge into what is on disk now, not what the caller read earlier: another
+		// writer may have added entries in the meantime
+		auto entries = load(root);
+		for (const auto& rel_path : removals)
+		{
+			// The caller's scan may predate a backup that has just written this archive
+			std::error_code ec;
+			if (!fs::exists(root / fs::path{ rel_path }, ec) && !ec)
+				entries.erase(key(rel_path));
+		}
+		for (const auto& entry : upserts)
+			entries[key(entry.path)] = entry;
+
+		const std::string text = serialize(entries);
+		const auto path = root / FILE_NAME;
+		const auto temp = root / std::format("{}.{}-{:x}.tmp", FILE_NAME, GetCurrentProcessId(), GetCurrentThreadId());
+
+		const auto error = FileIo::write_file(temp, { reinterpret_cast<const uint8_t*>(text.data()), text.size() }, 0);
+		if (!error.empty())
+		{
+			spdlog::warn("RootIndex: cannot write {}: {}", temp.string(), error);
+			std::error_code ec;
+			fs::remove(temp, ec);
+			return false;
+		}
+
+		// Readers that do not share delete access (scanners, editors) briefly block the replace
+		const auto deadline = std::chrono::steady_clock::now() + LOCK_TIMEOUT;
+		while (!MoveFileExW(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		{
+			const DWORD error_code = GetLastError();
+			if ((error_code != ERROR_SHARING_VIOLATION && error_code != ERROR_ACCESS_DENIED) ||
+				std::chrono::steady_clock::now() >= deadline || (cancel && *cancel))
+			{
+				spdlog::warn("RootIndex: cannot replace {}: {}", path.string(),
+					std::system_category().message(static_cast<int>(error_code)));
+				std::error_code ec;
+				fs::remove(temp, ec);
+				return false;
+			}
+			std::this_thread::sleep_for(RETRY_INTERVAL);
+		}
+
+		spdlog::info("RootIndex: wrote {} entries to {}", entries.size(), path.string());
+		return true;
+	}
+
+} // namespace insti
@@ -1,10 +1,19 @@
 #include "pch.h"
 #include <insti/registry/snapshot_registry.h>
 #include <insti/core/blueprint.h>
+#include <insti/core/directory_scanner.h>
+#include <insti/core/file_time.h>
+#include <insti/core/thread_pool.h>
+#include <insti/registry/root_index.h>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_set>
 
 namespace insti
@@ -49,8 +58,41 @@ namespace insti
 
 		// Only mark as Installed if nothing else is installed for this project
 		// (i.e., this is a fresh backup capturing current state, not a re-backup)
-		initialize_instance_blueprint(dir_entry,
-			already_installed ? InstallStatus::NotInstalled : InstallStatus::Installed);
+		if (!initialize_instance_blueprint(dir_entry,
+			already_installed ? InstallStatus::NotInstalled : InstallStatus::Installed))
+			return;
+
+		update_root_index(dir_entry);
+	}
+
+	void SnapshotRegistry::update_root_index(const fs::directory_entry& dir_entry)
+	{
+		for (const auto& root : m_roots)
+		{
+			if (root.empty())
+				continue;
+
+			const auto rel_path = RootIndex::relative_path(root, dir_entry.path());
+			if (!rel_path)
+				continue;
+
+			auto* instance = find_instance_for_path(dir_entry.path().string());
+			if (!instance)
+				return;
+
+			std::error_code ec;
+			RootIndex::Entry entry;
+			entry.path = *rel_path;
+			entry.mtime = FileTime::to_time_t(dir_entry.last_write_time(ec));
+			entry.size = static_cast<int64_t>(dir_entry.file_size(ec));
+			entry.project = instance->project_name();
+			entry.xml = instance->to_xml();
+			PNQ_RELEASE(instance);
+
+			RootIndex::update(root, { entry });
+			return;
+		}
+		spdlog::debug("update_root_index: '{}' is not below a registry root", dir_entry.path().string());
 	}
 
 	void SnapshotRegistry::on_restore_complete(std::string_view project_name, std::string_view output_path)
@@ -100,97 +142,405 @@ namespace insti
 		}
 	}
 
-	bool SnapshotRegistry::initialize()
+	namespace
 	{
-		ensure_cache();
+		/// Cache key timestamp: seconds on the file_clock, as stored by earlier versions.
+		int64_t cache_mtime(fs::file_time_type ftime)
+		{
+			return std::chrono::duration_cast<std::chrono::seconds>(ftime.time_since_epoch()).count();
+		}
 
-		std::error_code ec;
+		/// Same for a time_t reported by DirectoryScanner.
+		int64_t cache_mtime(int64_t unix_time)
+		{
+			return cache_mtime(std::chrono::clock_cast<std::chrono::file_clock>(
+				std::chrono::system_clock::from_time_t(static_cast<time_t>(unix_time))));
+		}
 
-		for (const auto& root : m_roots)
+		/// File below a registry root, with the cache lookup done and the blueprint
+		/// to be parsed on a worker.
+		struct Candidate
 		{
-			if (root.empty())
-				continue;
+			std::string path;
+			int64_t mtime = 0;
+			int64_t size = 0;
+			bool is_project = false;
+			InstallStatus install_status = InstallStatus::Unknown;
+			int64_t unix_mtime = 0;    ///< mtime as time_t, as kept in the root index
+			std::optional<std::string> cached_xml;
+			bool from_cache = false;   ///< Parsed from cached_xml (no cache write needed)
+			bool from_index = false;   ///< cached_xml came from the root index (cache write needed)
+			bool indexed = false;      ///< Root index has a current entry for this archive
+			Project* project = nullptr;
+			Instance* instance = nullptr;
+		};
+
+		/// Parse a candidate, preferring the cached XML. Runs on a worker thread.
+		void load_candidate(Candidate& c)
+		{
+			if (c.is_project)
+			{
+				if (c.cached_xml)
+				{
+					c.project = Project::load_from_string(*c.cached_xml, c.path);
+					c.from_cache = c.project != nullptr;
+				}
+				if (!c.project)
+					c.project = Project::load_from_file(c.path);
+				return;
+			}
 
-			fs::path root_path{ root };
-			if (!fs::exists(root_path, ec) || !fs::is_directory(root_path, ec))
-				continue;
+			if (c.cached_xml)
+			{
+				c.instance = Instance::load_from_string(*c.cached_xml, c.path);
+				c.from_cache = c.instance != nullptr;
+				// Cache was corrupt/invalid, fall through to reload
+			}
+			if (!c.instance)
+				c.instance = Instance::load_from_archive(c.path);
+			if (c.instance)
+				c.instance->m_install_status = c.install_status;
+		}
+	} // anonymous namespace
+
+	namespace
+	{
+		/// Joins the loaders of destroyed registries on a thread of its own.
+		///
+		/// The cancel flag cannot interrupt a loader blocked on a slow share or inside an
+		/// archive open, and the GUI replaces its registry on the UI thread. Jobs left at
+		/// exit are finished in the destructor: loaders use spdlog, SQLite and thread pools,
+		/// which must outlive them. Created on first use, i.e. after spdlog, so it is
+		/// destroyed before spdlog.
+		class LoaderReaper final
+		{
+			PNQ_DECLARE_NON_COPYABLE(LoaderReaper)
 
-			// Recursively find all .xml files
-			for (const auto& dir_entry : fs::recursive_directory_iterator(root_path, ec))
+		public:
+			static LoaderReaper& instance()
+			{
+				static LoaderReaper reaper;
+				return reaper;
+			}
+
+			void post(std::move_only_function<void()> job)
 			{
-				if (ec)
 				{
-					spdlog::warn("Error iterating {}: {}", root, ec.message());
-					break;
+					std::lock_guard lock{ m_mutex };
+					m_jobs.push_back(std::move(job));
 				}
+				m_job_available.notify_one();
+			}
 
-				if (!dir_entry.is_regular_file())
-					continue;
+		private:
+			LoaderReaper()
+				: m_thread{ [this]() { run(); } }
+			{
+			}
 
-				const auto& path = dir_entry.path();
-				const auto ext = pnq::string::lowercase(path.extension().string());
-				if (ext == ".xml")
+			~LoaderReaper()
+			{
 				{
-					initialize_project_blueprint(dir_entry);
+					std::lock_guard lock{ m_mutex };
+					m_stopping = true;
 				}
-				else if (ext == ".zip")
+				m_job_available.notify_one();
+				m_thread.join();
+			}
+
+			void run()
+			{
+				for (;;)
 				{
-					initialize_instance_blueprint(dir_entry, InstallStatus::Unknown);
+					std::move_only_function<void()> job;
+					{
+						std::unique_lock lock{ m_mutex };
+						m_job_available.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+						if (m_jobs.empty())
+							return;
+						job = std::move(m_jobs.front());
+						m_jobs.pop_front();
+					}
+					job();
 				}
 			}
-		}
 
-		// Sort by name
-		std::sort(m_instances.begin(), m_instances.end(), [](const Instance* a, const Instance* b) {
-			return a->project_name() < b->project_name();
-			});
+			std::mutex m_mutex;
+			std::condition_variable m_job_available;
+			std::deque<std::move_only_function<void()>> m_jobs;
+			bool m_stopping = false;
+			std::thread m_thread;  ///< Last member: started once the others exist
+		};
+	} // anonymous namespace
 
-		std::sort(m_projects.begin(), m_projects.end(), [](const Project* a, const Project* b) {
-			return a->project_name() < b->project_name();
-			});
-		return true;
+	SnapshotRegistry::~SnapshotRegistry()
+	{
+		*m_cancel = true;
+		if (m_loaders.empty())
+			return;
+
+		// Roots that were never published still hold references to their blueprints
+		LoaderReaper::instance().post([loaders = std::move(m_loaders), pending = std::move(m_pending)]() mutable {
+			for (auto& loader : loaders)
+				loader.join();
+			for (auto& root : pending)
+			{
+				auto contents = root.contents.get();
+				for (auto* bp : contents.projects)
+					PNQ_RELEASE(bp);
+				for (auto* bp : contents.instances)
+					PNQ_RELEASE(bp);
+			}
+		});
 	}
 
-	bool SnapshotRegistry::initialize_project_blueprint(const fs::directory_entry& dir_entry) const
+	SnapshotRegistry::RootContents SnapshotRegistry::load_root(const std::string& root, const std::atomic<bool>& cancel)
 	{
+		RootContents contents;
+
 		std::error_code ec;
-		std::string path_str = dir_entry.path().string();
-		int64_t mtime = std::chrono::duration_cast<std::chrono::seconds>(
-			dir_entry.last_write_time(ec).time_since_epoch()).count();
-		int64_t size = static_cast<int64_t>(dir_entry.file_size(ec));
+		const fs::path root_path{ root };
+		if (!fs::exists(root_path, ec) || !fs::is_directory(root_path, ec))
+			return contents;
+
+		DirectoryScanner scanner;
+		scanner.set_cancel_flag(&cancel);
+		scanner.set_file_filter([](std::string_view rel_path) {
+			const auto ext = pnq::string::lowercase(fs::path{ rel_path }.extension().string());
+			return ext == ".xml" || ext == ".zip";
+		});
+		auto scan = scanner.scan(root_path);
+		if (cancel)
+			return contents;
+		for (const auto& error : scan.errors)
+			spdlog::warn("Error iterating {}: {}", error.path.string(), error.message);
+
+		// Each root thread has its own connection; SQLite serializes the writers.
+		// One query answers all lookups for this root.
+		BlueprintCache cache;
+		cache.open_default();
+		cache.preload(root);
+
+		// Archives the local cache does not know are looked up in the root's index, so
+		// that a fresh cache does not mean opening every archive on the share
+		auto index = RootIndex::load(root_path);
+
+		std::vector<Candidate> candidates;
+		candidates.reserve(scan.files.size());
+		for (const auto& file : scan.files)
+		{
+			Candidate c;
+			c.path = file.path.string();
+			c.mtime = cache_mtime(file.mtime);
+			c.unix_mtime = file.mtime;
+			c.size = static_cast<int64_t>(file.size);
+			c.is_project = pnq::string::lowercase(file.path.extension().string()) == ".xml";
+			// get() sets install_status from the cache even if the XML is stale
+			c.cached_xml = cache.get(c.path, c.mtime, c.size, c.install_status);
+			if (!c.is_project)
+			{
+				const auto rel_path = RootIndex::relative_path(root_path, file.path);
+				const auto it = rel_path ? index.find(RootIndex::key(*rel_path)) : index.end();
+				if (it != index.end())
+				{
+					c.indexed = it->second.size == c.size && it->second.mtime == c.unix_mtime;
+					if (c.indexed && !c.cached_xml)
+					{
+						c.cached_xml = std::move(it->second.xml);
+						c.from_index = true;
+					}
+					index.erase(it);
+				}
+			}
+			candidates.push_back(std::move(c));
+		}
 
-		// Try cache first
-		InstallStatus install_status{ InstallStatus::Unknown };
-		auto cached_xml = m_cache.get(path_str, mtime, size, install_status);
-		if (cached_xml)
+		// Parsing (and on a cache miss, opening the archive) dominates; do it in parallel
 		{
-			// Parse from cached XML
-			const auto bp = Project::load_from_string(*cached_xml, path_str);
-			if (bp)
+			ThreadPool pool;
+			for (auto& c : candidates)
 			{
-				m_projects.push_back(bp);
-				return true;
+				pool.submit([&c, &cancel]() {
+					if (!cancel)
+						load_candidate(c);
+				});
 			}
+			pool.wait_idle();
 		}
 
-		// Cache miss or stale - load from file
-		const auto bp = Project::load_from_file(path_str);
-		if (bp)
+		if (cancel)
 		{
-			// Cache the serialized XML
-			m_cache.put(path_str, mtime, size, bp->to_xml(), InstallStatus::Unknown);
+			for (auto& c : candidates)
+			{
+				if (c.project)
+					PNQ_RELEASE(c.project);
+				if (c.instance)
+					PNQ_RELEASE(c.instance);
+			}
+			return contents;
+		}
+
+		// Cache updates for this root go out in a single transaction
+		std::vector<RootIndex::Entry> index_updates;
+		cache.begin_batch();
+		for (auto& c : candidates)
+		{
+			if (c.project)
+			{
+				if (!c.from_cache)
+					cache.put(c.path, c.mtime, c.size, c.project->to_xml(), InstallStatus::Unknown);
+				contents.projects.push_back(c.project);
+			}
+			else if (c.instance)
+			{
+				spdlog::info("load_root: '{}' -> status={} (from cache: {})",
+					c.path, as_string(c.install_status), c.from_index ? "index" : c.from_cache ? "hit" : "miss/stale");
+				if (!c.from_cache || c.from_index)
+					cache.put(c.path, c.mtime, c.size, c.instance->to_xml(), c.install_status);
+				if (!c.indexed || !c.from_cache)
+				{
+					RootIndex::Entry entry;
+					entry.path = RootIndex::relative_path(root_path, c.path).value_or(c.path);
+					entry.mtime = c.unix_mtime;
+					entry.size = c.size;
+					entry.project = c.instance->project_name();
+					entry.xml = c.instance->to_xml();
+					index_updates.push_back(std::move(entry));
+				}
+				contents.instances.push_back(c.instance);
+			}
+		}
+		cache.commit_batch();
+
+		// Repair the index: add archives it lacked or had stale, and drop entries whose
+		// archives are gone (unless part of the tree could not be listed)
+		std::vector<std::string> index_removals;
+		if (scan.errors.empty())
+		{
+			for (auto& [key, entry] : index)
+				index_removals.push_back(std::move(entry.path));
+		}
+		RootIndex::update(root_path, index_updates, index_removals, &cancel);
+
+		spdlog::info("Registry root '{}': {} project(s), {} instance(s)",
+			root, contents.projects.size(), contents.instances.size());
+		return contents;
+	}
+
+	bool SnapshotRegistry::initialize(std::chrono::milliseconds root_budget)
+	{
+		ensure_cache();
+
+		// One thread per root, so a slow share does not hold up the others. The threads
+		// belong to the registry (a std::async future would block in its destructor): a root
+		// that misses its budget keeps loading until published or the registry goes away.
+		std::vector<PendingRoot> started;
+		for (const auto& root : m_roots)
+		{
+			if (root.empty())
+				continue;
+
+			std::packaged_task<RootContents()> task{ [root, cancel = m_cancel]() { return load_root(root, *cancel); } };
+			started.push_back({ root, task.get_future() });
+			m_loaders.emplace_back(std::move(task));
+		}
+
+		// Roots run concurrently, so a common deadline gives each of them the full budget
+		const bool wait_for_all = root_budget == WAIT_FOR_ALL;
+		const auto deadline = wait_for_all ? std::chrono::steady_clock::time_point{} : std::chrono::steady_clock::now() + root_budget;
+		for (auto& pending : started)
+		{
+			if (wait_for_all)
+				pending.contents.wait();
+			if (pending.contents.wait_until(deadline) == std::future_status::ready)
+			{
+				auto contents = pending.contents.get();
+				merge(contents);
+			}
+			else
+			{
+				spdlog::warn("Registry root '{}' did not finish within {} ms, continuing in background",
+					pending.root, root_budget.count());
+				m_pending.push_back(std::move(pending));
+			}
+		}
+
+		sort_blueprints();
+		return true;
+	}
+
+	bool SnapshotRegistry::publish_pending()
+	{
+		bool changed = false;
+		for (auto it = m_pending.begin(); it != m_pending.end(); )
+		{
+			if (it->contents.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready)
+			{
+				++it;
+				continue;
+			}
+
+			auto contents = it->contents.get();
+			spdlog::info("Registry root '{}' finished loading", it->root);
+			changed |= !contents.projects.empty() || !contents.instances.empty();
+			merge(contents);
+			it = m_pending.erase(it);
+		}
+
+		if (changed)
+		{
+			sort_blueprints();
+			invalidate_installation_cache();
+		}
+		return changed;
+	}
+
+	std::vector<std::string> SnapshotRegistry::pending_roots() const
+	{
+		std::vector<std::string> result;
+		for (const auto& pending : m_pending)
+			result.push_back(pending.root);
+		return result;
+	}
+
+	void SnapshotRegistry::merge(RootContents& contents)
+	{
+		for (auto* bp : contents.projects)
 			m_projects.push_back(bp);
-			return true;
+
+		for (auto* bp : contents.instances)
+		{
+			// A backup may have added this snapshot while its root was still loading
+			auto* existing = find_instance_for_path(bp->m_snapshot_path);
+			if (existing)
+			{
+				PNQ_RELEASE(existing);
+				PNQ_RELEASE(bp);
+				continue;
+			}
+			m_instances.push_back(bp);
 		}
-		return false;
+
+		contents.projects.clear();
+		contents.instances.clear();
+	}
+
+	void SnapshotRegistry::sort_blueprints()
+	{
+		std::sort(m_instances.begin(), m_instances.end(), [](const Instance* a, const Instance* b) {
+			return a->project_name() < b->project_name();
+			});
+
+		std::sort(m_projects.begin(), m_projects.end(), [](const Project* a, const Project* b) {
+			return a->project_name() < b->project_name();
+			});
 	}
 
 	bool SnapshotRegistry::initialize_instance_blueprint(const fs::directory_entry& dir_entry, InstallStatus default_status) const
 	{
 		std::error_code ec;
 		std::string path_str = dir_entry.path().string();
-		int64_t mtime = std::chrono::duration_cast<std::chrono::seconds>(
-			dir_entry.last_write_time(ec).time_since_epoch()).count();
+		int64_t mtime = cache_mtime(dir_entry.last_write_time(ec));
 		int64_t size = static_cast<int64_t>(dir_entry.file_size(ec));
 
 		// Try cache first - this sets install_status from cache even if XML is stale
@@ -0,0 +1,341 @@
+#include "pch.h"
+#include <insti/snapshot/blob_store.h>
+#include <insti/core/sha256.h>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+namespace insti
+{
+
+namespace
+{
+
+/// Chunk size for streaming compress/decompress.
+constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+/// Unique temp name next to a blob, so concurrent writers never collide.
+std::filesystem::path temp_path_for(const std::filesystem::path& blob)
+{
+    auto tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    auto tmp = blob;
+    tmp += std::format(".{}-{:x}.tmp", GetCurrentProcessId(), tid);
+    return tmp;
+}
+
+} // anonymous namespace
+
+bool BlobStore::save_manifest(const std::filesystem::path& path, const SnapshotManifest& manifest)
+{
+    const std::string text = manifest.to_string();
+    const auto tmp = temp_path_for(path);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!out)
+        {
+            spdlog::error("Failed to write manifest: {}", tmp.string());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec)
+    {
+        spdlog::error("Failed to write manifest: {}: {}", path.string(), ec.message());
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool BlobStore::load_manifest(const std::filesystem::path& path, SnapshotManifest& manifest)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    const std::string text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    if (!manifest.parse(text))
+    {
+        spdlog::error("Invalid snapshot manifest: {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+std::filesystem::path BlobStore::blob_path(std::string_view hash) const
+{
+    return m_root / std::string{hash.substr(0, 2)} / std::string{hash};
+}
+
+bool BlobStore::contains(std::string_view hash) const
+{
+    std::error_code ec;
+    return std::filesystem::is_regular_file(blob_path(hash), ec);
+}
+
+bool BlobStore::put_file(const std::filesystem::path& src, std::string& hash, uint64_t& size, bool* deduplicated)
+{
+    if (deduplicated)
+        *deduplicated = false;
+
+    // Hash first: known content costs one read and no writes
+    hash = Sha256::of_file(src, &size);
+    if (hash.empty())
+    {
+        spdlog::error("Failed to hash file: {}", src.string());
+        return false;
+    }
+
+    if (contains(hash))
+    {
+        if (deduplicated)
+            *deduplicated = true;
+        return true;
+    }
+
+    // The file may change before it is read again: write_blob names the blob (and
+    // reports the hash) by what it actually stores
+    return write_blob(&src, nullptr, hash, size);
+}
+
+bool BlobStore::put_buffer(const std::vector<uint8_t>& data, std::string& hash)
+{
+    hash = Sha256::of_buffer(data.data(), data.size());
+    if (hash.empty())
+    {
+        spdlog::error("Failed to hash buffer");
+        return false;
+    }
+
+    if (contains(hash))
+        return true;
+
+    uint64_t size = 0;
+    return write_blob(nullptr, &data, hash, size);
+}
+
+bool BlobStore::write_blob(const std::filesystem::path* src, const std::vector<uint8_t>* data, std::string& hash, uint64_t& size)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_root, ec);
+
+    std::ifstream in;
+    if (src)
+    {
+        in.open(*src, std::ios::binary);
+        if (!in)
+        {
+            spdlog::error("Failed to open file for blob store: {}", src->string());
+            return false;
+        }
+    }
+
+    // The name is known only once all input has been hashed
+    const auto tmp = temp_path_for(m_root / "incoming");
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        spdlog::error("Failed to create blob: {}", tmp.string());
+        return false;
+    }
+
+    mz_stream stream{};
+    if (mz_deflateInit(&stream, m_compression_level) != MZ_OK)
+    {
+        spdlog::error("Failed to initialize deflate for blob store");
+        out.close();
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    Sha256 sha;
+    std::vector<uint8_t> in_buf(src ? CHUNK_SIZE : 0);
+    std::vector<uint8_t> out_buf(CHUNK_SIZE);
+    uint64_t consumed = 0;
+    bool ok = true;
+    bool input_done = false;
+
+    while (ok)
+    {
+        if (!input_done && stream.avail_in == 0)
+        {
+            // Input goes in CHUNK_SIZE pieces, so avail_in never truncates
+            size_t got = 0;
+            if (data)
+            {
+                got = std::min<size_t>(data->size() - consumed, CHUNK_SIZE);
+                stream.next_in = data->data() + consumed;
+                input_done = consumed + got == data->size();
+            }
+            else
+            {
+                in.read(reinterpret_cast<char*>(in_buf.data()), static_cast<std::streamsize>(in_buf.size()));
+                if (in.bad())
+                {
+                    ok = false;
+                    break;
+                }
+                got = static_cast<size_t>(in.gcount());
+                stream.next_in = in_buf.data();
+                input_done = in.eof();
+            }
+            stream.avail_in = static_cast<unsigned int>(got);
+            consumed += got;
+            if (!sha.update(stream.next_in, got))
+            {
+                ok = false;
+                break;
+            }
+        }
+
+        stream.next_out = out_buf.data();
+        stream.avail_out = static_cast<unsigned int>(out_buf.size());
+        const int status = mz_deflate(&stream, input_done ? MZ_FINISH : MZ_NO_FLUSH);
+        if (status != MZ_OK && status != MZ_STREAM_END && status != MZ_BUF_ERROR)
+        {
+            ok = false;
+            break;
+        }
+
+        out.write(reinterpret_cast<const char*>(out_buf.data()),
+                  static_cast<std::streamsize>(out_buf.size() - stream.avail_out));
+        if (!out)
+            ok = false;
+
+        if (status == MZ_STREAM_END)
+            break;
+    }
+
+    mz_deflateEnd(&stream);
+    out.close();
+
+    const std::string stored_hash = ok ? sha.finish() : std::string{};
+    if (!ok || !out || stored_hash.empty())
+    {
+        spdlog::error("Failed to write blob for {}", src ? src->string() : std::string{"buffer"});
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    if (stored_hash != hash)
+        spdlog::warn("Blob store: {} changed while being stored, recording the stored content",
+                     src ? src->string() : std::string{"buffer"});
+    hash = stored_hash;
+    size = consumed;
+
+    // Another writer may have stored the same content meanwhile; either copy is identical
+    const auto blob = blob_path(hash);
+    std::filesystem::create_directories(blob.parent_path(), ec);
+    std::filesystem::rename(tmp, blob, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        if (!contains(hash))
+        {
+            spdlog::error("Failed to commit blob {}", hash);
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> BlobStore::read(std::string_view hash, uint64_t size) const
+{
+    std::vector<uint8_t> result;
+    result.reserve(static_cast<size_t>(size));
+
+    const bool ok = stream(hash, size, [&result, size](const uint8_t* data, size_t len) {
+        if (result.size() + len > size)
+            return false;
+        result.insert(result.end(), data, data + len);
+        return true;
+    });
+    if (!ok)
+    {
+        spdlog::error("Corrupt blob: {}", hash);
+        return {};
+    }
+    return result;
+}
+
+bool BlobStore::stream(std::string_view hash, uint64_t size,
+                       const std::function<bool(const uint8_t*, size_t)>& sink) const
+{
+    std::ifstream in(blob_path(hash), std::ios::binary);
+    if (!in)
+    {
+        spdlog::error("Missing blob: {}", hash);
+        return false;
+    }
+
+    mz_stream stream{};
+    if (mz_inflateInit(&stream) != MZ_OK)
+        return false;
+
+    std::vector<uint8_t> in_buf(CHUNK_SIZE);
+    std::vector<uint8_t> out_buf(CHUNK_SIZE);
+    uint64_t delivered = 0;
+    bool ok = true;
+
+    while (ok)
+    {
+        if (stream.avail_in == 0 && !in.eof())
+        {
+            in.read(reinterpret_cast<char*>(in_buf.data()), static_cast<std::streamsize>(in_buf.size()));
+            stream.next_in = in_buf.data();
+            stream.avail_in = static_cast<unsigned int>(in.gcount());
+        }
+
+        stream.next_out = out_buf.data();
+        stream.avail_out = static_cast<unsigned int>(out_buf.size());
+        const int status = mz_inflate(&stream, MZ_NO_FLUSH);
+        const size_t produced = out_buf.size() - stream.avail_out;
+
+        // No progress with all input consumed means the blob is truncated
+        const bool stalled = status == MZ_BUF_ERROR && produced == 0 && stream.avail_in == 0 && in.eof();
+        if (stalled || (status != MZ_OK && status != MZ_STREAM_END && status != MZ_BUF_ERROR))
+        {
+            spdlog::error("Corrupt blob: {}", hash);
+            ok = false;
+            break;
+        }
+
+        if (produced > 0 && !sink(out_buf.data(), produced))
+        {
+            ok = false;
+            break;
+        }
+        delivered += produced;
+
+        if (status == MZ_STREAM_END)
+            break;
+    }
+
+    mz_inflateEnd(&stream);
+    return ok && delivered == size;
+}
+
+bool BlobStore::extract(std::string_view hash, uint64_t size, const std::filesystem::path& dest) const
+{
+    std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+
+    const bool ok = stream(hash, size, [&out](const uint8_t* data, size_t len) {
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(len));
+        return static_cast<bool>(out);
+    });
+    out.close();
+
+    if (!ok || !out)
+    {
+        spdlog::error("Failed to extract blob {} to {}", hash, dest.string());
+        return false;
+    }
+    return true;
+}
+
+} // namespace insti
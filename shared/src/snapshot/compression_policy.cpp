@@ -0,0 +1,146 @@
+#include "pch.h"
+#include <insti/snapshot/compression_policy.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace insti
+{
+
+namespace
+{
+
+/// Extensions of formats that are compressed (or encrypted) as a whole.
+/// Formats that merely may contain compressed parts (.pdf, .msi, .dll) are
+/// left to sampling.
+constexpr std::string_view COMPRESSED_EXTENSIONS[] = {
+    // Archives and packages
+    "7z", "apk", "bz2", "cab", "ear", "gz", "jar", "lz4", "lzma", "nupkg", "rar", "tgz", "txz", "war",
+    "xz", "zip", "zst",
+    // Office Open XML and OpenDocument (zip containers)
+    "docx", "odp", "ods", "odt", "pptx", "vsdx", "xlsx",
+    // Images
+    "avif", "gif", "heic", "jpeg", "jpg", "png", "webp",
+    // Audio and video
+    "aac", "avi", "flac", "m4a", "m4v", "mkv", "mov", "mp3", "mp4", "ogg", "opus", "webm", "wma", "wmv",
+    // Fonts
+    "woff", "woff2",
+};
+
+/// Leading bytes of compressed formats, at a given offset.
+struct Signature
+{
+    size_t offset;
+    std::string_view magic;
+};
+
+constexpr Signature SIGNATURES[] = {
+    {0, std::string_view{"PK\x03\x04", 4}},                // zip, jar, docx, nupkg ...
+    {0, std::string_view{"MSCF", 4}},                      // cab
+    {0, std::string_view{"\x89PNG", 4}},
+    {0, std::string_view{"\xFF\xD8\xFF", 3}},              // jpeg
+    {0, std::string_view{"GIF8", 4}},
+    {0, std::string_view{"7z\xBC\xAF\x27\x1C", 6}},
+    {0, std::string_view{"Rar!", 4}},
+    {0, std::string_view{"\x1F\x8B", 2}},                  // gzip
+    {0, std::string_view{"BZh", 3}},
+    {0, std::string_view{"\xFD" "7zXZ", 5}},
+    {0, std::string_view{"\x28\xB5\x2F\xFD", 4}},          // zstd
+    {0, std::string_view{"OggS", 4}},
+    {0, std::string_view{"fLaC", 4}},
+    {0, std::string_view{"ID3", 3}},                       // mp3
+    {0, std::string_view{"wOF2", 4}},
+    {4, std::string_view{"ftyp", 4}},                      // mp4, mov, heic, avif
+    {8, std::string_view{"WEBP", 4}},                      // RIFF....WEBP
+};
+
+bool has_compressed_extension(std::string_view name)
+{
+    const size_t dot = name.rfind('.');
+    if (dot == std::string_view::npos || name.find('/', dot) != std::string_view::npos)
+        return false;
+
+    const std::string_view ext = name.substr(dot + 1);
+    return std::any_of(std::begin(COMPRESSED_EXTENSIONS), std::end(COMPRESSED_EXTENSIONS), [ext](std::string_view known) {
+        return ext.size() == known.size() &&
+               std::equal(ext.begin(), ext.end(), known.begin(), [](char a, char b) {
+                   return (a >= 'A' && a <= 'Z' ? a - 'A' + 'a' : a) == b;
+               });
+    });
+}
+
+bool has_compressed_signature(std::span<const uint8_t> head)
+{
+    return std::any_of(std::begin(SIGNATURES), std::end(SIGNATURES), [head](const Signature& sig) {
+        return head.size() >= sig.offset + sig.magic.size() &&
+               std::memcmp(head.data() + sig.offset, sig.magic.data(), sig.magic.size()) == 0;
+    });
+}
+
+} // anonymous namespace
+
+CompressionPolicy::Reason CompressionPolicy::classify(std::string_view name, std::span<const uint8_t> head)
+{
+    if (has_compressed_extension(name))
+        return Reason::Extension;
+    if (has_compressed_signature(head))
+        return Reason::Signature;
+
+    const auto sample = head.first(std::min(head.size(), SAMPLE_SIZE));
+    if (sample.size() >= MIN_ENTROPY_SAMPLE && entropy(sample) > STORE_ENTROPY)
+        return Reason::Entropy;
+    return Reason::Compressible;
+}
+
+double CompressionPolicy::entropy(std::span<const uint8_t> data)
+{
+    if (data.empty())
+        return 0.0;
+
+    std::array<uint32_t, 256> counts{};
+    for (const uint8_t b : data)
+        ++counts[b];
+
+    const double total = static_cast<double>(data.size());
+    double bits = 0.0;
+    for (const uint32_t count : counts)
+    {
+        if (count)
+        {
+            const double p = count / total;
+            bits -= p * std::log2(p);
+        }
+    }
+    return bits;
+}
+
+std::string_view CompressionPolicy::reason_name(Reason reason)
+{
+    switch (reason)
+    {
+    case Reason::Compressible: return "deflated";
+    case Reason::Extension: return "extension";
+    case Reason::Signature: return "signature";
+    case Reason::Entropy: return "entropy";
+    case Reason::Ineffective: return "ineffective";
+    default: return "unknown";
+    }
+}
+
+void CompressionStats::add(CompressionPolicy::Reason reason, uint64_t size, uint64_t compressed_size)
+{
+    ++entries_by_reason[static_cast<size_t>(reason)];
+    if (reason == CompressionPolicy::Reason::Compressible)
+    {
+        ++deflated_entries;
+        deflated_bytes += size;
+        deflated_stored_bytes += compressed_size;
+    }
+    else
+    {
+        ++stored_entries;
+        stored_bytes += size;
+    }
+}
+
+} // namespace insti
@@ -0,0 +1,128 @@
+#include "pch.h"
+#include <insti/snapshot/manifest.h>
+#include <charconv>
+
+namespace insti
+{
+
+namespace
+{
+
+/// Split a manifest line on tabs (no stripping; empty fields are kept).
+std::vector<std::string_view> split_tabs(std::string_view line)
+{
+    std::vector<std::string_view> fields;
+    size_t start = 0;
+    while (true)
+    {
+        const size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string_view::npos ? std::string_view::npos : tab - start));
+        if (tab == std::string_view::npos)
+            return fields;
+        start = tab + 1;
+    }
+}
+
+template <typename T>
+bool parse_number(std::string_view text, T& value)
+{
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc{} && ptr == text.data() + text.size();
+}
+
+} // anonymous namespace
+
+void SnapshotManifest::add(ManifestEntry entry)
+{
+    auto it = m_index.find(entry.path);
+    if (it != m_index.end())
+    {
+        m_entries[it->second] = std::move(entry);
+        return;
+    }
+
+    m_index.emplace(entry.path, m_entries.size());
+    m_entries.push_back(std::move(entry));
+}
+
+const ManifestEntry* SnapshotManifest::find(std::string_view path) const
+{
+    auto it = m_index.find(std::string{path});
+    return it != m_index.end() ? &m_entries[it->second] : nullptr;
+}
+
+void SnapshotManifest::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+}
+
+std::string SnapshotManifest::to_string() const
+{
+    std::string text{HEADER};
+    text += '\n';
+    for (const auto& entry : m_entries)
+    {
+        if (entry.is_directory())
+            text += std::format("D\t{}\n", entry.path);
+        else
+            text += std::format("F\t{}\t{}\t{}\t{}\n", entry.hash, entry.size, entry.mtime, entry.path);
+    }
+    return text;
+}
+
+bool SnapshotManifest::parse(std::string_view text)
+{
+    clear();
+
+    bool header_seen = false;
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t eol = text.find('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = text.size();
+        std::string_view line = text.substr(pos, eol - pos);
+        pos = eol + 1;
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+
+        if (!header_seen)
+        {
+            if (line != HEADER)
+            {
+                spdlog::error("Not a snapshot manifest (header '{}')", line);
+                return false;
+            }
+            header_seen = true;
+            continue;
+        }
+
+        if (line.empty())
+            continue;
+
+        const auto fields = split_tabs(line);
+        ManifestEntry entry;
+        if (fields.size() == 2 && fields[0] == "D")
+        {
+            entry.path = fields[1];
+        }
+        else if (fields.size() == 5 && fields[0] == "F" && !fields[1].empty() &&
+                 parse_number(fields[2], entry.size) && parse_number(fields[3], entry.mtime))
+        {
+            entry.hash = fields[1];
+            entry.path = fields[4];
+        }
+        else
+        {
+            spdlog::error("Malformed manifest line: {}", line);
+            return false;
+        }
+        add(std::move(entry));
+    }
+
+    return header_seen;
+}
+
+} // namespace insti
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include <insti/snapshot/path_index.h>
+#include <algorithm>
+
+namespace insti
+{
+
+PathIndex::PathIndex()
+{
+    build({});
+}
+
+uint32_t PathIndex::intern(std::string_view name)
+{
+    if (const auto it = m_name_ids.find(name); it != m_name_ids.end())
+        return it->second;
+
+    const auto id = static_cast<uint32_t>(m_names.size());
+    m_names.emplace_back(name);
+    m_name_ids.emplace(m_names.back(), id);
+    return id;
+}
+
+void PathIndex::build(const std::vector<ArchiveEntry>& entries)
+{
+    m_names.clear();
+    m_name_ids.clear();
+    m_nodes.clear();
+    m_child_ids.clear();
+
+    // Pass 1: insert every component in archive order (ids are provisional)
+    intern("");
+    std::vector<Node> nodes{Node{ROOT, 0, 0, NO_ENTRY, true}};
+    std::unordered_map<uint64_t, NodeId> ids;
+    ids.reserve(entries.size());
+
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+        std::string_view rest{entries[index].path};
+        const bool is_dir = entries[index].is_directory || (!rest.empty() && rest.back() == '/');
+        if (!rest.empty() && rest.back() == '/')
+            rest.remove_suffix(1);
+
+        NodeId current = ROOT;
+        while (!rest.empty())
+        {
+            const size_t slash = rest.find('/');
+            const bool last = slash == std::string_view::npos;
+            const std::string_view component = rest.substr(0, slash);
+            rest = last ? std::string_view{} : rest.substr(slash + 1);
+            if (component.empty())
+                continue;
+
+            const uint32_t name = intern(component);
+            const auto [it, inserted] = ids.try_emplace(child_key(current, name), static_cast<NodeId>(nodes.size()));
+            if (inserted)
+                nodes.push_back({current, name, 0, NO_ENTRY, false});
+
+            Node& node = nodes[it->second];
+            if (!last || is_dir)
+                node.is_directory = true;
+            if (last)
+                node.entry = static_cast<uint32_t>(index);
+            current = it->second;
+        }
+    }
+
+    // Pass 2: group children by parent (counting sort) and order them by name
+    const size_t count = nodes.size();
+    std::vector<size_t> first_child(count + 1, 0);
+    for (size_t i = 1; i < count; ++i)
+        ++first_child[nodes[i].parent + 1];
+    for (size_t i = 1; i <= count; ++i)
+        first_child[i] += first_child[i - 1];
+
+    std::vector<NodeId> children(count > 0 ? count - 1 : 0);
+    {
+        auto fill = first_child;
+        for (size_t i = 1; i < count; ++i)
+            children[fill[nodes[i].parent]++] = static_cast<NodeId>(i);
+    }
+    for (size_t parent = 0; parent < count; ++parent)
+    {
+        std::sort(children.begin() + first_child[parent], children.begin() + first_child[parent + 1],
+                  [&](NodeId a, NodeId b) { return m_names[nodes[a].name] < m_names[nodes[b].name]; });
+    }
+
+    // Pass 3: depth-first renumbering, so every subtree is a contiguous id range
+    std::vector<NodeId> order;
+    order.reserve(count);
+    std::vector<NodeId> stack{ROOT};
+    while (!stack.empty())
+    {
+        const NodeId old_id = stack.back();
+        stack.pop_back();
+        order.push_back(old_id);
+        for (size_t i = first_child[old_id + 1]; i > first_child[old_id]; --i)
+            stack.push_back(children[i - 1]);
+    }
+
+    std::vector<NodeId> new_id(count);
+    for (size_t i = 0; i < count; ++i)
+        new_id[order[i]] = static_cast<NodeId>(i);
+
+    std::vector<NodeId> subtree_size(count, 1);
+    for (size_t i = count; i-- > 1;)
+        subtree_size[nodes[order[i]].parent] += subtree_size[order[i]];
+
+    m_nodes.resize(count);
+    m_child_ids.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Node& old = nodes[order[i]];
+        Node& node = m_nodes[i];
+        node = old;
+        node.parent = new_id[old.parent];
+        node.subtree_end = static_cast<NodeId>(i + subtree_size[order[i]]);
+        if (i != ROOT)
+            m_child_ids.emplace(child_key(node.parent, node.name), static_cast<NodeId>(i));
+    }
+}
+
+std::optional<PathIndex::NodeId> PathIndex::find(std::string_view path) const
+{
+    NodeId current = ROOT;
+    while (!path.empty())
+    {
+        const size_t slash = path.find('/');
+        const std::string_view component = path.substr(0, slash);
+        path = slash == std::string_view::npos ? std::string_view{} : path.substr(slash + 1);
+        if (component.empty())
+            continue;
+
+        const auto name = m_name_ids.find(component);
+        if (name == m_name_ids.end())
+            return std::nullopt;
+
+        const auto child = m_child_ids.find(child_key(current, name->second));
+        if (child == m_child_ids.end())
+            return std::nullopt;
+        current = child->second;
+    }
+    return current;
+}
+
+std::string PathIndex::path(NodeId id) const
+{
+    std::vector<std::string_view> parts;
+    for (; id != ROOT; id = m_nodes[id].parent)
+        parts.push_back(name(id));
+
+    std::string result;
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it)
+    {
+        if (!result.empty())
+            result += '/';
+        result += *it;
+    }
+    return result;
+}
+
+std::vector<std::string> PathIndex::children(NodeId id) const
+{
+    std::vector<std::string> result;
+    for (NodeId child = id + 1; child < m_nodes[id].subtree_end; child = m_nodes[child].subtree_end)
+        result.emplace_back(name(child));
+    return result;
+}
+
+void PathIndex::for_each_below(NodeId id, const std::function<void(NodeId, std::string_view)>& fn) const
+{
+    // Ancestors of the current node with the length of their relative path
+    std::vector<std::pair<NodeId, size_t>> ancestors{{id, 0}};
+    std::string rel;
+
+    for (NodeId node = id + 1; node < m_nodes[id].subtree_end; ++node)
+    {
+        while (ancestors.back().first != m_nodes[node].parent)
+            ancestors.pop_back();
+
+        rel.resize(ancestors.back().second);
+        if (!rel.empty())
+            rel += '/';
+        rel += name(node);
+
+        fn(node, rel);
+        ancestors.push_back({node, rel.size()});
+    }
+}
+
+} // namespace insti
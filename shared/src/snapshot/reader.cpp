@@ -1,126 +1,200 @@
 #include "pch.h"
 #include <insti/snapshot/reader.h>
+#include <aclapi.h>
+#include <sddl.h>
 
 namespace insti
 {
 
-void SnapshotReader::build_path_cache() const
+namespace
 {
-    if (m_cache_built)
-        return;
 
-    m_all_paths.clear();
-    m_directories.clear();
-    m_children.clear();
-    m_ordered_paths.clear();
-
-    auto paths = get_all_paths();
-    m_ordered_paths = paths;
+/// Copy of an entry with a directory's trailing '/' removed, as returned by entries().
+ArchiveEntry normalized_entry(const ArchiveEntry& entry)
+{
+    ArchiveEntry result = entry;
+    result.is_directory = entry.is_directory || (!entry.path.empty() && entry.path.back() == '/');
+    if (!result.path.empty() && result.path.back() == '/')
+        result.path.pop_back();
+    return result;
+}
 
-    // Root is always a directory
-    m_directories.insert("");
-    m_children[""] = {};
+} // anonymous namespace
 
-    for (const auto& path : paths)
+bool SnapshotReader::set_permissive_acl(const std::wstring& path)
+{
+    // SDDL: D:(A;;FA;;;WD) = DACL with Allow Full Access to Everyone (World)
+    PSECURITY_DESCRIPTOR pSD = nullptr;
+    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(
+            L"D:(A;;FA;;;WD)", SDDL_REVISION_1, &pSD, nullptr))
     {
-        m_all_paths.insert(path);
+        return false;
+    }
 
-        // Check if it's a directory (ends with /)
-        bool is_dir = !path.empty() && path.back() == '/';
-        std::string normalized = is_dir ? path.substr(0, path.size() - 1) : path;
+    BOOL daclPresent = FALSE, daclDefaulted = FALSE;
+    PACL pDacl = nullptr;
+    if (!GetSecurityDescriptorDacl(pSD, &daclPresent, &pDacl, &daclDefaulted))
+    {
+        LocalFree(pSD);
+        return false;
+    }
 
-        if (is_dir)
-            m_directories.insert(normalized);
+    DWORD result = SetNamedSecurityInfoW(
+        const_cast<LPWSTR>(path.c_str()),
+        SE_FILE_OBJECT,
+        DACL_SECURITY_INFORMATION | PROTECTED_DACL_SECURITY_INFORMATION,
+        nullptr, nullptr, pDacl, nullptr);
 
-        // Build parent chain
-        std::string current = normalized;
-        while (!current.empty())
-        {
-            size_t last_slash = current.rfind('/');
-            std::string parent = (last_slash == std::string::npos) ? "" : current.substr(0, last_slash);
-            std::string child_name = (last_slash == std::string::npos) ? current : current.substr(last_slash + 1);
+    LocalFree(pSD);
+    return result == ERROR_SUCCESS;
+}
 
-            // Add parent as directory
-            m_directories.insert(parent);
+bool SnapshotReader::read_stream(std::string_view path,
+                                 const std::function<bool(const uint8_t*, size_t)>& sink) const
+{
+    if (!exists(path) || is_directory(path))
+        return false;
 
-            // Add to parent's children (if not already)
-            auto& children = m_children[parent];
-            if (std::find(children.begin(), children.end(), child_name) == children.end())
-                children.push_back(child_name);
+    auto data = read_binary(path);
+    return data.empty() || sink(data.data(), data.size());
+}
 
-            current = parent;
+std::vector<ArchiveEntry> SnapshotReader::get_all_entries() const
+{
+    std::vector<ArchiveEntry> result;
+    for (auto& path : get_all_paths())
+    {
+        if (auto entry = stat(path))
+        {
+            entry->path = std::move(path);
+            result.push_back(std::move(*entry));
+        }
+        else
+        {
+            const bool is_dir = !path.empty() && path.back() == '/';
+            result.push_back({std::move(path), is_dir});
         }
     }
+    return result;
+}
+
+void SnapshotReader::build_path_cache() const
+{
+    if (m_cache_built)
+        return;
 
+    m_entries = get_all_entries();
+    m_index.build(m_entries);
     m_cache_built = true;
 }
 
 bool SnapshotReader::exists(std::string_view path) const
 {
     build_path_cache();
-
-    std::string path_str{path};
-    // Check direct match
-    if (m_all_paths.count(path_str))
-        return true;
-
-    // Check as directory (with trailing /)
-    if (m_all_paths.count(path_str + "/"))
-        return true;
-
-    // Check if it's a synthetic directory (parent of other entries)
-    return m_directories.count(path_str) > 0;
+    // Includes synthetic directories (parents of other entries)
+    return m_index.find(path).has_value();
 }
 
 bool SnapshotReader::is_directory(std::string_view path) const
 {
     build_path_cache();
-    // Normalize: strip trailing slash for lookup
-    std::string normalized{path};
-    if (!normalized.empty() && normalized.back() == '/')
-        normalized.pop_back();
-    return m_directories.count(normalized) > 0;
+    const auto id = m_index.find(path);
+    return id && m_index.is_directory(*id);
 }
 
 std::vector<std::string> SnapshotReader::list_dir(std::string_view path) const
 {
     build_path_cache();
+    const auto id = m_index.find(path);
+    if (id && m_index.is_directory(*id))
+        return m_index.children(*id);
+    return {};
+}
+
+const ArchiveEntry* SnapshotReader::find_entry(std::string_view path) const
+{
+    build_path_cache();
+    const auto id = m_index.find(path);
+    if (!id || !m_index.is_archive_entry(*id))
+        return nullptr;
+    return &m_entries[m_index.entry_index(*id)];
+}
 
-    // Normalize: strip trailing slash for lookup
-    std::string normalized{path};
-    if (!normalized.empty() && normalized.back() == '/')
-        normalized.pop_back();
+const std::vector<ArchiveEntry>& SnapshotReader::all_entries() const
+{
+    build_path_cache();
+    return m_entries;
+}
 
-    auto it = m_children.find(normalized);
-    if (it != m_children.end())
-        return it->second;
-    return {};
+void SnapshotReader::for_each_entry_below(std::string_view dir,
+                                          const std::function<void(std::string_view, const ArchiveEntry&)>& fn) const
+{
+    build_path_cache();
+    const auto id = m_index.find(dir);
+    if (!id || !m_index.is_directory(*id))
+        return;
+
+    m_index.for_each_below(*id, [&](PathIndex::NodeId node, std::string_view rel_path) {
+        if (m_index.is_archive_entry(node))
+            fn(rel_path, m_entries[m_index.entry_index(node)]);
+    });
 }
 
 std::string SnapshotReader::read_text(std::string_view path) const
+{
+    if (const auto data = view(path))
+        return decode_text(data->data(), data->size());
+
+    // Decompress straight into the result; only text with a BOM needs a second pass
+    if (const auto entry = stat(path); entry && !entry->is_directory)
+    {
+        std::string text(static_cast<size_t>(entry->size), '\0');
+        if (!read_into(path, {reinterpret_cast<uint8_t*>(text.data()), text.size()}))
+            return {};
+
+        const auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+        const bool has_bom = (text.size() >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) ||
+                             (text.size() >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE);
+        return has_bom ? decode_text(bytes, text.size()) : text;
+    }
+
+    auto data = read_binary(path);
+    return decode_text(data.data(), data.size());
+}
+
+bool SnapshotReader::read_into(std::string_view path, std::span<uint8_t> dest) const
 {
     auto data = read_binary(path);
-    if (data.empty())
+    if (data.size() != dest.size() || (data.empty() && !exists(path)))
+        return false;
+
+    std::copy(data.begin(), data.end(), dest.begin());
+    return true;
+}
+
+std::string SnapshotReader::decode_text(const uint8_t* data, size_t size)
+{
+    if (size == 0)
         return {};
 
     // Auto-detect encoding via BOM
-    if (data.size() >= 3 &&
+    if (size >= 3 &&
         data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF)
     {
         // UTF-8 with BOM - skip BOM
-        return std::string(reinterpret_cast<const char*>(data.data() + 3), data.size() - 3);
+        return std::string(reinterpret_cast<const char*>(data + 3), size - 3);
     }
-    else if (data.size() >= 2 &&
+    else if (size >= 2 &&
              data[0] == 0xFF && data[1] == 0xFE)
     {
         // UTF-16LE with BOM - convert to UTF-8
-        std::wstring_view wide(reinterpret_cast<const wchar_t*>(data.data() + 2),
-                               (data.size() - 2) / sizeof(wchar_t));
+        std::wstring_view wide(reinterpret_cast<const wchar_t*>(data + 2),
+                               (size - 2) / sizeof(wchar_t));
         return pnq::string::encode_as_utf8(wide);
     }
 
     // No BOM - assume UTF-8
-    return std::string(reinterpret_cast<const char*>(data.data()), data.size());
+    return std::string(reinterpret_cast<const char*>(data), size);
 }
 
 bool SnapshotReader::extract_directory_recursive(std::string_view archive_prefix, std::string_view dest_dir) const
@@ -142,73 +216,46 @@ bool SnapshotReader::extract_directory_recursive(std::string_view archive_prefix
         return false;
     }
 
-    // Iterate all paths, extract those under prefix
-    for (const auto& path : m_ordered_paths)
-    {
-        // Check if path starts with prefix
-        if (!path.starts_with(prefix))
-            continue;
-
-        // Get relative path (skip prefix + /)
-        std::string relative;
-        if (path.length() > prefix.length())
-        {
-            if (path[prefix.length()] == '/')
-                relative = path.substr(prefix.length() + 1);
-            else
-                continue; // Not a child, just similar prefix
-        }
-        else
-        {
-            continue; // Exact match of prefix itself
-        }
-
-        if (relative.empty())
-            continue;
-
-        // Build destination path
-        std::filesystem::path dest_path = std::filesystem::path{dest_dir} / relative;
+    const auto root = m_index.find(prefix);
+    if (!root || !m_index.is_directory(*root))
+        return true;
 
-        // Check if it's a directory (ends with /)
-        bool is_dir = !path.empty() && path.back() == '/';
+    // Depth-first order: every directory comes before its contents
+    bool ok = true;
+    m_index.for_each_below(*root, [&](PathIndex::NodeId node, std::string_view relative) {
+        if (!ok)
+            return;
 
-        if (is_dir)
+        const std::filesystem::path dest_path = std::filesystem::path{dest_dir} / relative;
+        if (m_index.is_directory(node))
         {
-            // Create directory
             std::filesystem::create_directories(dest_path, ec);
             if (ec)
             {
                 spdlog::error("Failed to create directory {}: {}", dest_path.string(), ec.message());
-                return false;
+                ok = false;
             }
+            return;
         }
-        else
+
+        const std::string path = prefix.empty() ? std::string{relative} : prefix + '/' + std::string{relative};
+        if (!extract_to_file(path, dest_path.string()))
         {
-            // Extract file
-            if (!extract_to_file(path, dest_path.string()))
-            {
-                spdlog::error("Failed to extract {}", path);
-                return false;
-            }
+            spdlog::error("Failed to extract {}", path);
+            ok = false;
         }
-    }
+    });
 
-    return true;
+    return ok;
 }
 
 std::vector<ArchiveEntry> SnapshotReader::entries() const
 {
     build_path_cache();
 
-    std::vector<ArchiveEntry> result;
-    result.reserve(m_ordered_paths.size());
-
-    for (const auto& path : m_ordered_paths)
-    {
-        bool is_dir = !path.empty() && path.back() == '/';
-        std::string normalized = is_dir ? path.substr(0, path.size() - 1) : path;
-        result.push_back({normalized, is_dir});
-    }
+    std::vector<ArchiveEntry> result = m_entries;
+    for (auto& entry : result)
+        entry = normalized_entry(entry);
     return result;
 }
 
@@ -222,10 +269,7 @@ SnapshotReader::Iterator::Iterator(const SnapshotReader* reader, size_t index)
 ArchiveEntry SnapshotReader::Iterator::operator*() const
 {
     m_reader->build_path_cache();
-    const auto& path = m_reader->m_ordered_paths[m_index];
-    bool is_dir = !path.empty() && path.back() == '/';
-    std::string normalized = is_dir ? path.substr(0, path.size() - 1) : path;
-    return {normalized, is_dir};
+    return normalized_entry(m_reader->m_entries[m_index]);
 }
 
 SnapshotReader::Iterator& SnapshotReader::Iterator::operator++()
@@ -260,13 +304,13 @@ SnapshotReader::Iterator SnapshotReader::begin() const
 SnapshotReader::Iterator SnapshotReader::end() const
 {
     build_path_cache();
-    return Iterator(this, m_ordered_paths.size());
+    return Iterator(this, m_entries.size());
 }
 
 size_t SnapshotReader::size() const
 {
     build_path_cache();
-    return m_ordered_paths.size();
+    return m_entries.size();
 }
 
 } // namespace insti
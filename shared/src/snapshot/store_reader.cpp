@@ -0,0 +1,154 @@
+#include "pch.h"
+#include <insti/snapshot/store_reader.h>
+
+namespace insti
+{
+
+StoreSnapshotReader::StoreSnapshotReader()
+    : m_open{false}
+{
+}
+
+StoreSnapshotReader::~StoreSnapshotReader()
+{
+    close();
+}
+
+bool StoreSnapshotReader::open(std::string_view path, std::string_view store_root)
+{
+    close();
+
+    m_path = std::string{path};
+    if (!BlobStore::load_manifest(m_path, m_manifest))
+    {
+        spdlog::error("Failed to open snapshot manifest: {}", path);
+        return false;
+    }
+
+    m_store = std::make_unique<BlobStore>(store_root.empty()
+        ? BlobStore::root_for_manifest(m_path)
+        : std::filesystem::path{std::string{store_root}});
+
+    m_open = true;
+    build_path_cache();  // Build cache immediately
+    return true;
+}
+
+SnapshotReader* StoreSnapshotReader::open_clone() const
+{
+    if (!m_open)
+        return nullptr;
+
+    auto* clone = new StoreSnapshotReader();
+    if (!clone->open(m_path, m_store->root().string()))
+    {
+        clone->release(REFCOUNT_DEBUG_ARGS);
+        return nullptr;
+    }
+    return clone;
+}
+
+void StoreSnapshotReader::close()
+{
+    m_open = false;
+    m_store.reset();
+    m_manifest.clear();
+}
+
+std::optional<ArchiveEntry> StoreSnapshotReader::stat(std::string_view path) const
+{
+    const auto* entry = find(path);
+    if (!entry)
+        return std::nullopt;
+
+    return ArchiveEntry{entry->path, entry->is_directory(), entry->size, entry->mtime, std::nullopt, entry->size};
+}
+
+std::vector<ArchiveEntry> StoreSnapshotReader::get_all_entries() const
+{
+    std::vector<ArchiveEntry> result;
+    result.reserve(m_manifest.size());
+    for (const auto& entry : m_manifest.entries())
+        result.push_back({entry.path, entry.is_directory(), entry.size, entry.mtime, std::nullopt, entry.size});
+    return result;
+}
+
+bool StoreSnapshotReader::read_stream(std::string_view path,
+                                      const std::function<bool(const uint8_t*, size_t)>& sink) const
+{
+    if (!m_open)
+        return false;
+
+    const auto* entry = find(path);
+    if (!entry || entry->is_directory())
+        return false;
+
+    return m_store->stream(entry->hash, entry->size, sink);
+}
+
+std::vector<std::string> StoreSnapshotReader::get_all_paths() const
+{
+    std::vector<std::string> result;
+    result.reserve(m_manifest.size());
+    for (const auto& entry : m_manifest.entries())
+        result.push_back(entry.path);
+    return result;
+}
+
+std::vector<uint8_t> StoreSnapshotReader::read_binary(std::string_view path) const
+{
+    if (!m_open)
+        return {};
+
+    const auto* entry = find(path);
+    if (!entry || entry->is_directory())
+        return {};
+
+    return m_store->read(entry->hash, entry->size);
+}
+
+bool StoreSnapshotReader::read_into(std::string_view path, std::span<uint8_t> dest) const
+{
+    if (!m_open)
+        return false;
+
+    const auto* entry = find(path);
+    if (!entry || entry->is_directory() || entry->size != dest.size())
+        return false;
+
+    size_t offset = 0;
+    return m_store->stream(entry->hash, entry->size, [&](const uint8_t* data, size_t size) {
+        if (size > dest.size() - offset)
+            return false;
+        std::copy(data, data + size, dest.begin() + offset);
+        offset += size;
+        return true;
+    });
+}
+
+bool StoreSnapshotReader::extract_to_file(std::string_view archive_path, std::string_view dest_path) const
+{
+    if (!m_open)
+        return false;
+
+    const auto* entry = find(archive_path);
+    if (!entry || entry->is_directory())
+        return false;
+
+    // Ensure parent directory exists
+    std::filesystem::path dest{dest_path};
+    if (dest.has_parent_path())
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dest.parent_path(), ec);
+    }
+
+    if (!m_store->extract(entry->hash, entry->size, dest))
+        return false;
+
+    // Set permissive ACL so non-admin users can access the files
+    set_permissive_acl(dest.wstring());
+    return true;
+}
+
+} // namespace insti
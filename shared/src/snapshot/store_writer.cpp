@@ -0,0 +1,152 @@
+#include "pch.h"
+#include <insti/snapshot/store_writer.h>
+#include <insti/snapshot/store_reader.h>
+#include <insti/core/file_time.h>
+#include <chrono>
+
+namespace insti
+{
+
+StoreSnapshotWriter::StoreSnapshotWriter()
+    : m_open{false}
+    , m_compression_level{1}
+    , m_deduplicated{0}
+{
+}
+
+StoreSnapshotWriter::~StoreSnapshotWriter()
+{
+    close();
+}
+
+bool StoreSnapshotWriter::create(std::string_view path, std::string_view store_root)
+{
+    close();
+
+    m_path = std::string{path};
+    std::filesystem::path root = store_root.empty()
+        ? BlobStore::root_for_manifest(m_path)
+        : std::filesystem::path{std::string{store_root}};
+
+    std::error_code ec;
+    std::filesystem::create_directories(root, ec);
+    if (ec)
+    {
+        spdlog::error("Failed to create blob store: {}: {}", root.string(), ec.message());
+        return false;
+    }
+
+    m_store = std::make_unique<BlobStore>(std::move(root), m_compression_level);
+    m_manifest.clear();
+    m_deduplicated = 0;
+    m_open = true;
+    return true;
+}
+
+void StoreSnapshotWriter::close()
+{
+    // Blobs written so far stay in the store; without a manifest nothing references them
+    m_open = false;
+    m_store.reset();
+    m_manifest.clear();
+}
+
+std::string StoreSnapshotWriter::normalize_path(std::string_view path) const
+{
+    std::string result{path};
+    for (char& c : result)
+        if (c == '\\') c = '/';
+    return result;
+}
+
+bool StoreSnapshotWriter::create_directory(std::string_view path)
+{
+    if (!m_open)
+        return false;
+
+    std::string normalized = normalize_path(path);
+    if (!normalized.empty() && normalized.back() != '/')
+        normalized += '/';
+
+    m_manifest.add({std::move(normalized), {}, 0, 0});
+    return true;
+}
+
+bool StoreSnapshotWriter::write_binary(std::string_view path, const std::vector<uint8_t>& data)
+{
+    if (!m_open)
+        return false;
+
+    ManifestEntry entry;
+    entry.path = normalize_path(path);
+    entry.size = data.size();
+    entry.mtime = static_cast<int64_t>(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+
+    if (!m_store->put_buffer(data, entry.hash))
+    {
+        spdlog::error("Failed to write to store: {}", path);
+        return false;
+    }
+
+    m_manifest.add(std::move(entry));
+    return true;
+}
+
+bool StoreSnapshotWriter::write_file(std::string_view archive_path, std::string_view src_path)
+{
+    if (!m_open)
+        return false;
+
+    const std::filesystem::path src{std::string{src_path}};
+
+    ManifestEntry entry;
+    entry.path = normalize_path(archive_path);
+    entry.mtime = FileTime::last_write_time(src);
+
+    // Unchanged content costs a read and no write
+    bool deduplicated = false;
+    if (!m_store->put_file(src, entry.hash, entry.size, &deduplicated))
+    {
+        spdlog::error("Failed to add file to store: {} -> {}", src_path, archive_path);
+        return false;
+    }
+    if (deduplicated)
+        ++m_deduplicated;
+
+    m_manifest.add(std::move(entry));
+    return true;
+}
+
+bool StoreSnapshotWriter::copy_entry(const SnapshotReader& source, std::string_view path)
+{
+    if (!m_open)
+        return false;
+
+    // A manifest from the same store already references the blob: copying is just the manifest line
+    const auto* store_source = dynamic_cast<const StoreSnapshotReader*>(&source);
+    if (!store_source || !store_source->is_open())
+        return false;
+
+    const auto* entry = store_source->find(normalize_path(path));
+    if (!entry || entry->is_directory() || !m_store->contains(entry->hash))
+        return false;
+
+    m_manifest.add(*entry);
+    ++m_deduplicated;
+    return true;
+}
+
+bool StoreSnapshotWriter::finalize()
+{
+    if (!m_open)
+        return false;
+
+    const bool ok = BlobStore::save_manifest(m_path, m_manifest);
+    if (ok)
+        spdlog::info("Snapshot {}: {} entries, {} already in store", m_path, m_manifest.size(), m_deduplicated);
+
+    close();
+    return ok;
+}
+
+} // namespace insti
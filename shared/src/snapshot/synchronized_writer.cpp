@@ -0,0 +1,102 @@
+#include "pch.h"
+#include <insti/snapshot/synchronized_writer.h>
+#include <insti/core/file_io.h>
+#include <insti/core/trace.h>
+
+namespace insti
+{
+
+SynchronizedSnapshotWriter::SynchronizedSnapshotWriter(SnapshotWriter* target)
+    : m_target{target}
+{
+    PNQ_ADDREF(m_target);
+}
+
+SynchronizedSnapshotWriter::~SynchronizedSnapshotWriter()
+{
+    PNQ_RELEASE(m_target);
+}
+
+bool SynchronizedSnapshotWriter::create_directory(std::string_view path)
+{
+    std::lock_guard lock{m_mutex};
+    return m_target->create_directory(path);
+}
+
+bool SynchronizedSnapshotWriter::write_binary(std::string_view path, const std::vector<uint8_t>& data)
+{
+    std::lock_guard lock{m_mutex};
+    return m_target->write_binary(path, data);
+}
+
+bool SynchronizedSnapshotWriter::write_file(std::string_view archive_path, std::string_view src_path)
+{
+    if (m_target->can_prepare())
+    {
+        const std::filesystem::path src{src_path};
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(src, ec);
+        if (!ec && size <= MAX_UNLOCKED_FILE_SIZE)
+        {
+            // Read and compress outside the lock; only the append is serialized
+            FileIo::Completion read;
+            {
+                TraceSpan trace{"io", "read", src};
+                read = FileIo::read_file(src);
+            }
+            if (!read.ok)
+            {
+                spdlog::error("Failed to read file for snapshot: {}: {}", src_path, read.error);
+                return false;
+            }
+            auto prepared = m_target->prepare(archive_path, std::move(read.data), read.mtime);
+
+            std::lock_guard lock{m_mutex};
+            return prepared && m_target->write_prepared(std::move(prepared));
+        }
+    }
+
+    // Too large to buffer (or not preparable): the target streams it under the lock
+    std::lock_guard lock{m_mutex};
+    return m_target->write_file(archive_path, src_path);
+}
+
+bool SynchronizedSnapshotWriter::write_buffer(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime)
+{
+    if (m_target->can_prepare())
+    {
+        auto prepared = m_target->prepare(archive_path, std::move(data), mtime);
+
+        std::lock_guard lock{m_mutex};
+        return prepared && m_target->write_prepared(std::move(prepared));
+    }
+
+    std::lock_guard lock{m_mutex};
+    return m_target->write_buffer(archive_path, std::move(data), mtime);
+}
+
+bool SynchronizedSnapshotWriter::finalize()
+{
+    std::lock_guard lock{m_mutex};
+    return m_target->finalize();
+}
+
+void SynchronizedSnapshotWriter::close()
+{
+    std::lock_guard lock{m_mutex};
+    m_target->close();
+}
+
+bool SynchronizedSnapshotWriter::is_open() const
+{
+    std::lock_guard lock{m_mutex};
+    return m_target->is_open();
+}
+
+bool SynchronizedSnapshotWriter::copy_entry(const SnapshotReader& source, std::string_view path)
+{
+    std::lock_guard lock{m_mutex};
+    return m_target->copy_entry(source, path);
+}
+
+} // namespace insti
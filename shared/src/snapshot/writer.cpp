@@ -1,5 +1,8 @@
 #include "pch.h"
 #include <insti/snapshot/writer.h>
+#include <insti/snapshot/reader.h>
+#include <insti/core/directory_scanner.h>
+#include <unordered_set>
 
 namespace insti
 {
@@ -30,6 +33,43 @@ bool SnapshotWriter::write_utf16(std::string_view path, std::string_view content
     return write_binary(path, data);
 }
 
+bool SnapshotWriter::copy_from(const SnapshotReader& source, std::string_view path)
+{
+    if (!is_open())
+        return false;
+
+    if (copy_entry(source, path))
+        return true;
+
+    // Fallback for readers/writers of different kinds: full decompress and recompress
+    if (!path.empty() && path.back() == '/')
+        return create_directory(path);
+
+    if (!source.exists(path))
+    {
+        spdlog::error("Entry not found in source snapshot: {}", path);
+        return false;
+    }
+    return write_binary(path, source.read_binary(path));
+}
+
+bool SnapshotWriter::copy_all_from(const SnapshotReader& source,
+                                   const std::function<bool(std::string_view)>& filter)
+{
+    for (const auto& path : source.get_all_paths())
+    {
+        if (filter && !filter(path))
+            continue;
+
+        if (!copy_from(source, path))
+        {
+            spdlog::error("Failed to copy entry: {}", path);
+            return false;
+        }
+    }
+    return true;
+}
+
 bool SnapshotWriter::add_directory_recursive(std::string_view archive_prefix, std::string_view src_dir)
 {
     if (!is_open())
@@ -47,79 +87,42 @@ bool SnapshotWriter::add_directory_recursive(std::string_view archive_prefix, st
     if (!prefix.empty() && prefix.back() == '/')
         prefix.pop_back();
 
-    std::error_code ec;
-
     // First pass: collect all directories and files
-    std::vector<std::filesystem::path> dirs;
-    std::vector<std::filesystem::path> files;
+    const auto scan = DirectoryScanner{}.scan(base);
+    if (!scan.errors.empty())
+    {
+        spdlog::error("Error iterating directory: {}: {}", scan.errors.front().path.string(), scan.errors.front().message);
+        return false;
+    }
+
+    const auto archive_path_of = [&](const std::filesystem::path& path) {
+        std::string rel_str = path.lexically_relative(base).string();
+        std::replace(rel_str.begin(), rel_str.end(), '\\', '/');
+        return prefix + "/" + rel_str;
+    };
 
-    for (const auto& entry : std::filesystem::recursive_directory_iterator(base, ec))
+    // Directories that contain files somewhere below them
+    std::unordered_set<std::filesystem::path::string_type> dirs_with_files;
+    for (const auto& file : scan.files)
     {
-        if (ec)
+        for (auto parent = file.path.parent_path(); parent != base && !parent.empty(); parent = parent.parent_path())
         {
-            spdlog::error("Error iterating directory: {}", ec.message());
-            return false;
+            if (!dirs_with_files.insert(parent.native()).second)
+                break;
         }
-
-        if (entry.is_directory())
-            dirs.push_back(entry.path());
-        else if (entry.is_regular_file())
-            files.push_back(entry.path());
     }
 
     // Create empty directories (those without files)
-    for (const auto& dir : dirs)
+    for (const auto& dir : scan.dirs)
     {
-        auto rel = std::filesystem::relative(dir, base, ec);
-        if (ec)
-        {
-            spdlog::error("Error computing relative path: {}", ec.message());
+        if (!dirs_with_files.contains(dir.path.native()) && !create_directory(archive_path_of(dir.path)))
             return false;
-        }
-
-        // Check if directory is empty (no files under it)
-        bool has_files = false;
-        for (const auto& file : files)
-        {
-            auto file_rel = std::filesystem::relative(file, base, ec);
-            std::string file_rel_str = file_rel.string();
-            std::string dir_rel_str = rel.string();
-
-            // Replace backslashes for comparison
-            std::replace(file_rel_str.begin(), file_rel_str.end(), '\\', '/');
-            std::replace(dir_rel_str.begin(), dir_rel_str.end(), '\\', '/');
-
-            if (file_rel_str.starts_with(dir_rel_str + "/"))
-            {
-                has_files = true;
-                break;
-            }
-        }
-
-        if (!has_files)
-        {
-            std::string rel_str = rel.string();
-            std::replace(rel_str.begin(), rel_str.end(), '\\', '/');
-            std::string archive_path = prefix + "/" + rel_str;
-            if (!create_directory(archive_path))
-                return false;
-        }
     }
 
     // Add all files
-    for (const auto& file : files)
+    for (const auto& file : scan.files)
     {
-        auto rel = std::filesystem::relative(file, base, ec);
-        if (ec)
-        {
-            spdlog::error("Error computing relative path: {}", ec.message());
-            return false;
-        }
-
-        std::string rel_str = rel.string();
-        std::replace(rel_str.begin(), rel_str.end(), '\\', '/');
-        std::string archive_path = prefix + "/" + rel_str;
-        if (!write_file(archive_path, file.string()))
+        if (!write_file(archive_path_of(file.path), file.path.string()))
             return false;
     }
 
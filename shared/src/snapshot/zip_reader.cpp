@@ -1,7 +1,8 @@
 #include "pch.h"
 #include <insti/snapshot/zip_reader.h>
-#include <aclapi.h>
-#include <sddl.h>
+#include <insti/core/file_io.h>
+#include <insti/core/file_time.h>
+#include <algorithm>
 
 namespace insti
 {
@@ -9,33 +10,31 @@ namespace insti
 namespace
 {
 
-/// Set permissive ACL on a file (Everyone: Full Control)
-bool set_permissive_acl(const std::wstring& path)
-{
-    // SDDL: D:(A;;FA;;;WD) = DACL with Allow Full Access to Everyone (World)
-    PSECURITY_DESCRIPTOR pSD = nullptr;
-    if (!ConvertStringSecurityDescriptorToSecurityDescriptorW(
-            L"D:(A;;FA;;;WD)", SDDL_REVISION_1, &pSD, nullptr))
-    {
-        return false;
-    }
+/// Largest single WriteFile() call.
+constexpr size_t MAX_WRITE = 1u << 30;
 
-    BOOL daclPresent = FALSE, daclDefaulted = FALSE;
-    PACL pDacl = nullptr;
-    if (!GetSecurityDescriptorDacl(pSD, &daclPresent, &pDacl, &daclDefaulted))
-    {
-        LocalFree(pSD);
+/// True if path is on a local fixed disk. Only there is a mapping safe: reading a
+/// mapped page of a file on a share (or a removed disk) that has gone away raises
+/// EXCEPTION_IN_PAGE_ERROR instead of failing a read.
+bool on_local_fixed_drive(const std::string& path)
+{
+    const std::wstring wide_path = std::filesystem::absolute(std::filesystem::path{path}).wstring();
+    wchar_t volume[MAX_PATH];
+    if (!GetVolumePathNameW(wide_path.c_str(), volume, MAX_PATH))
         return false;
-    }
-
-    DWORD result = SetNamedSecurityInfoW(
-        const_cast<LPWSTR>(path.c_str()),
-        SE_FILE_OBJECT,
-        DACL_SECURITY_INFORMATION | PROTECTED_DACL_SECURITY_INFORMATION,
-        nullptr, nullptr, pDacl, nullptr);
+    return GetDriveTypeW(volume) == DRIVE_FIXED;
+}
 
-    LocalFree(pSD);
-    return result == ERROR_SUCCESS;
+ArchiveEntry to_entry(const mz_zip_archive_file_stat& stat)
+{
+    return ArchiveEntry{
+        stat.m_filename,
+        stat.m_is_directory != MZ_FALSE,
+        stat.m_uncomp_size,
+        static_cast<int64_t>(stat.m_time),
+        stat.m_is_directory ? std::nullopt : std::optional<uint32_t>{stat.m_crc32},
+        stat.m_comp_size,
+        stat.m_local_header_ofs};
 }
 
 } // anonymous namespace
@@ -59,18 +58,81 @@ bool ZipSnapshotReader::open(std::string_view path)
     auto* zip = static_cast<mz_zip_archive*>(m_zip);
     memset(zip, 0, sizeof(mz_zip_archive));
 
-    std::string path_str{path};
-    if (!mz_zip_reader_init_file(zip, path_str.c_str(), 0))
+    m_path = std::string{path};
+    const bool mapped = m_memory_mapped && on_local_fixed_drive(m_path);
+    if (m_memory_mapped && !mapped)
+        spdlog::debug("Not mapping {}: not on a local fixed drive", m_path);
+
+    const bool ok = mapped
+        ? map_file() && mz_zip_reader_init_mem(zip, m_view, static_cast<size_t>(m_view_size), 0)
+        : mz_zip_reader_init_file(zip, m_path.c_str(), 0);
+    if (!ok)
     {
         spdlog::error("Failed to open zip: {}", path);
+        unmap_file();
         return false;
     }
 
     m_open = true;
-    build_path_cache();  // Build cache immediately
     return true;
 }
 
+bool ZipSnapshotReader::map_file()
+{
+    const std::wstring wide_path = std::filesystem::path{m_path}.wstring();
+    HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    m_file = file;
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        return false;
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+        return false;
+
+    m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_view)
+        return false;
+
+    m_view_size = static_cast<uint64_t>(size.QuadPart);
+    return true;
+}
+
+void ZipSnapshotReader::unmap_file()
+{
+    if (m_view)
+        UnmapViewOfFile(m_view);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+
+    m_view = nullptr;
+    m_view_size = 0;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+
+SnapshotReader* ZipSnapshotReader::open_clone() const
+{
+    if (!m_open)
+        return nullptr;
+
+    // Clones are used for extraction by path; the path cache is built lazily if ever needed
+    auto* clone = new ZipSnapshotReader();
+    clone->set_memory_mapped(m_memory_mapped);
+    if (!clone->open(m_path))
+    {
+        clone->release(REFCOUNT_DEBUG_ARGS);
+        return nullptr;
+    }
+    return clone;
+}
+
 void ZipSnapshotReader::close()
 {
     if (m_open)
@@ -78,6 +140,40 @@ void ZipSnapshotReader::close()
         mz_zip_reader_end(static_cast<mz_zip_archive*>(m_zip));
         m_open = false;
     }
+    unmap_file();
+    m_manifest.reset();
+    m_manifest_loaded = false;
+}
+
+int ZipSnapshotReader::locate(std::string_view path) const
+{
+    std::string path_str{path};
+    return mz_zip_reader_locate_file(static_cast<mz_zip_archive*>(m_zip), path_str.c_str(), nullptr, 0);
+}
+
+const SnapshotManifest* ZipSnapshotReader::manifest() const
+{
+    if (!m_open)
+        return nullptr;
+
+    if (!m_manifest_loaded)
+    {
+        m_manifest_loaded = true;
+
+        std::string name{SnapshotManifest::FILE_NAME};
+        size_t size = 0;
+        void* data = mz_zip_reader_extract_file_to_heap(static_cast<mz_zip_archive*>(m_zip), name.c_str(), &size, 0);
+        if (data)
+        {
+            auto manifest = std::make_unique<SnapshotManifest>();
+            if (manifest->parse(std::string_view{static_cast<const char*>(data), size}))
+                m_manifest = std::move(manifest);
+            else
+                spdlog::warn("Ignoring invalid {} in {}", SnapshotManifest::FILE_NAME, m_path);
+            mz_free(data);
+        }
+    }
+    return m_manifest.get();
 }
 
 std::vector<std::string> ZipSnapshotReader::get_all_paths() const
@@ -101,6 +197,62 @@ std::vector<std::string> ZipSnapshotReader::get_all_paths() const
     return result;
 }
 
+std::optional<ArchiveEntry> ZipSnapshotReader::stat(std::string_view path) const
+{
+    if (!m_open)
+        return std::nullopt;
+
+    auto* zip = static_cast<mz_zip_archive*>(m_zip);
+
+    std::string path_str{path};
+    int index = mz_zip_reader_locate_file(zip, path_str.c_str(), nullptr, 0);
+    mz_zip_archive_file_stat stat;
+    if (index < 0 || !mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat))
+        return std::nullopt;
+
+    return to_entry(stat);
+}
+
+std::vector<ArchiveEntry> ZipSnapshotReader::get_all_entries() const
+{
+    std::vector<ArchiveEntry> result;
+
+    if (!m_open)
+        return result;
+
+    // Everything comes from the central directory, already in memory after open()
+    auto* zip = static_cast<mz_zip_archive*>(m_zip);
+    mz_uint count = mz_zip_reader_get_num_files(zip);
+    result.reserve(count);
+
+    for (mz_uint i = 0; i < count; ++i)
+    {
+        mz_zip_archive_file_stat stat;
+        if (mz_zip_reader_file_stat(zip, i, &stat))
+            result.push_back(to_entry(stat));
+    }
+
+    return result;
+}
+
+bool ZipSnapshotReader::read_stream(std::string_view path,
+                                    const std::function<bool(const uint8_t*, size_t)>& sink) const
+{
+    if (!m_open)
+        return false;
+
+    // miniz stops extracting as soon as the callback consumes fewer bytes than offered
+    auto callback = [](void* opaque, mz_uint64, const void* buf, size_t n) -> size_t {
+        const auto& fn = *static_cast<const std::function<bool(const uint8_t*, size_t)>*>(opaque);
+        return fn(static_cast<const uint8_t*>(buf), n) ? n : 0;
+    };
+
+    std::string path_str{path};
+    return mz_zip_reader_extract_file_to_callback(
+        static_cast<mz_zip_archive*>(m_zip), path_str.c_str(), callback,
+        const_cast<std::function<bool(const uint8_t*, size_t)>*>(&sink), 0) != MZ_FALSE;
+}
+
 std::vector<uint8_t> ZipSnapshotReader::read_binary(std::string_view path) const
 {
     if (!m_open)
@@ -108,34 +260,154 @@ std::vector<uint8_t> ZipSnapshotReader::read_binary(std::string_view path) const
 
     auto* zip = static_cast<mz_zip_archive*>(m_zip);
 
-    std::string path_str{path};
-    size_t size = 0;
-    void* data = mz_zip_reader_extract_file_to_heap(zip, path_str.c_str(), &size, 0);
-    if (!data)
+    // Size the result from the central directory and inflate into it (no intermediate heap copy)
+    const int index = locate(path);
+    mz_zip_archive_file_stat stat;
+    if (index < 0 || !mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat))
         return {};
 
-    std::vector<uint8_t> result(static_cast<uint8_t*>(data), static_cast<uint8_t*>(data) + size);
-    mz_free(data);
+    std::vector<uint8_t> result(static_cast<size_t>(stat.m_uncomp_size));
+    if (!mz_zip_reader_extract_to_mem(zip, static_cast<mz_uint>(index), result.data(), result.size(), 0))
+        return {};
     return result;
 }
 
+bool ZipSnapshotReader::read_into(std::string_view path, std::span<uint8_t> dest) const
+{
+    if (!m_open)
+        return false;
+
+    auto* zip = static_cast<mz_zip_archive*>(m_zip);
+
+    const int index = locate(path);
+    mz_zip_archive_file_stat stat;
+    if (index < 0 || !mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat) ||
+        stat.m_uncomp_size != dest.size())
+        return false;
+
+    return mz_zip_reader_extract_to_mem(zip, static_cast<mz_uint>(index), dest.data(), dest.size(), 0) != MZ_FALSE;
+}
+
+std::optional<std::span<const uint8_t>> ZipSnapshotReader::view(std::string_view path) const
+{
+    if (!m_open || !m_view)
+        return std::nullopt;
+
+    auto* zip = static_cast<mz_zip_archive*>(m_zip);
+
+    const int index = locate(path);
+    mz_zip_archive_file_stat stat;
+    if (index < 0 || !mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat) ||
+        stat.m_is_directory || stat.m_is_encrypted || stat.m_method != 0 ||
+        stat.m_comp_size != stat.m_uncomp_size)
+        return std::nullopt;
+
+    // Stored data follows the local header: 30 fixed bytes, then name and extra field
+    // whose lengths may differ from the central directory copy
+    constexpr uint64_t LOCAL_HEADER_SIZE = 30;
+    constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    const uint64_t header = stat.m_local_header_ofs;
+    if (header + LOCAL_HEADER_SIZE > m_view_size)
+        return std::nullopt;
+
+    const uint8_t* h = m_view + header;
+    const uint32_t signature = h[0] | (h[1] << 8) | (h[2] << 16) | (static_cast<uint32_t>(h[3]) << 24);
+    if (signature != LOCAL_HEADER_SIGNATURE)
+        return std::nullopt;
+
+    const uint64_t name_len = h[26] | (h[27] << 8);
+    const uint64_t extra_len = h[28] | (h[29] << 8);
+    const uint64_t data_ofs = header + LOCAL_HEADER_SIZE + name_len + extra_len;
+    if (data_ofs + stat.m_comp_size > m_view_size)
+        return std::nullopt;
+
+    return std::span<const uint8_t>{m_view + data_ofs, static_cast<size_t>(stat.m_comp_size)};
+}
+
 bool ZipSnapshotReader::extract_to_file(std::string_view archive_path, std::string_view dest_path) const
 {
     if (!m_open)
         return false;
 
-    // Ensure parent directory exists
+    auto* zip = static_cast<mz_zip_archive*>(m_zip);
+
+    const int index = locate(archive_path);
+    mz_zip_archive_file_stat stat;
+    if (index < 0 || !mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat) || stat.m_is_directory)
+        return false;
+
     std::filesystem::path dest{dest_path};
+
+    // Small entries are written in one call: stored ones straight from the mapping,
+    // deflated ones inflated into memory first
+    if (stat.m_uncomp_size <= FileIo::MAX_BUFFERED_SIZE)
+    {
+        std::vector<uint8_t> buffer;
+        std::span<const uint8_t> data;
+        if (const auto stored = view(archive_path))
+        {
+            // Inflating checks the CRC; the mapped bytes have to be checked here
+            if (mz_crc32(MZ_CRC32_INIT, stored->data(), stored->size()) != stat.m_crc32)
+                return false;
+            data = *stored;
+        }
+        else
+        {
+            buffer.resize(static_cast<size_t>(stat.m_uncomp_size));
+            if (!mz_zip_reader_extract_to_mem(zip, static_cast<mz_uint>(index), buffer.data(), buffer.size(), 0))
+                return false;
+            data = buffer;
+        }
+
+        const std::string error = FileIo::write_file(dest, data, static_cast<int64_t>(stat.m_time));
+        if (!error.empty())
+        {
+            spdlog::warn("Failed to write {}: {}", dest.string(), error);
+            return false;
+        }
+
+        // Set permissive ACL so non-admin users can access the files
+        set_permissive_acl(dest.wstring());
+        return true;
+    }
+
+    // Ensure parent directory exists
     if (dest.has_parent_path())
         std::filesystem::create_directories(dest.parent_path());
 
-    std::string archive_str{archive_path};
-    std::string dest_str{dest_path};
-    bool ok = mz_zip_reader_extract_file_to_file(
-        static_cast<mz_zip_archive*>(m_zip),
-        archive_str.c_str(),
-        dest_str.c_str(),
-        0);
+    HANDLE file = CreateFileW(dest.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    // Reserve the final size up front, so the file is allocated once instead of growing
+    // with every write (best effort; extraction works without it)
+    FILE_ALLOCATION_INFO allocation{};
+    allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(stat.m_uncomp_size);
+    SetFileInformationByHandle(file, FileAllocationInfo, &allocation, sizeof(allocation));
+
+    auto callback = [](void* opaque, mz_uint64, const void* buf, size_t n) -> size_t {
+        const auto* data = static_cast<const uint8_t*>(buf);
+        size_t done = 0;
+        while (done < n)
+        {
+            DWORD written = 0;
+            const auto chunk = static_cast<DWORD>(std::min(n - done, MAX_WRITE));
+            if (!WriteFile(static_cast<HANDLE>(opaque), data + done, chunk, &written, nullptr) || written == 0)
+                break;
+            done += written;
+        }
+        return done;
+    };
+    bool ok = mz_zip_reader_extract_to_callback(zip, static_cast<mz_uint>(index), callback, file, 0) != MZ_FALSE;
+
+    if (ok)
+    {
+        // Keep the archived modification time, as miniz's extract-to-file did
+        const FILETIME mtime = FileTime::to_filetime(static_cast<int64_t>(stat.m_time));
+        SetFileTime(file, nullptr, &mtime, &mtime);
+    }
+    CloseHandle(file);
 
     if (ok)
     {
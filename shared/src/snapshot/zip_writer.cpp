@@ -1,13 +1,227 @@
 #include "pch.h"
 #include <insti/snapshot/zip_writer.h>
+#include <insti/snapshot/zip_reader.h>
+#include <insti/core/file_io.h>
+#include <insti/core/file_time.h>
+#include <insti/core/sha256.h>
+#include <insti/core/thread_pool.h>
+#include <insti/core/trace.h>
+#include <chrono>
+#include <future>
+#include <optional>
+#include <system_error>
 
 namespace insti
 {
 
+namespace
+{
+
+/// Result of compressing one entry on a worker thread.
+struct CompressedData
+{
+    std::vector<uint8_t> bytes;  ///< Raw deflate stream, or the original bytes when stored
+    uint32_t crc32 = 0;          ///< CRC32 of the uncompressed data
+    bool deflated = false;       ///< False if stored (level 0, tiny, or incompressible)
+    CompressionPolicy::Reason reason = CompressionPolicy::Reason::Compressible;  ///< Why it was stored
+    std::string sha256;          ///< Content hash for the manifest (if requested)
+};
+
+/// Deflate a buffer into a raw (headerless) stream as expected by the zip format.
+/// @param adaptive Ask CompressionPolicy first and store entries it rejects
+CompressedData deflate_entry(std::string_view name, std::vector<uint8_t> data, mz_uint level, bool hash, bool adaptive)
+{
+    CompressedData out;
+    out.crc32 = static_cast<uint32_t>(mz_crc32(MZ_CRC32_INIT, data.data(), data.size()));
+    if (hash)
+        out.sha256 = Sha256::of_buffer(data.data(), data.size());
+
+    if (adaptive && level != 0)
+        out.reason = CompressionPolicy::classify(name, data);
+
+    // miniz stores entries of 3 bytes or less; match that
+    if (level != 0 && data.size() > 3 && out.reason == CompressionPolicy::Reason::Compressible)
+    {
+        const mz_uint flags = tdefl_create_comp_flags_from_zip_params(
+            static_cast<int>(level), -MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY);
+
+        size_t comp_size = 0;
+        void* comp = tdefl_compress_mem_to_heap(data.data(), data.size(), &comp_size, static_cast<int>(flags));
+        if (comp && comp_size < data.size())
+        {
+            out.bytes.assign(static_cast<uint8_t*>(comp), static_cast<uint8_t*>(comp) + comp_size);
+            out.deflated = true;
+        }
+        mz_free(comp);
+    }
+
+    if (!out.deflated)
+    {
+        if (out.reason == CompressionPolicy::Reason::Compressible)
+            out.reason = CompressionPolicy::Reason::Ineffective;
+        out.bytes = std::move(data);
+    }
+    return out;
+}
+
+/// File archived by streaming (too large to buffer). Size, mtime, the sample for
+/// CompressionPolicy and the bytes handed to miniz all come from one handle, and the
+/// bytes are hashed as miniz reads them, so the manifest describes exactly what was
+/// archived even if the file changes meanwhile.
+class StreamedFile final
+{
+    PNQ_DECLARE_NON_COPYABLE(StreamedFile)
+
+public:
+    explicit StreamedFile(const std::filesystem::path& path)
+        : m_file{CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr)}
+    {
+        LARGE_INTEGER size{};
+        FILETIME write_time{};
+        if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size))
+            return;
+        m_size = static_cast<uint64_t>(size.QuadPart);
+        if (GetFileTime(m_file, nullptr, nullptr, &write_time))
+            m_mtime = FileTime::to_time_t(write_time);
+        m_ok = true;
+    }
+
+    ~StreamedFile()
+    {
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+    }
+
+    bool ok() const { return m_ok; }
+    uint64_t size() const { return m_size; }
+    int64_t mtime() const { return m_mtime; }
+
+    /// Bytes handed to miniz so far (less than size() if the file shrank).
+    uint64_t bytes_read() const { return m_offset; }
+
+    /// Start of the file for CompressionPolicy; rewinds afterwards.
+    std::vector<uint8_t> read_head()
+    {
+        std::vector<uint8_t> head(static_cast<size_t>(std::min<uint64_t>(CompressionPolicy::SAMPLE_SIZE, m_size)));
+        DWORD got = 0;
+        if (head.empty() || !ReadFile(m_file, head.data(), static_cast<DWORD>(head.size()), &got, nullptr))
+            got = 0;
+        head.resize(got);
+
+        LARGE_INTEGER start{};
+        if (!SetFilePointerEx(m_file, start, nullptr, FILE_BEGIN))
+            m_ok = false;
+        return head;
+    }
+
+    /// Finish the hash of the bytes read.
+    std::string finish_hash() { return m_sha.finish(); }
+
+    /// mz_file_read_func: miniz reads front to back, at most size() bytes.
+    static size_t read(void* opaque, mz_uint64 file_ofs, void* buffer, size_t n)
+    {
+        auto& self = *static_cast<StreamedFile*>(opaque);
+        if (!self.m_ok || file_ofs != self.m_offset)
+            return fail(self);
+
+        // Growth after the open is not archived: miniz rejects more than the announced size
+        const size_t want = static_cast<size_t>(std::min<uint64_t>(n, self.m_size - self.m_offset));
+        DWORD got = 0;
+        if (want > 0 && !ReadFile(self.m_file, buffer, static_cast<DWORD>(want), &got, nullptr))
+            return fail(self);
+        if (!self.m_sha.update(buffer, got))
+            return fail(self);
+        self.m_offset += got;
+        return got;
+    }
+
+private:
+    /// More than miniz asked for, which makes it fail the entry (0 would end it early).
+    static size_t fail(StreamedFile& self)
+    {
+        self.m_ok = false;
+        return SIZE_MAX;
+    }
+
+    HANDLE m_file;
+    Sha256 m_sha;
+    uint64_t m_size = 0;
+    uint64_t m_offset = 0;
+    int64_t m_mtime = 0;
+    bool m_ok = false;
+};
+
+/// Size in the archive of the entry appended last (0 if unavailable).
+/// The writer keeps the central directory in memory, so this needs no I/O.
+uint64_t last_compressed_size(mz_zip_archive* zip)
+{
+    const mz_uint count = mz_zip_reader_get_num_files(zip);
+    mz_zip_archive_file_stat stat;
+    if (count == 0 || !mz_zip_reader_file_stat(zip, count - 1, &stat))
+        return 0;
+    return stat.m_comp_size;
+}
+
+/// Check what mz_zip_writer_add_from_zip_reader() will need from a source entry:
+/// a supported method and a readable local header with the data behind it.
+/// Lets a queued raw copy fail up front, while the caller can still fall back.
+bool raw_copyable(mz_zip_archive* src, mz_uint index)
+{
+    mz_zip_archive_file_stat stat;
+    if (!mz_zip_reader_file_stat(src, index, &stat) || stat.m_is_encrypted || !stat.m_is_supported)
+        return false;
+    if (stat.m_method != 0 && stat.m_method != MZ_DEFLATED)
+        return false;
+
+    constexpr size_t LOCAL_HEADER_SIZE = 30;
+    constexpr uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    uint8_t header[LOCAL_HEADER_SIZE];
+    if (src->m_pRead(src->m_pIO_opaque, stat.m_local_header_ofs, header, LOCAL_HEADER_SIZE) != LOCAL_HEADER_SIZE)
+        return false;
+
+    const auto u16 = [&header](size_t ofs) { return static_cast<uint32_t>(header[ofs] | (header[ofs + 1] << 8)); };
+    if ((u16(0) | (u16(2) << 16)) != LOCAL_HEADER_SIGNATURE)
+        return false;
+
+    const uint64_t data_end = stat.m_local_header_ofs + LOCAL_HEADER_SIZE + u16(26) + u16(28) + stat.m_comp_size;
+    return data_end <= src->m_archive_size;
+}
+
+} // anonymous namespace
+
+struct ZipSnapshotWriter::PendingEntry
+{
+    ~PendingEntry()
+    {
+        if (raw_source)
+            PNQ_RELEASE(raw_source);
+    }
+
+    std::string name;                      ///< Normalized archive path
+    int64_t mtime = 0;                     ///< Modification time (0 = now)
+    uint64_t uncomp_size = 0;              ///< Size before compression
+    mz_uint level = 0;                     ///< Level the entry was compressed with
+    std::future<CompressedData> result;    ///< Completed by a pool worker
+    const ZipSnapshotReader* raw_source = nullptr;  ///< Set (and retained) for raw copies instead of result
+    mz_uint raw_index = 0;                 ///< Entry index in raw_source
+    std::optional<ManifestEntry> raw_manifest;  ///< Source manifest entry of a raw copy
+};
+
+struct ZipSnapshotWriter::Prepared final : public SnapshotWriter::PreparedEntry
+{
+    std::unique_ptr<PendingEntry> entry;  ///< Compressed entry, result already set
+};
+
 ZipSnapshotWriter::ZipSnapshotWriter()
     : m_zip{new mz_zip_archive{}}
     , m_open{false}
     , m_compression_level{COMPRESSION_FAST}
+    , m_thread_count{THREADS_SERIAL}
+    , m_append_failed{false}
+    , m_write_manifest{false}
+    , m_adaptive{false}
+    , m_pending_bytes{0}
 {
 }
 
@@ -15,6 +229,7 @@ ZipSnapshotWriter::~ZipSnapshotWriter()
 {
     if (m_open)
     {
+        flush();
         mz_zip_writer_finalize_archive(static_cast<mz_zip_archive*>(m_zip));
         mz_zip_writer_end(static_cast<mz_zip_archive*>(m_zip));
     }
@@ -35,6 +250,13 @@ bool ZipSnapshotWriter::create(std::string_view path)
         return false;
     }
 
+    if (m_thread_count != THREADS_SERIAL && !m_pool)
+        m_pool = std::make_unique<ThreadPool>(m_thread_count);
+
+    m_append_failed = false;
+    m_pending_bytes = 0;
+    m_manifest.clear();
+    m_stats = {};
     m_open = true;
     return true;
 }
@@ -43,6 +265,7 @@ void ZipSnapshotWriter::close()
 {
     if (m_open)
     {
+        flush();
         mz_zip_writer_finalize_archive(static_cast<mz_zip_archive*>(m_zip));
         mz_zip_writer_end(static_cast<mz_zip_archive*>(m_zip));
         m_open = false;
@@ -57,11 +280,165 @@ std::string ZipSnapshotWriter::normalize_path(std::string_view path) const
     return result;
 }
 
+unsigned ZipSnapshotWriter::entry_level() const
+{
+    return m_compression_level < 0
+        ? static_cast<mz_uint>(MZ_DEFAULT_LEVEL)
+        : static_cast<mz_uint>(m_compression_level);
+}
+
+bool ZipSnapshotWriter::enqueue(std::string normalized, std::vector<uint8_t> data, int64_t mtime)
+{
+    const mz_uint level = entry_level();
+
+    auto entry = std::make_unique<PendingEntry>();
+    entry->name = std::move(normalized);
+    entry->mtime = mtime;
+    entry->uncomp_size = data.size();
+    entry->level = level;
+    // The entry is owned by m_pending until its result has been taken, so the name outlives the task
+    entry->result = m_pool->submit([data = std::move(data), level, hash = m_write_manifest, adaptive = m_adaptive,
+                                    name = &entry->name]() mutable {
+        TraceSpan trace{"compress", "deflate", *name};
+        return deflate_entry(*name, std::move(data), level, hash, adaptive);
+    });
+
+    m_pending_bytes += entry->uncomp_size;
+    m_pending.push_back(std::move(entry));
+
+    // Keep a few entries per worker in flight; the entry itself is queued either way,
+    // so a failed append of an earlier entry must not be reported as failure of this one
+    drain(static_cast<size_t>(m_pool->thread_count()) * 4);
+    return true;
+}
+
+void ZipSnapshotWriter::drain(size_t max_pending)
+{
+    while (!m_pending.empty())
+    {
+        auto& entry = *m_pending.front();
+
+        const bool must_wait = m_pending.size() > max_pending ||
+                               m_pending_bytes > PARALLEL_MAX_PENDING_BYTES;
+        if (!must_wait && !entry.raw_source &&
+            entry.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+
+        if (!append_pending(entry))
+            m_append_failed = true;
+
+        m_pending_bytes -= entry.uncomp_size;
+        m_pending.pop_front();
+    }
+}
+
+bool ZipSnapshotWriter::append_pending(PendingEntry& entry)
+{
+    auto* zip = static_cast<mz_zip_archive*>(m_zip);
+
+    bool ok = false;
+    if (entry.raw_source)
+    {
+        // The reference keeps the reader alive, but not open
+        ok = entry.raw_source->is_open() &&
+             mz_zip_writer_add_from_zip_reader(zip, static_cast<mz_zip_archive*>(entry.raw_source->m_zip), entry.raw_index);
+        if (ok && entry.raw_manifest)
+            m_manifest.add(std::move(*entry.raw_manifest));
+    }
+    else
+    {
+        try
+        {
+            CompressedData data = entry.result.get();
+            MZ_TIME_T mtime = static_cast<MZ_TIME_T>(entry.mtime);
+
+            if (data.deflated)
+            {
+                ok = mz_zip_writer_add_mem_ex_v2(
+                    zip, entry.name.c_str(),
+                    data.bytes.data(), data.bytes.size(),
+                    nullptr, 0,
+                    entry.level | MZ_ZIP_FLAG_COMPRESSED_DATA,
+                    entry.uncomp_size, data.crc32,
+                    entry.mtime ? &mtime : nullptr,
+                    nullptr, 0, nullptr, 0);
+            }
+            else
+            {
+                ok = mz_zip_writer_add_mem_ex_v2(
+                    zip, entry.name.c_str(),
+                    data.bytes.data(), data.bytes.size(),
+                    nullptr, 0,
+                    static_cast<mz_uint>(MZ_NO_COMPRESSION),
+                    0, 0,
+                    entry.mtime ? &mtime : nullptr,
+                    nullptr, 0, nullptr, 0);
+            }
+
+            if (ok)
+            {
+                if (entry.level != 0)
+                {
+                    if (data.reason != CompressionPolicy::Reason::Compressible)
+                        spdlog::debug("Storing {} uncompressed ({})", entry.name, CompressionPolicy::reason_name(data.reason));
+                    m_stats.add(data.reason, entry.uncomp_size, data.bytes.size());
+                }
+                record(entry.name, std::move(data.sha256), entry.uncomp_size, entry.mtime);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            spdlog::error("Failed to compress {}: {}", entry.name, e.what());
+        }
+    }
+
+    if (!ok)
+        spdlog::error("Failed to append to zip: {}", entry.name);
+    return ok;
+}
+
+unsigned ZipSnapshotWriter::serial_level(std::string_view name, std::span<const uint8_t> head,
+                                         CompressionPolicy::Reason& reason) const
+{
+    reason = CompressionPolicy::Reason::Compressible;
+    if (m_adaptive && m_compression_level != 0)
+        reason = CompressionPolicy::classify(name, head);
+    return reason == CompressionPolicy::Reason::Compressible
+        ? static_cast<mz_uint>(m_compression_level)
+        : static_cast<mz_uint>(MZ_NO_COMPRESSION);
+}
+
+void ZipSnapshotWriter::count_serial(std::string_view name, CompressionPolicy::Reason reason, uint64_t size)
+{
+    if (m_compression_level == 0)
+        return;
+
+    const uint64_t compressed = last_compressed_size(static_cast<mz_zip_archive*>(m_zip));
+    if (reason == CompressionPolicy::Reason::Compressible && size > 0 && compressed >= size)
+        reason = CompressionPolicy::Reason::Ineffective;
+    if (reason != CompressionPolicy::Reason::Compressible)
+        spdlog::debug("Storing {} uncompressed ({})", name, CompressionPolicy::reason_name(reason));
+    m_stats.add(reason, size, compressed);
+}
+
+void ZipSnapshotWriter::record(std::string normalized, std::string hash, uint64_t size, int64_t mtime)
+{
+    if (!m_write_manifest || hash.empty())
+        return;
+
+    if (mtime == 0)
+        mtime = static_cast<int64_t>(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+    m_manifest.add({std::move(normalized), std::move(hash), size, mtime});
+}
+
 bool ZipSnapshotWriter::create_directory(std::string_view path)
 {
     if (!m_open)
         return false;
 
+    // Directory entries must not overtake files queued before them
+    flush();
+
     std::string normalized = normalize_path(path);
     if (!normalized.empty() && normalized.back() != '/')
         normalized += '/';
@@ -76,6 +453,9 @@ bool ZipSnapshotWriter::create_directory(std::string_view path)
         spdlog::error("Failed to create directory in zip: {}", path);
         return false;
     }
+
+    if (m_write_manifest)
+        m_manifest.add({std::move(normalized), {}, 0, 0});
     return true;
 }
 
@@ -86,15 +466,87 @@ bool ZipSnapshotWriter::write_binary(std::string_view path, const std::vector<ui
 
     std::string normalized = normalize_path(path);
 
-    if (!mz_zip_writer_add_mem(
+    if (m_pool)
+        return enqueue(std::move(normalized), data, 0);
+
+    return add_serial(std::move(normalized), data, 0);
+}
+
+bool ZipSnapshotWriter::write_buffer(std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime)
+{
+    if (!m_open)
+        return false;
+
+    std::string normalized = normalize_path(archive_path);
+
+    if (m_pool)
+        return enqueue(std::move(normalized), std::move(data), mtime);
+
+    return add_serial(std::move(normalized), data, mtime);
+}
+
+std::unique_ptr<SnapshotWriter::PreparedEntry> ZipSnapshotWriter::prepare(
+    std::string_view archive_path, std::vector<uint8_t> data, int64_t mtime) const
+{
+    // Reads only settings fixed before create(), so any thread may compress here
+    auto entry = std::make_unique<PendingEntry>();
+    entry->name = normalize_path(archive_path);
+    entry->mtime = mtime;
+    entry->uncomp_size = data.size();
+    entry->level = entry_level();
+
+    std::promise<CompressedData> compressed;
+    {
+        TraceSpan trace{"compress", "deflate", entry->name};
+        compressed.set_value(deflate_entry(entry->name, std::move(data), entry->level, m_write_manifest, m_adaptive));
+    }
+    entry->result = compressed.get_future();
+
+    auto prepared = std::make_unique<Prepared>();
+    prepared->entry = std::move(entry);
+    return prepared;
+}
+
+bool ZipSnapshotWriter::write_prepared(std::unique_ptr<PreparedEntry> prepared)
+{
+    auto* zip_prepared = dynamic_cast<Prepared*>(prepared.get());
+    if (!m_open || !zip_prepared || !zip_prepared->entry)
+        return false;
+
+    auto entry = std::move(zip_prepared->entry);
+    if (m_pool)
+    {
+        // Behind the entries still being compressed, so order is kept
+        m_pending_bytes += entry->uncomp_size;
+        m_pending.push_back(std::move(entry));
+        drain(static_cast<size_t>(m_pool->thread_count()) * 4);
+        return true;
+    }
+    return append_pending(*entry);
+}
+
+bool ZipSnapshotWriter::add_serial(std::string normalized, std::span<const uint8_t> data, int64_t mtime)
+{
+    CompressionPolicy::Reason reason;
+    const mz_uint level = serial_level(normalized, data, reason);
+    const MZ_TIME_T time = static_cast<MZ_TIME_T>(mtime);
+    if (!mz_zip_writer_add_mem_ex_v2(
             static_cast<mz_zip_archive*>(m_zip),
             normalized.c_str(),
             data.data(), data.size(),
-            static_cast<mz_uint>(m_compression_level)))
+            nullptr, 0,
+            level,
+            0, 0,
+            mtime ? &time : nullptr,
+            nullptr, 0, nullptr, 0))
     {
-        spdlog::error("Failed to write to zip: {}", path);
+        spdlog::error("Failed to write to zip: {}", normalized);
         return false;
     }
+    count_serial(normalized, reason, data.size());
+
+    if (m_write_manifest)
+        record(std::move(normalized), Sha256::of_buffer(data.data(), data.size()), data.size(), mtime);
     return true;
 }
 
@@ -106,16 +558,131 @@ bool ZipSnapshotWriter::write_file(std::string_view archive_path, std::string_vi
     std::string normalized = normalize_path(archive_path);
     std::string src_str{src_path};
 
-    if (!mz_zip_writer_add_file(
+    if (m_pool)
+    {
+        // Read on the calling thread so open/read errors are reported for this file
+        // (and can be retried); only the deflate runs on the pool.
+        const std::filesystem::path src{src_str};
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(src, ec);
+        if (ec)
+        {
+            spdlog::error("Failed to add file to zip: {} -> {}: {}", src_path, archive_path, ec.message());
+            return false;
+        }
+
+        if (size <= PARALLEL_MAX_FILE_SIZE)
+        {
+            FileIo::Completion read;
+            {
+                TraceSpan trace{"io", "read", src_str};
+                read = FileIo::read_file(src);
+            }
+            if (!read.ok)
+            {
+                spdlog::error("Failed to read file for zip: {}: {}", src_path, read.error);
+                return false;
+            }
+            return enqueue(std::move(normalized), std::move(read.data), read.mtime);
+        }
+
+        // Too large to buffer - stream it synchronously, after everything queued before it
+        flush();
+    }
+
+    StreamedFile file{std::filesystem::path{src_str}};
+    if (!file.ok())
+    {
+        spdlog::error("Failed to open file for zip: {}: {}", src_path, std::system_category().message(static_cast<int>(GetLastError())));
+        return false;
+    }
+
+    CompressionPolicy::Reason reason = CompressionPolicy::Reason::Compressible;
+    mz_uint level = static_cast<mz_uint>(m_compression_level);
+    if (m_adaptive)
+        level = serial_level(normalized, file.read_head(), reason);
+
+    TraceSpan trace{"compress", "deflate (streamed)", src_str};
+    MZ_TIME_T mtime = static_cast<MZ_TIME_T>(file.mtime());
+    if (!mz_zip_writer_add_read_buf_callback(
             static_cast<mz_zip_archive*>(m_zip),
             normalized.c_str(),
-            src_str.c_str(),
+            &StreamedFile::read, &file,
+            file.size(),
+            file.mtime() ? &mtime : nullptr,
             nullptr, 0,
-            static_cast<mz_uint>(m_compression_level)))
+            level,
+            nullptr, 0, nullptr, 0) ||
+        !file.ok())
     {
         spdlog::error("Failed to add file to zip: {} -> {}", src_path, archive_path);
         return false;
     }
+    count_serial(normalized, reason, file.bytes_read());
+
+    // Hashed while compressing: the manifest describes exactly the archived bytes
+    if (m_write_manifest)
+        record(std::move(normalized), file.finish_hash(), file.bytes_read(), file.mtime());
+    return true;
+}
+
+bool ZipSnapshotWriter::copy_entry(const SnapshotReader& source, std::string_view path)
+{
+    if (!m_open)
+        return false;
+
+    // Only zip sources carry a deflate stream we can copy verbatim
+    const auto* zip_source = dynamic_cast<const ZipSnapshotReader*>(&source);
+    if (!zip_source || !zip_source->is_open())
+        return false;
+
+    auto* src_zip = static_cast<mz_zip_archive*>(zip_source->m_zip);
+    std::string normalized = normalize_path(path);
+    int index = mz_zip_reader_locate_file(src_zip, normalized.c_str(), nullptr, 0);
+    if (index < 0)
+        return false;
+
+    // Carry the hash over from the source manifest; without one the entry is left out of ours
+    std::optional<ManifestEntry> manifest_entry;
+    if (m_write_manifest)
+    {
+        if (const auto* source_manifest = source.manifest())
+        {
+            if (const auto* found = source_manifest->find(normalized))
+                manifest_entry = *found;
+        }
+    }
+
+    if (m_pool)
+    {
+        // The append happens later; whatever can make it fail is checked now, so the
+        // caller can still write the content instead
+        if (!raw_copyable(src_zip, static_cast<mz_uint>(index)))
+        {
+            spdlog::warn("Cannot copy entry raw, rewriting it: {}", path);
+            return false;
+        }
+
+        // Queue behind pending compressions so entry order is preserved
+        auto entry = std::make_unique<PendingEntry>();
+        entry->name = std::move(normalized);
+        PNQ_ADDREF(zip_source);
+        entry->raw_source = zip_source;
+        entry->raw_index = static_cast<mz_uint>(index);
+        entry->raw_manifest = std::move(manifest_entry);
+        m_pending.push_back(std::move(entry));
+        drain(static_cast<size_t>(m_pool->thread_count()) * 4);
+        return true;
+    }
+
+    if (!mz_zip_writer_add_from_zip_reader(static_cast<mz_zip_archive*>(m_zip), src_zip, static_cast<mz_uint>(index)))
+    {
+        spdlog::error("Failed to copy entry into zip: {}", path);
+        return false;
+    }
+
+    if (manifest_entry)
+        m_manifest.add(std::move(*manifest_entry));
     return true;
 }
 
@@ -126,6 +693,29 @@ bool ZipSnapshotWriter::finalize()
 
     auto* zip = static_cast<mz_zip_archive*>(m_zip);
 
+    flush();
+    if (m_append_failed)
+    {
+        spdlog::error("Failed to finalize zip archive: one or more entries could not be written");
+        mz_zip_writer_end(zip);
+        m_open = false;
+        return false;
+    }
+
+    if (m_write_manifest)
+    {
+        const std::string text = m_manifest.to_string();
+        const std::string name{SnapshotManifest::FILE_NAME};
+        if (!mz_zip_writer_add_mem(zip, name.c_str(), text.data(), text.size(),
+                                   static_cast<mz_uint>(MZ_DEFAULT_LEVEL)))
+        {
+            spdlog::error("Failed to write {} to zip", name);
+            mz_zip_writer_end(zip);
+            m_open = false;
+            return false;
+        }
+    }
+
     if (!mz_zip_writer_finalize_archive(zip))
     {
         spdlog::error("Failed to finalize zip archive");